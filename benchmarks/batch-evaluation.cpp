@@ -0,0 +1,203 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch evaluation.hpp"
+
+#include "formula corpus.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <cmath>
+#include <chrono>
+#include <random>
+#include <iostream>
+
+#include "linear system solving.hpp"
+#include "eigen-rational interface code.hpp"
+
+#include <boost/rational.hpp>
+
+namespace
+{
+	using Symbolic::FreeForms::Expression;
+
+	/** Evaluates an expression at a single binding, for comparison.
+	 */
+	struct ScalarEvaluator
+	{
+		using result_type = double;
+
+		const vector<double> &values;
+
+		template<typename T>
+		double literal(const T &value) const {return static_cast<double>(value);}
+		double variable(size_t id) const {return values[id];}
+
+		template<template<class> class Operator>
+		double unary(double child) const {return Operator<double>()(child);}
+
+		template<template<class> class Operator>
+		double binary(double left, double right) const {return Operator<double>()(left,right);}
+	}; // end struct ScalarEvaluator
+
+	template<>
+	double ScalarEvaluator::binary<Symbolic::FreeForms::OpTags::bit_xor>(double left, double right) const
+	{
+		return std::pow(left,right);
+	} // end method binary
+
+	/** Evaluates every expression at every binding, one binding at a time, and returns
+	 *	the number of evaluations per second, in millions.
+	 */
+	double scalarThroughput(const vector<Expression<>> &expressions, const vector<vector<double>> &bindings)
+	{
+		size_t nBindings = bindings.front().size();
+		vector<double> values(bindings.size());
+		double checksum = 0; // prevents the optimizer from eliminating the loop
+
+		auto start = std::chrono::steady_clock::now();
+		for(const auto &expression : expressions)
+			for(size_t i = 0 ; i < nBindings ; ++i)
+			{
+				for(size_t c = 0 ; c < bindings.size() ; ++c)
+					values[c] = bindings[c][i];
+				checksum += expression.fold(ScalarEvaluator{values});
+			} // end for
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(checksum == 0) std::cerr << "Unexpected checksum!" << std::endl;
+		return expressions.size()*nBindings / elapsed.count() / 1e6;
+	} // end function scalarThroughput
+
+	/** Compiles every expression and evaluates it at every binding in batches of nLanes.
+	 *	Returns the number of evaluations per second, in millions, including compilation.
+	 */
+	template<size_t nLanes>
+	double batchThroughput(const vector<Expression<>> &expressions, const vector<vector<double>> &bindings, const vector<size_t> &columns)
+	{
+		size_t nBindings = bindings.front().size();
+		vector<const double *> bindingColumns;
+		for(const auto &column : bindings)
+			bindingColumns.push_back(column.data());
+		vector<double> results(nBindings);
+		double checksum = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for(const auto &expression : expressions)
+		{
+			BatchEvaluation::Program<double,nLanes>(expression,columns).evaluate(bindingColumns,nBindings,results.data());
+			checksum += results[nBindings/2];
+		} // end foreach
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(checksum == 0) std::cerr << "Unexpected checksum!" << std::endl;
+		return expressions.size()*nBindings / elapsed.count() / 1e6;
+	} // end function batchThroughput
+
+	/** Evaluates an affine solution at every binding repeatedly and returns the throughput
+	 *	in GB/s of parameters read and values written.
+	 */
+	template<typename DerivedBase, typename DerivedOffset>
+	double affineThroughput(const Eigen::MatrixBase<DerivedBase> &base, const Eigen::MatrixBase<DerivedOffset> &offset,
+		const vector<vector<double>> &parameters, size_t repetitions)
+	{
+		size_t nBindings = parameters.front().size();
+		vector<const double *> bindings;
+		for(const auto &column : parameters)
+			bindings.push_back(column.data());
+		vector<vector<double>> values(base.rows(),vector<double>(nBindings));
+		vector<double *> results;
+		for(auto &row : values)
+			results.push_back(row.data());
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+			BatchEvaluation::evaluate(base,offset,bindings,nBindings,results);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		size_t nBytes = repetitions*nBindings*(parameters.size() + values.size())*sizeof(double);
+		return nBytes / elapsed.count() / 1e9;
+	} // end function affineThroughput
+
+	/** Copies the parameters repeatedly to give a reference for the memory bandwidth,
+	 *	in GB/s of data read and written.
+	 */
+	double copyThroughput(const vector<vector<double>> &parameters, size_t repetitions)
+	{
+		vector<vector<double>> copies = parameters;
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+			for(size_t c = 0 ; c < parameters.size() ; ++c)
+				std::copy(parameters[c].begin(),parameters[c].end(),copies[(c+r)%parameters.size()].begin());
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return 2*repetitions*parameters.size()*parameters.front().size()*sizeof(double) / elapsed.count() / 1e9;
+	} // end function copyThroughput
+} // end unnamed namespace
+
+int main()
+{
+	using Symbolic::Common::SymbolTable;
+	using Rational = boost::rational<long long int>;
+
+	auto symbols = std::make_shared<SymbolTable<string,size_t>>();
+	vector<Expression<>> expressions;
+	for(const auto &formula : Benchmarks::formulaCorpus(200))
+		expressions.emplace_back(formula.begin(),formula.end(),symbols);
+
+	// one column of bindings per symbol, with positive values to keep powers real
+	std::mt19937 generator(2018);
+	std::uniform_real_distribution<double> value(1,2000);
+	vector<vector<double>> bindings(symbols->size(),vector<double>(10000));
+	for(auto &column : bindings)
+		for(auto &v : column)
+			v = value(generator);
+	vector<size_t> columns(symbols->size());
+	for(size_t id = 0 ; id < columns.size() ; ++id)
+		columns[id] = id;
+
+	std::cout << "scalar fold:    " << scalarThroughput(expressions,bindings) << " Mevaluations/s\n";
+	std::cout << "batch, 8 lanes: " << batchThroughput<8>(expressions,bindings,columns) << " Mevaluations/s\n";
+	std::cout << "batch, 16 lanes: " << batchThroughput<16>(expressions,bindings,columns) << " Mevaluations/s\n";
+
+	// an affine solution with 4 parameters, like the ones of layouts
+	Eigen::Matrix<Rational,Eigen::Dynamic,Eigen::Dynamic> base(24,4);
+	Eigen::Matrix<Rational,Eigen::Dynamic,1> offset(24);
+	std::uniform_int_distribution<int> numerator(-20,20), denominator(1,8);
+	for(Eigen::Index i = 0 ; i < base.rows() ; ++i)
+	{
+		offset(i) = Rational(numerator(generator),denominator(generator));
+		for(Eigen::Index j = 0 ; j < base.cols() ; ++j)
+			base(i,j) = Rational(numerator(generator),denominator(generator));
+	} // end for
+
+	vector<vector<double>> parameters(4,vector<double>(1 << 20));
+	for(auto &column : parameters)
+		for(auto &v : column)
+			v = value(generator);
+
+	std::cout << "affine solution: " << affineThroughput(base,offset,parameters,20) << " GB/s\n";
+	std::cout << "memory copy:     " << copyThroughput(parameters,20) << " GB/s" << std::endl;
+
+	return 0;
+} // end function main
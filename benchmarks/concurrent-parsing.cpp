@@ -0,0 +1,125 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "symbolic computation.hpp"
+
+#include "formula corpus.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <iostream>
+#include <algorithm>
+
+namespace
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::Common::ConcurrentSymbolTable;
+	using Symbolic::FreeForms::Expression;
+
+	/** Wraps SymbolTable with a single mutex, as the straightforward alternative to ConcurrentSymbolTable.
+	 */
+	class LockedSymbolTable
+	{
+		// Fields
+		mutable std::mutex mutex;
+		SymbolTable<> symbols;
+
+	public:
+		// Methods
+		size_t declare(const string &name)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return symbols.declare(name);
+		} // end method declare
+
+		template<typename ForwardIterator>
+		size_t declare(ForwardIterator begin, ForwardIterator end)
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return symbols.declare(begin,end);
+		} // end method declare
+
+		const string &name(size_t id) const
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return symbols.name(id);
+		} // end method name
+
+		size_t size() const
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			return symbols.size();
+		} // end method size
+
+		bool empty() const
+		{
+			return size() == 0;
+		} // end method empty
+	}; // end class LockedSymbolTable
+
+	/** Parses the corpus repeatedly on nThreads threads sharing a single symbol table of the given
+	 *	type, each thread taking every nThreads-th formula, and returns the number of expressions
+	 *	parsed per second, in thousands.
+	 */
+	template<typename SymbolTableType>
+	double parseThroughput(const vector<string> &formulas, size_t repetitions, size_t nThreads)
+	{
+		using expression_type = Expression<unsigned long long int,string,size_t,SymbolTableType>;
+		auto symbols = std::make_shared<SymbolTableType>();
+
+		auto start = std::chrono::steady_clock::now();
+		vector<std::thread> threads;
+		for(size_t t = 0 ; t < nThreads ; ++t)
+			threads.emplace_back([&formulas,&symbols,repetitions,nThreads,t](){
+				for(size_t r = 0 ; r < repetitions ; ++r)
+					for(size_t i = t ; i < formulas.size() ; i += nThreads)
+						expression_type(formulas[i].begin(),formulas[i].end(),symbols);
+			});
+		for(auto &thread : threads)
+			thread.join();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return repetitions * formulas.size() / elapsed.count() / 1e3;
+	} // end function parseThroughput
+} // end unnamed namespace
+
+int main()
+{
+	auto formulas = Benchmarks::formulaCorpus();
+	const size_t repetitions = 50;
+
+	std::cout << "SymbolTable, 1 thread: " << parseThroughput<SymbolTable<>>(formulas,repetitions,1) << " Kexpressions/s\n";
+	for(size_t nThreads = 1 ; nThreads <= std::max(4u,std::thread::hardware_concurrency()) ; nThreads *= 2)
+	{
+		std::cout << "LockedSymbolTable, " << nThreads << " thread(s): "
+				  << parseThroughput<LockedSymbolTable>(formulas,repetitions,nThreads) << " Kexpressions/s\n";
+		std::cout << "ConcurrentSymbolTable, " << nThreads << " thread(s): "
+				  << parseThroughput<ConcurrentSymbolTable<>>(formulas,repetitions,nThreads) << " Kexpressions/s\n";
+	} // end for
+	std::cout.flush();
+
+	return 0;
+} // end function main
@@ -0,0 +1,218 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*	Measures parsing, printing, copying and destruction of expressions over several families
+ *	of formulas and writes one CSV line per family and operation to the standard output:
+ *
+ *		family,operation,expressions,seconds,MB/s,Mnodes/s,allocations/expression
+ *
+ *	MB/s counts formula text: the input of parse, the output of print1D/print2D and the
+ *	source text of the expressions copied or destroyed. Allocations are counted by replacing
+ *	the global operator new.
+ */
+
+#include "symbolic computation.hpp"
+
+#include "formula corpus.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <new>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <iostream>
+
+namespace
+{
+	size_t nAllocations = 0;
+} // end unnamed namespace
+
+void *operator new(size_t size)
+{
+	++nAllocations;
+	if(void *memory = std::malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+} // end function operator new
+
+// Kept out of line: GCC warns about free() on memory from operator new when it inlines them.
+__attribute__((noinline)) void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+} // end function operator delete
+
+__attribute__((noinline)) void operator delete(void *memory, size_t) noexcept
+{
+	std::free(memory);
+} // end function operator delete
+
+namespace
+{
+	using Symbolic::FreeForms::Expression;
+	using Symbolic::Common::SymbolTable;
+
+	/** Counts the nodes of an expression.
+	 */
+	struct NodeCounter
+	{
+		using result_type = size_t;
+
+		template<typename T>
+		size_t literal(const T &) const {return 1;}
+		size_t variable(size_t) const {return 1;}
+
+		template<template<class> class Operator>
+		size_t unary(size_t child) const {return child + 1;}
+
+		template<template<class> class Operator>
+		size_t binary(size_t left, size_t right) const {return left + right + 1;}
+	}; // end struct NodeCounter
+
+	/** The totals accumulated while repeating an operation over a family.
+	 */
+	struct Measurement
+	{
+		size_t nExpressions = 0;
+		size_t nBytes = 0;
+		size_t nNodes = 0;
+		size_t nAllocations = 0;
+		double seconds = 0;
+	}; // end struct Measurement
+
+	/** Calls operation(measurement) repeatedly until at least minSeconds of timed work has
+	 *	accumulated. operation must add its bytes, nodes and expressions to measurement and
+	 *	wrap the work to measure in timed(); setup outside it is neither timed nor counted.
+	 */
+	template<typename Operation>
+	Measurement repeat(Operation operation, double minSeconds = 0.25)
+	{
+		Measurement measurement;
+		while(measurement.seconds < minSeconds)
+			operation(measurement);
+		return measurement;
+	} // end function repeat
+
+	/** Accumulates the time and allocations of the calls made by work into measurement.
+	 */
+	template<typename Work>
+	void timed(Measurement &measurement, Work work)
+	{
+		size_t allocationsBefore = nAllocations;
+		auto start = std::chrono::steady_clock::now();
+		work();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		measurement.nAllocations += nAllocations - allocationsBefore;
+		measurement.seconds += elapsed.count();
+	} // end function timed
+
+	void report(const string &family, const string &operation, const Measurement &measurement)
+	{
+		std::cout << family << ',' << operation << ',' << measurement.nExpressions << ',' << measurement.seconds << ','
+			<< measurement.nBytes / measurement.seconds / 1e6 << ','
+			<< measurement.nNodes / measurement.seconds / 1e6 << ','
+			<< double(measurement.nAllocations) / measurement.nExpressions << '\n';
+	} // end function report
+
+	/** Runs every operation over one family of formulas and reports the results.
+	 */
+	void measureFamily(const Benchmarks::FormulaFamily &family)
+	{
+		auto symbols = std::make_shared<SymbolTable<string,size_t>>();
+		vector<Expression<>> expressions;
+		size_t nBytes = 0;
+		size_t nNodes = 0;
+		for(const auto &formula : family.formulas)
+		{
+			expressions.emplace_back(formula.begin(),formula.end(),symbols,Symbolic::FreeForms::Parsers::Pratt());
+			nBytes += formula.size();
+			nNodes += expressions.back().fold(NodeCounter());
+		} // end foreach
+
+		report(family.name,"parse",repeat([&](Measurement &measurement){
+			size_t nEmpty = 0; // prevents the optimizer from eliminating the loop
+			timed(measurement,[&]{
+				for(const auto &formula : family.formulas)
+					nEmpty += Expression<>(formula.begin(),formula.end(),symbols,Symbolic::FreeForms::Parsers::Pratt()).empty();
+			});
+			if(nEmpty) std::cerr << "Unexpected empty expressions!" << std::endl;
+			measurement.nExpressions += expressions.size();
+			measurement.nBytes += nBytes;
+			measurement.nNodes += nNodes;
+		}));
+
+		for(bool twoDimensional : {false,true})
+			report(family.name,twoDimensional ? "print2D" : "print1D",repeat([&](Measurement &measurement){
+				std::ostringstream out;
+				size_t nOutputBytes = 0;
+				timed(measurement,[&]{
+					for(const auto &expression : expressions)
+					{
+						out.str("");
+						if(twoDimensional)
+							expression.print2D(out);
+						else
+							expression.print1D(out);
+						nOutputBytes += out.tellp();
+					} // end foreach
+				});
+				measurement.nExpressions += expressions.size();
+				measurement.nBytes += nOutputBytes;
+				measurement.nNodes += nNodes;
+			}));
+
+		report(family.name,"copy",repeat([&](Measurement &measurement){
+			vector<Expression<>> copies;
+			copies.reserve(expressions.size());
+			timed(measurement,[&]{
+				for(const auto &expression : expressions)
+					copies.push_back(expression);
+			});
+			measurement.nExpressions += expressions.size();
+			measurement.nBytes += nBytes;
+			measurement.nNodes += nNodes;
+		}, 0.05));
+
+		report(family.name,"destroy",repeat([&](Measurement &measurement){
+			vector<Expression<>> parsed;
+			parsed.reserve(family.formulas.size());
+			for(const auto &formula : family.formulas)
+				parsed.emplace_back(formula.begin(),formula.end(),symbols,Symbolic::FreeForms::Parsers::Pratt());
+			timed(measurement,[&]{
+				parsed.clear();
+			});
+			measurement.nExpressions += expressions.size();
+			measurement.nBytes += nBytes;
+			measurement.nNodes += nNodes;
+		}, 0.05));
+	} // end function measureFamily
+} // end unnamed namespace
+
+int main()
+{
+	std::cout << "family,operation,expressions,seconds,MB/s,Mnodes/s,allocations/expression\n";
+	for(const auto &family : Benchmarks::formulaFamilies())
+		measureFamily(family);
+	std::cout.flush();
+
+	return 0;
+} // end function main
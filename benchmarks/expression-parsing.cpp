@@ -0,0 +1,73 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "symbolic computation.hpp"
+
+#include "formula corpus.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <chrono>
+#include <iostream>
+
+namespace
+{
+	/** Parses every formula in corpus repeatedly using the parser selected
+	 *	by ParserTag and returns the throughput in MB/s.
+	 */
+	template<typename ParserTag>
+	double parseThroughput(const vector<string> &corpus, size_t repetitions)
+	{
+		using Symbolic::FreeForms::Expression;
+		using Symbolic::Common::SymbolTable;
+
+		size_t nBytes = 0;
+		size_t nEmpty = 0; // prevents the optimizer from eliminating the loop
+		auto symbols = std::make_shared<SymbolTable<string,size_t>>();
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+			for(const auto &formula : corpus)
+			{
+				nEmpty += Expression<>(formula.begin(),formula.end(),symbols,ParserTag()).empty();
+				nBytes += formula.size();
+			} // end foreach
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(nEmpty) std::cerr << "Unexpected empty expressions!" << std::endl;
+		return nBytes / elapsed.count() / 1e6;
+	} // end function parseThroughput
+} // end unnamed namespace
+
+int main()
+{
+	vector<string> corpus = Benchmarks::formulaCorpus();
+
+	double spirit = parseThroughput<Symbolic::FreeForms::Parsers::Spirit>(corpus,2);
+	double pratt = parseThroughput<Symbolic::FreeForms::Parsers::Pratt>(corpus,20);
+
+	std::cout << "Spirit parser: " << spirit << " MB/s\n";
+	std::cout << "Pratt parser:  " << pratt << " MB/s\n";
+	std::cout << "Speedup:       " << pratt / spirit << "x" << std::endl;
+
+	return 0;
+} // end function main
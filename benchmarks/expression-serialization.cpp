@@ -0,0 +1,89 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "symbolic computation.hpp"
+
+#include "formula corpus.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <chrono>
+#include <memory>
+#include <sstream>
+#include <iostream>
+
+namespace
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	namespace Parsers = Symbolic::FreeForms::Parsers;
+
+	/** Constructs an expression from every input repeatedly using the given
+	 *	parser and returns the number of expressions loaded per second, in thousands.
+	 */
+	template<typename Parser>
+	double loadThroughput(const vector<string> &inputs, size_t repetitions, Parser parser)
+	{
+		auto symbols = std::make_shared<SymbolTable<string,size_t>>();
+		size_t nExpressions = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+			for(const auto &input : inputs)
+			{
+				Expression<> expression(input.begin(),input.end(),symbols,parser);
+				++nExpressions;
+			} // end foreach
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return nExpressions / elapsed.count() / 1e3;
+	} // end function loadThroughput
+
+	size_t totalSize(const vector<string> &strings)
+	{
+		size_t size = 0;
+		for(const auto &s : strings)
+			size += s.size();
+		return size;
+	} // end function totalSize
+} // end unnamed namespace
+
+int main()
+{
+	auto formulas = Benchmarks::formulaCorpus();
+
+	auto symbols = std::make_shared<SymbolTable<string,size_t>>();
+	vector<string> serialized;
+	for(const auto &formula : formulas)
+	{
+		std::ostringstream out;
+		Expression<>(formula.begin(),formula.end(),symbols).serialize(out);
+		serialized.push_back(out.str());
+	} // end foreach
+
+	std::cout << "Spirit: " << loadThroughput(formulas,1,Parsers::Spirit()) << " Kexpressions/s\n";
+	std::cout << "Pratt:  " << loadThroughput(formulas,50,Parsers::Pratt()) << " Kexpressions/s\n";
+	std::cout << "Binary: " << loadThroughput(serialized,50,Parsers::Binary()) << " Kexpressions/s\n";
+	std::cout << "size:   " << double(totalSize(formulas)) / totalSize(serialized) << "x smaller than text" << std::endl;
+
+	return 0;
+} // end function main
@@ -0,0 +1,132 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "symbolic computation.hpp"
+
+#include "formula corpus.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <chrono>
+#include <utility>
+#include <sstream>
+#include <iostream>
+
+namespace
+{
+	using Symbolic::FreeForms::Expression;
+
+	/** Prints every expression repeatedly, in 1D or 2D, and returns the
+	 *	throughput in MB of output per second.
+	 */
+	double printThroughput(const vector<Expression<>> &expressions, size_t repetitions, bool twoDimensional)
+	{
+		size_t nBytes = 0;
+		std::ostringstream out;
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+			for(const auto &expression : expressions)
+			{
+				out.str("");
+				if(twoDimensional)
+					expression.print2D(out);
+				else
+					expression.print1D(out);
+				nBytes += out.tellp();
+			} // end foreach
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return nBytes / elapsed.count() / 1e6;
+	} // end function printThroughput
+
+	/** Counts the nodes of an expression.
+	 */
+	struct NodeCounter
+	{
+		using result_type = size_t;
+
+		template<typename T>
+		size_t literal(const T &) const {return 1;}
+		size_t variable(size_t) const {return 1;}
+
+		template<template<class> class Operator>
+		size_t unary(size_t child) const {return child + 1;}
+
+		template<template<class> class Operator>
+		size_t binary(size_t left, size_t right) const {return left + right + 1;}
+	}; // end struct NodeCounter
+
+	/** Folds every expression repeatedly and returns the number
+	 *	of nodes visited per second, in millions.
+	 */
+	double foldThroughput(const vector<Expression<>> &expressions, size_t repetitions)
+	{
+		size_t nNodes = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+			for(const auto &expression : expressions)
+				nNodes += expression.fold(NodeCounter());
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		return nNodes / elapsed.count() / 1e6;
+	} // end function foldThroughput
+
+	/** Simplifies every expression repeatedly and returns the number of input
+	 *	nodes processed per second, in millions, and the ratio of input to output nodes.
+	 */
+	std::pair<double,double> simplifyThroughput(const vector<Expression<>> &expressions, size_t repetitions)
+	{
+		size_t nNodes = 0;
+		size_t nSimplifiedNodes = 0;
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+			for(const auto &expression : expressions)
+				nSimplifiedNodes += expression.simplified().fold(NodeCounter());
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		for(const auto &expression : expressions)
+			nNodes += repetitions*expression.fold(NodeCounter());
+
+		return {nNodes / elapsed.count() / 1e6, double(nNodes) / nSimplifiedNodes};
+	} // end function simplifyThroughput
+} // end unnamed namespace
+
+int main()
+{
+	using Symbolic::Common::SymbolTable;
+
+	auto symbols = std::make_shared<SymbolTable<string,size_t>>();
+	vector<Expression<>> expressions;
+	for(const auto &formula : Benchmarks::formulaCorpus())
+		expressions.emplace_back(formula.begin(),formula.end(),symbols);
+
+	std::cout << "print1D: " << printThroughput(expressions,50,false) << " MB/s\n";
+	std::cout << "print2D: " << printThroughput(expressions,50,true) << " MB/s\n";
+	std::cout << "fold:    " << foldThroughput(expressions,50) << " Mnodes/s\n";
+	auto simplification = simplifyThroughput(expressions,5);
+	std::cout << "simplify: " << simplification.first << " Mnodes/s, " << simplification.second << "x fewer nodes" << std::endl;
+
+	return 0;
+} // end function main
@@ -0,0 +1,162 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FORMULA_CORPUS_H
+#define FORMULA_CORPUS_H
+
+#include <string>
+#include <vector>
+#include <random>
+
+namespace Benchmarks
+{
+	/** Generates a random formula resembling the ones appearing in constraints.
+	 */
+	inline std::string randomFormula(std::mt19937 &generator, size_t depth)
+	{
+		static const char *const names[] = {"screenWidth","screenHeight","pixelWidth","pixelHeight","a","b","margin","gap"};
+		static const char operators[] = {'+','-','*','/','^'};
+		std::uniform_int_distribution<size_t> nameIndex(0,7), operatorIndex(0,4), leafKind(0,2), literal(0,1000);
+
+		if(depth == 0)
+			switch(leafKind(generator))
+			{
+			case 0: return names[nameIndex(generator)];
+			case 1: return std::to_string(literal(generator));
+			default: return std::to_string(literal(generator)) + "." + std::to_string(literal(generator));
+			} // end switch
+
+		char op = operators[operatorIndex(generator)];
+		if(op == '^')
+			return "(" + randomFormula(generator,depth-1) + ")^" + names[nameIndex(generator)];
+		else
+			return "(" + randomFormula(generator,depth-1) + " " + op + " " + randomFormula(generator,depth-1) + ")";
+	} // end function randomFormula
+
+	/** Returns the same corpus of random formulas of depths 0 to 5 on every call.
+	 */
+	inline std::vector<std::string> formulaCorpus(size_t size = 2000)
+	{
+		std::mt19937 generator(2018);
+		std::vector<std::string> corpus;
+		for(size_t i = 0 ; i < size ; ++i)
+			corpus.push_back(randomFormula(generator,i%6));
+		return corpus;
+	} // end function formulaCorpus
+
+	/** Returns a short formula like the ones typed in constraints, e.g. "2.5*margin + 10 - gap/3".
+	 */
+	inline std::string constraintFormula(std::mt19937 &generator)
+	{
+		static const char *const names[] = {"a","b","margin","gap","bw","bh","px"};
+		std::uniform_int_distribution<size_t> nTerms(1,4), nameIndex(0,6), kind(0,3), literal(1,100);
+
+		std::string result;
+		for(size_t t = 0, n = nTerms(generator) ; t < n ; ++t)
+		{
+			if(t)
+				result += kind(generator) ? " + " : " - ";
+			switch(kind(generator))
+			{
+			case 0: result += names[nameIndex(generator)]; break;
+			case 1: result += std::to_string(literal(generator)) + "*" + names[nameIndex(generator)]; break;
+			case 2: result += std::to_string(literal(generator)) + "." + std::to_string(literal(generator)) + "*" + names[nameIndex(generator)]; break;
+			default: result += names[nameIndex(generator)] + std::string("/") + std::to_string(literal(generator)); break;
+			} // end switch
+		} // end for
+		return result;
+	} // end function constraintFormula
+
+	/** Returns a flat sum of nTerms products, e.g. "3*x12 + 7*x4 - ...".
+	 */
+	inline std::string longSum(std::mt19937 &generator, size_t nTerms)
+	{
+		std::uniform_int_distribution<size_t> variable(0,99), literal(1,1000), sign(0,1);
+
+		std::string result;
+		for(size_t t = 0 ; t < nTerms ; ++t)
+		{
+			if(t)
+				result += sign(generator) ? " + " : " - ";
+			result += std::to_string(literal(generator)) + "*x" + std::to_string(variable(generator));
+		} // end for
+		return result;
+	} // end function longSum
+
+	/** Returns a continued fraction of the given depth, e.g. "1 + a/(2 + b/(3 + ...))".
+	 */
+	inline std::string deepFraction(std::mt19937 &generator, size_t depth)
+	{
+		static const char *const names[] = {"a","b","c","d"};
+		std::uniform_int_distribution<size_t> nameIndex(0,3), literal(1,9);
+
+		std::string result;
+		for(size_t d = 0 ; d < depth ; ++d)
+			result += std::to_string(literal(generator)) + " + " + names[nameIndex(generator)] + "/(";
+		result += std::to_string(literal(generator));
+		result += std::string(depth,')');
+		return result;
+	} // end function deepFraction
+
+	/** Returns a formula with nested exponentiations of the given depth, e.g. "(a + 2)^(b^(x - 1)^2)".
+	 */
+	inline std::string powerTower(std::mt19937 &generator, size_t depth)
+	{
+		static const char *const names[] = {"a","b","x","y"};
+		std::uniform_int_distribution<size_t> nameIndex(0,3), literal(1,9), shape(0,2);
+
+		if(depth == 0)
+			return names[nameIndex(generator)];
+		switch(shape(generator))
+		{
+		case 0: return names[nameIndex(generator)] + std::string("^") + powerTower(generator,depth-1);
+		case 1: return "(" + powerTower(generator,depth-1) + " + " + std::to_string(literal(generator)) + ")^" + std::to_string(literal(generator));
+		default: return "(" + powerTower(generator,depth-1) + ")^(" + powerTower(generator,depth/2) + ")";
+		} // end switch
+	} // end function powerTower
+
+	/** A named family of formulas with a common shape.
+	 */
+	struct FormulaFamily
+	{
+		std::string name;
+		std::vector<std::string> formulas;
+	}; // end struct FormulaFamily
+
+	/** Returns the same families of formulas on every call: short constraint-like formulas,
+	 *	long sums, deep fractions and heavy exponentiation nesting.
+	 */
+	inline std::vector<FormulaFamily> formulaFamilies()
+	{
+		std::mt19937 generator(2018);
+		std::vector<FormulaFamily> families = {{"constraints",{}},{"long-sums",{}},{"deep-fractions",{}},{"power-towers",{}}};
+
+		for(size_t i = 0 ; i < 5000 ; ++i)
+			families[0].formulas.push_back(constraintFormula(generator));
+		for(size_t i = 0 ; i < 50 ; ++i)
+			families[1].formulas.push_back(longSum(generator,500));
+		for(size_t i = 0 ; i < 200 ; ++i)
+			families[2].formulas.push_back(deepFraction(generator,50));
+		for(size_t i = 0 ; i < 500 ; ++i)
+			families[3].formulas.push_back(powerTower(generator,8));
+		return families;
+	} // end function formulaFamilies
+
+} // end namespace Benchmarks
+
+#endif // FORMULA_CORPUS_H
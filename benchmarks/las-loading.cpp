@@ -0,0 +1,127 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gui model/model.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	using Model = GUIModel::Controls::Model<float>;
+
+	// Model::load as it was before it stopped building a property tree.
+	void loadThroughTree(Model &model, const string &fileName)
+	{
+		model.clear();
+		Model::property_tree_type tree, emptyTree;
+		boost::property_tree::read_xml(fileName,tree);
+		for(const auto &control : tree.get_child("gui-model.controls"))
+			model.controls.emplace_back(control.second);
+		for(const auto &constraint : tree.get_child("gui-model.constraints",emptyTree))
+			model.constraints.emplace_back(constraint.second,&model.controls);
+		model.rebuildIndices();
+	} // end function loadThroughTree
+
+	/** Loads fileName repeatedly with load and returns the milliseconds per load.
+	 */
+	template<typename LoadFunction>
+	double loadTime(const string &fileName, size_t repetitions, LoadFunction load)
+	{
+		Model model;
+		size_t checksum = 0; // prevents the optimizer from eliminating the loop
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+		{
+			load(model,fileName);
+			checksum += model.controls.size() + model.constraints.size();
+		} // end for
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(checksum == 0) std::cerr << "Unexpected checksum!" << std::endl;
+		return elapsed.count() / repetitions * 1e3;
+	} // end function loadTime
+
+	/** Prints the time to load fileName through a property tree and directly, and checks
+	 *	that both produce the same number of controls and constraints.
+	 */
+	void measureFile(const string &label, const string &fileName, size_t repetitions)
+	{
+		Model viaTree, direct;
+		loadThroughTree(viaTree,fileName);
+		direct.load(fileName);
+		if(viaTree.controls.size() != direct.controls.size() || viaTree.constraints.size() != direct.constraints.size())
+			std::cerr << "Different models loaded from " << fileName << "!" << std::endl;
+
+		std::ifstream file(fileName,std::ios::binary | std::ios::ate);
+		double megabytes = file.tellg() / 1e6;
+		double treeTime = loadTime(fileName,repetitions,loadThroughTree);
+		double directTime = loadTime(fileName,repetitions,[](Model &model, const string &fileName){model.load(fileName);});
+
+		std::cout << label << direct.controls.size() << " controls, " << direct.constraints.size() << " constraints: "
+			<< "property tree " << treeTime << " ms (" << megabytes / treeTime * 1e3 << " MB/s), "
+			<< "direct " << directTime << " ms (" << megabytes / directTime * 1e3 << " MB/s), "
+			<< treeTime / directTime << "x\n";
+	} // end function measureFile
+
+	/** Saves a model with nControls controls in a grid, each constrained to its neighbour and
+	 *	to its own size, in fileName.
+	 */
+	void writeSyntheticFile(const string &fileName, size_t nControls)
+	{
+		using geometry::RectangleSide;
+
+		Model model;
+		auto previous = model.controls.key(model.controls.begin());
+		for(size_t i = 0 ; i < nControls ; ++i)
+		{
+			float left = 10 + (i % 100) * 30.5f, bottom = 10 + (i / 100) * 20.25f;
+			auto control = model.controls.emplace_back(Model::controlTextHeight,"control" + std::to_string(i),Model::borderSize,left,bottom,left+25,bottom+15);
+			model.constraints.emplace_back(&model.controls,previous,RectangleSide::RIGHT,control,RectangleSide::LEFT,bottom,bottom+7,"5mm",Model::constraintTextHeight);
+			model.constraints.emplace_back(&model.controls,control,RectangleSide::LEFT,control,RectangleSide::RIGHT,bottom+8,bottom+15,"25mm + " + std::to_string(i % 7) + "a",Model::constraintTextHeight);
+			previous = control;
+		} // end for
+		model.save(fileName);
+	} // end function writeSyntheticFile
+} // end unnamed namespace
+
+int main()
+{
+	// run from the source directory
+	for(const string name : {"alternative formulations","dialog demo","dialog demo wide","different anchors","invalid characters",
+			"missing constraint","mixed units","negative variable values","no html-css equivalent","rational coefficients","unknown unit suffix"})
+		measureFile("examples/" + name + ".las: ","examples/" + name + ".las",200);
+
+	const string fileName = "las loading benchmark.las";
+	for(size_t nControls : {1000,10000,50000})
+	{
+		writeSyntheticFile(fileName,nControls);
+		measureFile("synthetic: ",fileName,nControls < 50000 ? 5 : 2);
+	} // end for
+	std::remove(fileName.c_str());
+
+	return 0;
+} // end function main
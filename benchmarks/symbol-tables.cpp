@@ -0,0 +1,242 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "symbol table.hpp"
+#include "symbolic computation.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <new>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+
+namespace
+{
+	size_t nLiveBytes = 0;
+
+	// every block starts with its size, so that operator delete can account for it
+	constexpr size_t headerSize = alignof(std::max_align_t);
+} // end unnamed namespace
+
+void *operator new(size_t size)
+{
+	if(char *memory = static_cast<char *>(std::malloc(size + headerSize)))
+	{
+		*reinterpret_cast<size_t *>(memory) = size;
+		nLiveBytes += size;
+		return memory + headerSize;
+	} // end if
+	throw std::bad_alloc();
+} // end function operator new
+
+void operator delete(void *memory) noexcept
+{
+	if(!memory) return;
+	char *block = static_cast<char *>(memory) - headerSize;
+	nLiveBytes -= *reinterpret_cast<size_t *>(block);
+	std::free(block);
+} // end function operator delete
+
+void operator delete(void *memory, size_t) noexcept
+{
+	operator delete(memory);
+} // end function operator delete
+
+namespace
+{
+	/** Declares every name into a new symbol table, then looks up every token of text, given
+	 *	as a pair of offsets, and prints the declarations and lookups per second, in millions,
+	 *	and the bytes of heap memory used by the table per symbol.
+	 */
+	template<typename SymbolTableType>
+	void measureTable(const string &label, const vector<string> &names, const string &text,
+		const vector<std::pair<size_t,size_t>> &tokens)
+	{
+		size_t bytesBefore = nLiveBytes;
+		auto start = std::chrono::steady_clock::now();
+		SymbolTableType symbols;
+		for(const auto &name : names)
+			symbols.declare(name);
+		std::chrono::duration<double> declaration = std::chrono::steady_clock::now() - start;
+		size_t nBytes = nLiveBytes - bytesBefore;
+
+		size_t checksum = 0; // prevents the optimizer from eliminating the loop
+		start = std::chrono::steady_clock::now();
+		for(const auto &token : tokens)
+			checksum += symbols.declare(text.begin()+token.first,text.begin()+token.second);
+		std::chrono::duration<double> lookup = std::chrono::steady_clock::now() - start;
+
+		if(checksum == 0) std::cerr << "Unexpected checksum!" << std::endl;
+		std::cout << label << names.size() / declaration.count() / 1e6 << " Mdeclarations/s, "
+			<< tokens.size() / lookup.count() / 1e6 << " Mlookups/s, "
+			<< double(nBytes) / names.size() << " bytes/symbol\n";
+	} // end function measureTable
+
+	/** Looks up the first 20 completions of each prefix and returns the queries per second,
+	 *	in thousands. Compares a radix tree with scanning every name of a SymbolTable.
+	 */
+	template<typename SymbolTableType>
+	double completionThroughput(const SymbolTableType &symbols, const vector<string> &prefixes);
+
+	template<>
+	double completionThroughput(const Symbolic::Common::RadixSymbolTable<> &symbols, const vector<string> &prefixes)
+	{
+		size_t nResults = 0;
+		auto start = std::chrono::steady_clock::now();
+		for(const auto &prefix : prefixes)
+			nResults += symbols.completions(prefix,20).size();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(nResults == 0) std::cerr << "Unexpected lack of completions!" << std::endl;
+		return prefixes.size() / elapsed.count() / 1e3;
+	} // end function completionThroughput
+
+	template<>
+	double completionThroughput(const Symbolic::Common::SymbolTable<> &symbols, const vector<string> &prefixes)
+	{
+		size_t nResults = 0;
+		auto start = std::chrono::steady_clock::now();
+		for(const auto &prefix : prefixes)
+		{
+			vector<string> completions;
+			for(size_t id = 0 ; id < symbols.size() ; ++id)
+				if(symbols.name(id).compare(0,prefix.size(),prefix) == 0)
+					completions.push_back(symbols.name(id));
+			std::partial_sort(completions.begin(),completions.begin()+std::min<size_t>(20,completions.size()),completions.end());
+			nResults += std::min<size_t>(20,completions.size());
+		} // end foreach
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(nResults == 0) std::cerr << "Unexpected lack of completions!" << std::endl;
+		return prefixes.size() / elapsed.count() / 1e3;
+	} // end function completionThroughput
+
+	/** Copies symbols repeatedly, declaring a new name in each copy, as when taking snapshots
+	 *	during editing, and returns the microseconds per snapshot.
+	 */
+	template<typename SymbolTableType>
+	double snapshotCost(const SymbolTableType &symbols, size_t repetitions)
+	{
+		size_t checksum = 0; // prevents the optimizer from eliminating the loop
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+		{
+			SymbolTableType snapshot = symbols;
+			checksum += snapshot.declare("snapshot" + std::to_string(r));
+		} // end for
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(checksum == 0) std::cerr << "Unexpected checksum!" << std::endl;
+		return elapsed.count() / repetitions * 1e6;
+	} // end function snapshotCost
+
+	/** Parses every formula with the Pratt parser into expressions sharing a symbol table
+	 *	of type SymbolTableType and returns the throughput in MB/s.
+	 */
+	template<typename SymbolTableType>
+	double parseThroughput(const vector<string> &formulas, size_t repetitions)
+	{
+		using Expression = Symbolic::FreeForms::Expression<unsigned long long int,string,size_t,SymbolTableType>;
+
+		size_t nBytes = 0;
+		size_t nEmpty = 0; // prevents the optimizer from eliminating the loop
+
+		auto start = std::chrono::steady_clock::now();
+		for(size_t r = 0 ; r < repetitions ; ++r)
+		{
+			auto symbols = std::make_shared<SymbolTableType>();
+			for(const auto &formula : formulas)
+			{
+				nEmpty += Expression(formula.begin(),formula.end(),symbols,Symbolic::FreeForms::Parsers::Pratt()).empty();
+				nBytes += formula.size();
+			} // end foreach
+		} // end for
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+		if(nEmpty) std::cerr << "Unexpected empty expressions!" << std::endl;
+		return nBytes / elapsed.count() / 1e6;
+	} // end function parseThroughput
+} // end unnamed namespace
+
+int main()
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::Common::InternedSymbolTable;
+	using Symbolic::Common::RadixSymbolTable;
+	using Symbolic::Common::PersistentSymbolTable;
+
+	// names like those of big specifications and a text referencing them at random
+	const size_t nNames = 50000;
+	vector<string> names;
+	for(size_t i = 0 ; i < nNames ; ++i)
+		names.push_back("control" + std::to_string(i) + "Width");
+
+	std::mt19937 generator(2018);
+	std::uniform_int_distribution<size_t> nameIndex(0,nNames-1);
+	string text;
+	vector<std::pair<size_t,size_t>> tokens;
+	for(size_t i = 0 ; i < 1000000 ; ++i)
+	{
+		const string &name = names[nameIndex(generator)];
+		tokens.emplace_back(text.size(),text.size()+name.size());
+		text += name + " + ";
+	} // end for
+
+	measureTable<SymbolTable<>>("SymbolTable:           ",names,text,tokens);
+	measureTable<InternedSymbolTable<>>("InternedSymbolTable:   ",names,text,tokens);
+	measureTable<RadixSymbolTable<>>("RadixSymbolTable:      ",names,text,tokens);
+	measureTable<PersistentSymbolTable<>>("PersistentSymbolTable: ",names,text,tokens);
+
+	// prefixes of 8 to 12 characters, as typed while completing a name
+	vector<string> prefixes;
+	std::uniform_int_distribution<size_t> prefixLength(8,12);
+	for(size_t i = 0 ; i < 1000 ; ++i)
+		prefixes.push_back(names[nameIndex(generator)].substr(0,prefixLength(generator)));
+
+	SymbolTable<> table(names.begin(),names.end());
+	RadixSymbolTable<> radixTable(names.begin(),names.end());
+	std::cout << "Completion, SymbolTable scan:  " << completionThroughput(table,prefixes) << " Kqueries/s\n";
+	std::cout << "Completion, RadixSymbolTable:  " << completionThroughput(radixTable,prefixes) << " Kqueries/s\n";
+
+	PersistentSymbolTable<> persistentTable(names.begin(),names.end());
+	std::cout << "Snapshot, SymbolTable:           " << snapshotCost(table,20) << " us\n";
+	std::cout << "Snapshot, PersistentSymbolTable: " << snapshotCost(persistentTable,20000) << " us\n";
+
+	// formulas of 20 terms each over all the names
+	vector<string> formulas;
+	for(size_t f = 0 ; f < 10000 ; ++f)
+	{
+		string formula = names[nameIndex(generator)];
+		for(size_t t = 1 ; t < 20 ; ++t)
+			formula += " + 2*" + names[nameIndex(generator)];
+		formulas.push_back(formula);
+	} // end for
+
+	std::cout << "Pratt parser, SymbolTable:         " << parseThroughput<SymbolTable<>>(formulas,3) << " MB/s\n";
+	std::cout << "Pratt parser, InternedSymbolTable: " << parseThroughput<InternedSymbolTable<>>(formulas,3) << " MB/s\n";
+	std::cout << "Pratt parser, RadixSymbolTable:    " << parseThroughput<RadixSymbolTable<>>(formulas,3) << " MB/s" << std::endl;
+
+	return 0;
+} // end function main
@@ -0,0 +1,487 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BATCH_EVALUATION_H
+#define BATCH_EVALUATION_H
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include <boost/rational.hpp>
+
+#include <Eigen/Dense>
+
+#include "symbolic computation.hpp"
+
+namespace BatchEvaluation
+{
+	/** An expression compiled for evaluation at many bindings of its variables at once. The
+	 *	bindings are given as a structure of arrays: one array of values per column. Evaluation
+	 *	proceeds in blocks of nLanes bindings and every instruction is applied to a whole block
+	 *	in a tight loop over the lanes, which the compiler turns into vector instructions. The
+	 *	cost of interpreting each instruction is thus amortized over nLanes bindings.
+	 *
+	 *	Constant subexpressions are folded during compilation and integer constant exponents
+	 *	become repeated multiplications. Other exponents use std::pow.
+	 */
+	template<typename FloatType = double, size_t nLanes = 16>
+	class Program
+	{
+		// Member Types
+	private:
+		enum class Opcode {load, broadcast, negate, add, subtract, multiply, divide, integerPower, power};
+
+		struct Instruction
+		{
+			Opcode opcode;
+			size_t destination;
+			size_t left;
+			size_t right;
+			size_t column; // for load
+			FloatType constant; // for broadcast
+			long long int exponent; // for integerPower
+		}; // end struct Instruction
+
+		/** An algebra for Symbolic::FreeForms::Expression::fold emitting the instructions of a
+		 *	Program. Registers are allocated like a stack: since fold visits nodes in postorder,
+		 *	the operands of a binary node are the top two non-constant values when it's visited.
+		 */
+		class Compiler
+		{
+			// Member Types
+		public:
+			struct result_type
+			{
+				// Fields
+				bool isConstant;
+				FloatType constant;
+				size_t slot; // for non-constant values
+			}; // end struct result_type
+
+			// Fields
+		private:
+			std::vector<Instruction> &instructions;
+			const std::vector<size_t> &columns;
+			size_t depth = 0;
+		public:
+			size_t nRegisters = 1;
+			size_t nColumns = 0;
+
+			// Constructors
+		public:
+			Compiler(std::vector<Instruction> &instructions, const std::vector<size_t> &columns)
+				:instructions(instructions),columns(columns)
+			{
+				// empty body
+			} // end Compiler constructor
+
+			// Folding Methods
+			template<typename Integer>
+			result_type literal(const Integer &value) const
+			{
+				return {true,static_cast<FloatType>(value),0};
+			} // end method literal
+
+			template<typename IDType>
+			result_type variable(IDType id)
+			{
+				size_t column = columns.at(id);
+				nColumns = std::max(nColumns,column+1);
+				result_type result = push();
+				emit(Opcode::load,result.slot,0,0,column);
+				return result;
+			} // end method variable
+
+			template<template<class> class Operator>
+			result_type unary(result_type child)
+			{
+				return apply(Operator<FloatType>(),child);
+			} // end method unary
+
+			template<template<class> class Operator>
+			result_type binary(result_type left, result_type right)
+			{
+				return apply(Operator<FloatType>(),left,right);
+			} // end method binary
+
+			/** Makes sure a value is in a register, so that it can be returned by the program.
+			 */
+			void materialize(result_type value)
+			{
+				if(value.isConstant)
+					emit(Opcode::broadcast,0,0,0,0,value.constant);
+			} // end method materialize
+
+		private:
+			result_type push()
+			{
+				nRegisters = std::max(nRegisters,depth+1);
+				return {false,0,depth++};
+			} // end method push
+
+			void emit(Opcode opcode, size_t destination, size_t left, size_t right, size_t column = 0,
+				FloatType constant = 0, long long int exponent = 0)
+			{
+				instructions.push_back({opcode,destination,left,right,column,constant,exponent});
+			} // end method emit
+
+			static result_type apply(Symbolic::FreeForms::OpTags::unary_plus<FloatType>, result_type operand)
+			{
+				return operand;
+			} // end function apply
+
+			result_type apply(Symbolic::FreeForms::OpTags::negate<FloatType>, result_type operand)
+			{
+				if(operand.isConstant)
+					return {true,-operand.constant,0};
+				emit(Opcode::negate,operand.slot,operand.slot,operand.slot);
+				return operand;
+			} // end method apply
+
+			result_type apply(Symbolic::FreeForms::OpTags::plus<FloatType>, result_type left, result_type right)
+			{
+				return combine(Opcode::add,left,right,left.constant + right.constant);
+			} // end method apply
+
+			result_type apply(Symbolic::FreeForms::OpTags::minus<FloatType>, result_type left, result_type right)
+			{
+				return combine(Opcode::subtract,left,right,left.constant - right.constant);
+			} // end method apply
+
+			result_type apply(Symbolic::FreeForms::OpTags::multiplies<FloatType>, result_type left, result_type right)
+			{
+				return combine(Opcode::multiply,left,right,left.constant * right.constant);
+			} // end method apply
+
+			result_type apply(Symbolic::FreeForms::OpTags::divides<FloatType>, result_type left, result_type right)
+			{
+				return combine(Opcode::divide,left,right,left.constant / right.constant);
+			} // end method apply
+
+			result_type apply(Symbolic::FreeForms::OpTags::bit_xor<FloatType>, result_type base, result_type exponent)
+			{
+				if(!base.isConstant && exponent.isConstant && std::trunc(exponent.constant) == exponent.constant
+					&& std::abs(exponent.constant) <= 1 << 30)
+				{
+					emit(Opcode::integerPower,base.slot,base.slot,base.slot,0,0,static_cast<long long int>(exponent.constant));
+					return base;
+				} // end if
+				return combine(Opcode::power,base,exponent,std::pow(base.constant,exponent.constant));
+			} // end method apply
+
+			/** Emits a binary instruction, first moving a constant operand to the free register
+			 *	above the stack, or returns folded if both operands are constant.
+			 */
+			result_type combine(Opcode opcode, result_type left, result_type right, FloatType folded)
+			{
+				if(left.isConstant && right.isConstant)
+					return {true,folded,0};
+
+				if(left.isConstant)
+				{
+					left.slot = push().slot;
+					--depth;
+					emit(Opcode::broadcast,left.slot,0,0,0,left.constant);
+					emit(opcode,right.slot,left.slot,right.slot);
+					return right;
+				} // end if
+				if(right.isConstant)
+				{
+					right.slot = push().slot;
+					--depth;
+					emit(Opcode::broadcast,right.slot,0,0,0,right.constant);
+				}
+				else
+					--depth; // pop right
+
+				emit(opcode,left.slot,left.slot,right.slot);
+				return left;
+			} // end method combine
+		}; // end class Compiler
+
+		// Fields
+	private:
+		std::vector<Instruction> instructions;
+		size_t nRegisters;
+		size_t nColumns;
+
+		// Constructors
+	public:
+		/** Compiles expression, reading the variable with symbol ID id from the column columns[id]
+		 *	of the bindings. Throws std::out_of_range if a variable has no column and
+		 *	std::invalid_argument if expression is empty.
+		 */
+		template<typename... ExpressionParameters>
+		Program(const Symbolic::FreeForms::Expression<ExpressionParameters...> &expression, const std::vector<size_t> &columns)
+		{
+			if(expression.empty())
+				throw std::invalid_argument("Can't compile an empty expression!");
+
+			Compiler compiler(instructions,columns);
+			compiler.materialize(expression.fold(compiler));
+			nRegisters = compiler.nRegisters;
+			nColumns = compiler.nColumns;
+		} // end Program constructor
+
+		// Methods
+	public:
+		/** Returns the number of instructions in the program.
+		 */
+		size_t size() const
+		{
+			return instructions.size();
+		} // end method size
+
+		/** Returns the minimum number of columns the bindings must have.
+		 */
+		size_t columns() const
+		{
+			return nColumns;
+		} // end method columns
+
+		/** Evaluates the program for nBindings bindings, where the value of column c in binding
+		 *	i is bindings[c][i], and writes the values to results[0..nBindings).
+		 */
+		void evaluate(const std::vector<const FloatType *> &bindings, size_t nBindings, FloatType *results) const
+		{
+			if(bindings.size() < nColumns)
+				throw std::invalid_argument("Too few columns of bindings for the variables of the program!");
+
+			std::vector<FloatType> registers(nRegisters*nLanes);
+			for(size_t begin = 0 ; begin < nBindings ; begin += nLanes)
+			{
+				size_t width = std::min(nLanes,nBindings-begin);
+				run(bindings,begin,width,registers.data());
+				std::copy(registers.data(),registers.data()+width,results+begin);
+			} // end for
+		} // end method evaluate
+
+		/** Convenience overload taking a vector per column, all of the same size, and returning
+		 *	a vector of values.
+		 */
+		std::vector<FloatType> evaluate(const std::vector<std::vector<FloatType>> &bindings) const
+		{
+			std::vector<const FloatType *> columns;
+			size_t nBindings = bindings.empty() ? 0 : bindings.front().size();
+			for(const auto &column : bindings)
+			{
+				if(column.size() != nBindings)
+					throw std::invalid_argument("All columns of bindings must have the same size!");
+				columns.push_back(column.data());
+			} // end foreach
+
+			std::vector<FloatType> results(nBindings);
+			evaluate(columns,nBindings,results.data());
+			return results;
+		} // end method evaluate
+
+	private:
+		/** Runs every instruction for the bindings [begin,begin+width), width <= nLanes. The
+		 *	result is left in the first register. Lanes past width compute garbage.
+		 */
+		void run(const std::vector<const FloatType *> &bindings, size_t begin, size_t width, FloatType *registers) const
+		{
+			for(const auto &instruction : instructions)
+			{
+				FloatType *destination = registers + instruction.destination*nLanes;
+				const FloatType *left = registers + instruction.left*nLanes;
+				const FloatType *right = registers + instruction.right*nLanes;
+
+				switch(instruction.opcode)
+				{
+				case Opcode::load:
+					if(width == nLanes)
+						std::copy(bindings[instruction.column]+begin,bindings[instruction.column]+begin+nLanes,destination);
+					else
+						std::copy(bindings[instruction.column]+begin,bindings[instruction.column]+begin+width,destination);
+					break;
+				case Opcode::broadcast:
+					for(size_t l = 0 ; l < nLanes ; ++l)
+						destination[l] = instruction.constant;
+					break;
+				case Opcode::negate:
+					map(destination,left,left,[](FloatType operand, FloatType){return -operand;});
+					break;
+				case Opcode::add:
+					map(destination,left,right,std::plus<FloatType>());
+					break;
+				case Opcode::subtract:
+					map(destination,left,right,std::minus<FloatType>());
+					break;
+				case Opcode::multiply:
+					map(destination,left,right,std::multiplies<FloatType>());
+					break;
+				case Opcode::divide:
+					map(destination,left,right,std::divides<FloatType>());
+					break;
+				case Opcode::integerPower:
+					raise(destination,instruction.exponent);
+					break;
+				case Opcode::power:
+					for(size_t l = 0 ; l < nLanes ; ++l)
+						destination[l] = std::pow(left[l],right[l]);
+					break;
+				} // end switch
+			} // end foreach
+		} // end method run
+
+		/** Sets every lane of destination to operation applied to the same lanes of left and right.
+		 *	destination may be the same as an operand, so the lanes are computed in a temporary for
+		 *	the compiler to vectorize the loop without checking for overlap.
+		 */
+		template<typename Operation>
+		static void map(FloatType *destination, const FloatType *left, const FloatType *right, Operation operation)
+		{
+			FloatType result[nLanes];
+			for(size_t l = 0 ; l < nLanes ; ++l)
+				result[l] = operation(left[l],right[l]);
+			std::copy(result,result+nLanes,destination);
+		} // end function map
+
+		/** Raises every lane of values to the same integer exponent by repeated squaring.
+		 */
+		static void raise(FloatType *values, long long int exponent)
+		{
+			FloatType factor[nLanes];
+			FloatType result[nLanes];
+			for(size_t l = 0 ; l < nLanes ; ++l)
+			{
+				factor[l] = values[l];
+				result[l] = 1;
+			} // end for
+
+			for(unsigned long long int e = exponent < 0 ? -static_cast<unsigned long long int>(exponent) : exponent ; e ; e /= 2)
+			{
+				if(e % 2 == 1)
+					for(size_t l = 0 ; l < nLanes ; ++l)
+						result[l] *= factor[l];
+				if(e > 1)
+					for(size_t l = 0 ; l < nLanes ; ++l)
+						factor[l] *= factor[l];
+			} // end for
+
+			for(size_t l = 0 ; l < nLanes ; ++l)
+				values[l] = exponent < 0 ? 1/result[l] : result[l];
+		} // end function raise
+	}; // end class Program
+
+
+	/** Converts an exact rational coefficient to FloatType.
+	 */
+	template<typename FloatType, typename IntType>
+	FloatType toFloat(const boost::rational<IntType> &value)
+	{
+		return static_cast<FloatType>(value.numerator()) / static_cast<FloatType>(value.denominator());
+	} // end function toFloat
+
+	// for built-in types and boost::multiprecision numbers
+	template<typename FloatType, typename Number>
+	FloatType toFloat(const Number &value)
+	{
+		return static_cast<FloatType>(value);
+	} // end function toFloat
+
+	/** Takes the base and offset of an affine solution as returned by LinearSystem::semiSymbolicSolve
+	 *	and nBindings bindings of the parameters, one column per column of base, and writes the value
+	 *	of variable i at binding k to results[i][k]. The coefficients are converted to FloatType once
+	 *	and the values are computed a chunk of bindings at a time: the parameters of the chunk stay in
+	 *	the cache while each row is written in a long run, accumulating nLanes values in registers,
+	 *	so that inputs and results are streamed through memory exactly once.
+	 */
+	template<size_t nLanes = 16, typename FloatType, typename DerivedBase, typename DerivedOffset>
+	void evaluate(const Eigen::MatrixBase<DerivedBase> &base, const Eigen::MatrixBase<DerivedOffset> &offset,
+		const std::vector<const FloatType *> &bindings, size_t nBindings, const std::vector<FloatType *> &results)
+	{
+		using IndexType = typename Eigen::MatrixBase<DerivedBase>::Index;
+
+		if(static_cast<size_t>(base.cols()) != bindings.size())
+			throw std::invalid_argument("There must be exactly one column of bindings for each column of the base!");
+		if(base.rows() != offset.rows())
+			throw std::invalid_argument("The base and offset must have the same number of rows!");
+		if(static_cast<size_t>(base.rows()) != results.size())
+			throw std::invalid_argument("There must be exactly one result array for each row of the base!");
+
+		Eigen::Matrix<FloatType,Eigen::Dynamic,Eigen::Dynamic> coefficients(base.rows(),base.cols());
+		std::vector<FloatType> constants(base.rows());
+		for(IndexType i = 0 ; i < base.rows() ; ++i)
+		{
+			constants[i] = toFloat<FloatType>(offset(i));
+			for(IndexType j = 0 ; j < base.cols() ; ++j)
+				coefficients(i,j) = toFloat<FloatType>(base(i,j));
+		} // end for
+
+		// rows are computed a chunk of bindings at a time, so that each result is written in long
+		// runs while the parameters of the chunk stay in the cache
+		const size_t chunkSize = 64*nLanes;
+		for(size_t chunk = 0 ; chunk < nBindings ; chunk += chunkSize)
+		{
+			size_t chunkEnd = std::min(chunk+chunkSize,nBindings);
+			for(IndexType i = 0 ; i < base.rows() ; ++i)
+				for(size_t begin = chunk ; begin < chunkEnd ; begin += nLanes)
+				{
+					size_t width = std::min(nLanes,chunkEnd-begin);
+					FloatType accumulator[nLanes];
+					for(size_t l = 0 ; l < nLanes ; ++l)
+						accumulator[l] = constants[i];
+					for(IndexType j = 0 ; j < base.cols() ; ++j)
+					{
+						const FloatType coefficient = coefficients(i,j);
+						const FloatType *column = bindings[j] + begin;
+						if(width == nLanes)
+							for(size_t l = 0 ; l < nLanes ; ++l)
+								accumulator[l] += coefficient*column[l];
+						else
+							for(size_t l = 0 ; l < width ; ++l)
+								accumulator[l] += coefficient*column[l];
+					} // end for
+					std::copy(accumulator,accumulator+width,results[i]+begin);
+				} // end for
+		} // end for
+	} // end function evaluate
+
+	/** Convenience overload taking a vector per parameter, all of the same size, and returning
+	 *	a vector of values per variable.
+	 */
+	template<typename FloatType, typename DerivedBase, typename DerivedOffset>
+	std::vector<std::vector<FloatType>> evaluate(const Eigen::MatrixBase<DerivedBase> &base, const Eigen::MatrixBase<DerivedOffset> &offset,
+		const std::vector<std::vector<FloatType>> &parameters)
+	{
+		std::vector<const FloatType *> bindings;
+		size_t nBindings = parameters.empty() ? 0 : parameters.front().size();
+		for(const auto &column : parameters)
+		{
+			if(column.size() != nBindings)
+				throw std::invalid_argument("All columns of bindings must have the same size!");
+			bindings.push_back(column.data());
+		} // end foreach
+
+		std::vector<std::vector<FloatType>> values(base.rows(),std::vector<FloatType>(nBindings));
+		std::vector<FloatType *> results;
+		for(auto &row : values)
+			results.push_back(row.data());
+
+		evaluate(base,offset,bindings,nBindings,results);
+		return values;
+	} // end function evaluate
+
+} // end namespace BatchEvaluation
+
+#endif // BATCH_EVALUATION_H
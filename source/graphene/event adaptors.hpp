@@ -19,6 +19,8 @@
 #ifndef EVENT_ADAPTORS_H
 #define EVENT_ADAPTORS_H
 
+#include <string>
+#include <sstream>
 #include <stdexcept>
 
 #include <GL/glew.h>
@@ -31,6 +33,11 @@ namespace graphene
 	namespace EventAdaptors
 	{
 		// TODO: rethink about who should be responsible to define the coordinate system.
+		/** Forwards GLUT events to a root control. The window is only redisplayed after events
+		 *	that leave the root control invalidated, so nothing is rendered while the user is idle.
+		 *	The root control must provide invalidated() and validate() in addition to the event
+		 *	handling methods.
+		 */
 		template<typename RootControlType>
 		class GLUT
 		{
@@ -48,27 +55,74 @@ namespace graphene
 			static RootControlType rootControl;
 			static coordinate_type pixelWidth, pixelHeight; // in millimetres
 			static bool wasInside;
+			static std::string windowTitle;
+			static unsigned long long framesRendered;
+			static unsigned long long framesAtLastCount;
+			static int timeAtLastCount; // in milliseconds
+			static double iFramesPerSecond;
 
 			/****************
 			*    Methods    *
 			****************/
 		public:
 			// TODO: add support for initializing rootControl
-			/** GLUT must be initialized before calling this method
+			/** GLUT must be initialized and a window created before calling this method.
+			 *	If title is not empty, the window title is set to it followed by the number of
+			 *	frames rendered per second, updated every second.
 			 */
-			static void initialize()
+			static void initialize(const std::string &title = "")
 			{
 				pixelWidth = (coordinate_type)glutGet(GLUT_SCREEN_WIDTH_MM) / glutGet(GLUT_SCREEN_WIDTH);
 				pixelHeight = (coordinate_type)glutGet(GLUT_SCREEN_HEIGHT_MM) / glutGet(GLUT_SCREEN_HEIGHT);
 				wasInside = false;
+
+				windowTitle = title;
+				framesRendered = framesAtLastCount = 0;
+				timeAtLastCount = glutGet(GLUT_ELAPSED_TIME);
+				iFramesPerSecond = 0;
+				glutTimerFunc(1000,countFrames,0);
 			} // end method initialize
 
+			/** Returns the number of frames rendered per second, measured over the last second.
+			 */
+			static double framesPerSecond()
+			{
+				return iFramesPerSecond;
+			} // end method framesPerSecond
+
+			static void countFrames(int)
+			{
+				int time = glutGet(GLUT_ELAPSED_TIME);
+				if(time > timeAtLastCount)
+					iFramesPerSecond = (framesRendered - framesAtLastCount)*1000.0/(time - timeAtLastCount);
+				framesAtLastCount = framesRendered;
+				timeAtLastCount = time;
+
+				if(!windowTitle.empty())
+				{
+					std::ostringstream title;
+					title << windowTitle << " (" << iFramesPerSecond << " fps)";
+					glutSetWindowTitle(title.str().c_str());
+				} // end if
+				glutTimerFunc(1000,countFrames,0);
+			} // end function countFrames
+
+			/** Requests a redisplay if the root control has changed since it was last rendered.
+			 */
+			static void redisplayIfInvalidated()
+			{
+				if(rootControl.invalidated())
+					glutPostRedisplay();
+			} // end function redisplayIfInvalidated
+
 			// TODO: add static methods implementing the rest of GLUT event handling functions
 			// TODO: use SFINAE to revert to default behaviour if root control does not implement
 			// all methods
+			/** Only needed if the root control can change without receiving events.
+			 */
 			static void idle()
 			{
-				glutPostRedisplay();
+				redisplayIfInvalidated();
 			} // end function idle
 
 			static void display() // TODO: what if I have to clear more buffers?
@@ -76,6 +130,8 @@ namespace graphene
 				glClear(GL_COLOR_BUFFER_BIT);
 
 				rootControl.render();
+				rootControl.validate();
+				++framesRendered;
 
 				glutSwapBuffers();
 			} // end function display
@@ -86,6 +142,7 @@ namespace graphene
 				coordinate_type sceneY = (glutGet(GLUT_WINDOW_HEIGHT)-1 - glutY)*pixelHeight;
 
 				rootControl.keyboardAscii(key,true,sceneX,sceneY);
+				redisplayIfInvalidated();
 			} // end function keyboard
 
 			static void keyboardUp(unsigned char key, int glutX, int glutY)
@@ -94,6 +151,7 @@ namespace graphene
 				coordinate_type sceneY = (glutGet(GLUT_WINDOW_HEIGHT)-1 - glutY)*pixelHeight;
 
 				rootControl.keyboardAscii(key,false,sceneX,sceneY);
+				redisplayIfInvalidated();
 			} // end function keyboard
 
 			static Frames::Interface::NonAsciiKey grapheneKey(int glutKey)
@@ -143,6 +201,7 @@ namespace graphene
 				coordinate_type sceneY = (glutGet(GLUT_WINDOW_HEIGHT)-1 - glutY)*pixelHeight;
 
 				rootControl.keyboardNonAscii(grapheneKey(glutKey),true,sceneX,sceneY);
+				redisplayIfInvalidated();
 			} // end function special
 
 			static void specialUp(int glutKey, int glutX, int glutY)
@@ -151,6 +210,7 @@ namespace graphene
 				coordinate_type sceneY = (glutGet(GLUT_WINDOW_HEIGHT)-1 - glutY)*pixelHeight;
 
 				rootControl.keyboardNonAscii(grapheneKey(glutKey),false,sceneX,sceneY);
+				redisplayIfInvalidated();
 			} // end function specialUp
 
 			static void mouse(int button, int state, int glutX, int glutY)
@@ -159,6 +219,7 @@ namespace graphene
 				coordinate_type sceneY = (glutGet(GLUT_WINDOW_HEIGHT)-1 - glutY)*pixelHeight;
 
 				rootControl.mouseButton(button == GLUT_LEFT_BUTTON ? 0 : (button == GLUT_RIGHT_BUTTON ? 1 : 2),state == GLUT_DOWN,sceneX,sceneY);
+				redisplayIfInvalidated();
 			} // end function motion
 
 			static void motion(int glutX, int glutY)
@@ -189,6 +250,8 @@ namespace graphene
 					{
 						// do nothing
 					} // end else
+
+				redisplayIfInvalidated();
 			} // end function motion
 
 			static void reshape(int windowWidth, int windowHeight)
@@ -200,6 +263,7 @@ namespace graphene
 				glMatrixMode(GL_PROJECTION);
 				glLoadIdentity();
 				gluOrtho2D(rootControl.left(),rootControl.right(),rootControl.bottom(),rootControl.top());
+				glutPostRedisplay();
 			} // end function reshape
 		}; // end class GLUT
 
@@ -212,6 +276,16 @@ namespace graphene
 		typename GLUT<RootControlType>::coordinate_type GLUT<RootControlType>::pixelHeight; // in millimetres
 		template<typename RootControlType>
 		bool GLUT<RootControlType>::wasInside;
+		template<typename RootControlType>
+		std::string GLUT<RootControlType>::windowTitle;
+		template<typename RootControlType>
+		unsigned long long GLUT<RootControlType>::framesRendered;
+		template<typename RootControlType>
+		unsigned long long GLUT<RootControlType>::framesAtLastCount;
+		template<typename RootControlType>
+		int GLUT<RootControlType>::timeAtLastCount; // in milliseconds
+		template<typename RootControlType>
+		double GLUT<RootControlType>::iFramesPerSecond;
 
 	} // end namespace EventAdaptors
 
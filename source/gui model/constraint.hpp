@@ -19,8 +19,9 @@
 #ifndef CONSTRAINT_H
 #define CONSTRAINT_H
 
-#include <map>
 #include <ratio>
+#include <cctype>
+#include <limits>
 #include <tuple>
 #include <vector>
 #include <string>
@@ -36,12 +37,12 @@
 #include <boost/property_tree/ptree.hpp>
 #include <boost/property_tree/xml_parser.hpp>
 
-#include <boost/spirit/include/qi.hpp>
-#include <boost/spirit/include/phoenix.hpp>
-
 #include "geometry.hpp"
 #include "graphene.hpp"
+#include "xml reader.hpp"
+#include "slot map.hpp"
 #include "symbol table.hpp"
+#include "symbolic computation.hpp"
 #include "gui model/controls.hpp"
 
 namespace GUIModel
@@ -57,6 +58,7 @@ namespace GUIModel
 			*********************/
 
 			using control_container_type = ControlContainerType;
+			using key_type = typename Containers::ContainerKey<ControlContainerType>::type;
 			using coordinate_type = typename control_container_type::value_type::coordinate_type;
 			using property_tree_type = boost::property_tree::ptree;
 			using side_type = geometry::RectangleSide;
@@ -67,7 +69,7 @@ namespace GUIModel
 		private:
 			ControlContainerType *iContainer;
 		public:
-			size_t control; // ordinal number of the referred control
+			key_type control; // key of the referred control in the container
 			side_type side; // enumerator of the referred side
 
 			/*********************
@@ -76,14 +78,20 @@ namespace GUIModel
 
 			ConstraintEndPoint() = default;
 
-			ConstraintEndPoint(ControlContainerType *container, size_t control, side_type side)
+			ConstraintEndPoint(ControlContainerType *container, key_type control, side_type side)
 				:iContainer(container),control(control),side(side)
 			{
 				// empty body
 			} // end ConstraintEndPoint constructor
 
 			ConstraintEndPoint(const property_tree_type &tree, ControlContainerType *container)
-				:iContainer(container),control(tree.get<size_t>("control")),side(to<side_type>(tree.get<std::string>("side")))
+				:iContainer(container),control(Containers::keyAt(*container,tree.get<size_t>("control"))),side(to<side_type>(tree.get<std::string>("side")))
+			{
+				// empty body
+			} // end ConstraintEndPoint conversion constructor
+
+			ConstraintEndPoint(const XML::Element &element, ControlContainerType *container)
+				:iContainer(container),control(Containers::keyAt(*container,element.get<size_t>("control"))),side(to<side_type>(element.get<std::string>("side")))
 			{
 				// empty body
 			} // end ConstraintEndPoint conversion constructor
@@ -107,12 +115,12 @@ namespace GUIModel
 			****************/
 
 			// iContainer is not serialized because there is only one container in application.
-			// May need to generalize later.
+			// May need to generalize later. The control is saved as its ordinal number in the container.
 			operator property_tree_type() const
 			{
 				property_tree_type tree;
 
-				tree.put("control",control);
+				tree.put("control",Containers::position(*iContainer,control));
 				tree.put("side",to<std::string>(side));
 
 				return tree;
@@ -201,15 +209,6 @@ namespace GUIModel
 			*    Member Types    *
 			*********************/
 		public:
-			template<typename IDType, typename RationalType>
-			struct ParseResult
-			{
-				// Fields
-				std::map<IDType,RationalType> varCoeff;
-				RationalType pxSizeCoeff;
-				RationalType rhsConstant;
-			}; // end struct ParseResult
-
 			using base_type = ConstraintBase<RectangleType, ControlContainerType, BorderSize, LineWidth, CaretWidth, TextType>;
 			using rectangle_type = RectangleType;
 			using control_container_type = ControlContainerType;
@@ -260,7 +259,7 @@ namespace GUIModel
 				updateSides();
 			} // end Control constructor
 
-			Constraint(ControlContainerType *container, size_t control1, side_type side1, size_t control2, side_type side2, coordinate_type localSide1, coordinate_type localSide2,
+			Constraint(ControlContainerType *container, typename EndPoint::key_type control1, side_type side1, typename EndPoint::key_type control2, side_type side2, coordinate_type localSide1, coordinate_type localSide2,
 				TextType text, coordinate_type textHeight, bool selected = false, bool highlighted = false, bool focused = false)
 			{
 				endPoints()[0].container() = container;
@@ -296,6 +295,23 @@ namespace GUIModel
 				updateSides();
 			} // end Constraint conversion constructor
 
+			/** Construct a Constraint from an element of a .las file, without building a property tree.
+			 */
+			Constraint(const XML::Element &element, ControlContainerType *container, bool selected = false, bool highlighted = false, bool focused = false)
+			{
+				endPoints()[0] = EndPoint(element.get_child("first-end-point"),container);
+				endPoints()[1] = EndPoint(element.get_child("second-end-point"),container);
+				localSides()[0] = element.get<coordinate_type>("first-local-side");
+				localSides()[1] = element.get<coordinate_type>("second-local-side");
+				this->text() = element.get<TextType>("text");
+				this->textHeight() = element.get<coordinate_type>("text-height");
+				this->selected() = selected;
+				this->highlighted() = highlighted;
+				this->focused() = focused;
+
+				updateSides();
+			} // end Constraint conversion constructor
+
 			/*************************
 			*    Accessor Methods    *
 			*************************/
@@ -546,64 +562,85 @@ namespace GUIModel
 				glPopAttrib();
 			} // end method render
 
-			template<typename RationalType, typename IDType, typename NameType>
-			ParseResult<IDType,RationalType> parse(std::shared_ptr<Symbolic::Common::SymbolTable<NameType,IDType>> symbols) const
-			{
-				namespace qi = boost::spirit::qi;
-				namespace px = boost::phoenix;
-				using qi::rule;
-				using qi::_val;	using qi::_1; using qi::_2;
-				using qi::alpha; using qi::alnum; using qi::digit; using qi::char_; using qi::eps; using qi::ulong_long;
-				using boost::spirit::ascii::space;
-				using boost::spirit::ascii::space_type;
-
-				ParseResult<IDType,RationalType> result;
-
-				struct Workaround
+			/** Converts the text of the constraint to an Expression with the same value, so that it can be
+			 *	lowered directly into a system row. The text is a sum of terms, each an optional '-', an
+			 *	optional integer, fraction or decimal coefficient and a unit or variable name. Millimeters
+			 *	are the unit of constants, so mm terms become plain numbers, while px becomes a variable
+			 *	declared in symbols like any other. Throws std::runtime_error on invalid text.
+			 */
+			template<typename IDType, typename NameType, typename UIntType = unsigned long long int>
+			Symbolic::FreeForms::Expression<UIntType,NameType,IDType> expression(std::shared_ptr<Symbolic::Common::SymbolTable<NameType,IDType>> symbols) const
+			{
+				using expression_type = Symbolic::FreeForms::Expression<UIntType,NameType,IDType>;
+				using namespace Symbolic::DSEL;
+
+				auto current = this->text().begin();
+				const auto end = this->text().end();
+				auto error = [](){throw std::runtime_error("Error parsing constraint!");};
+				auto skipSpaces = [&](){while(current != end && std::isspace(static_cast<unsigned char>(*current))) ++current;};
+				auto isDigit = [&](){return current != end && std::isdigit(static_cast<unsigned char>(*current));};
+				auto digits = [&](UIntType &value, UIntType &scale){ // appends digits to value, multiplying scale by 10 for each one
+					for( ; isDigit() ; ++current)
+					{
+						if(value > (std::numeric_limits<UIntType>::max() - 9) / 10 || scale > std::numeric_limits<UIntType>::max() / 10)
+							error();
+						value = 10*value + (*current - '0');
+						scale *= 10;
+					} // end for
+				};
+
+				expression_type result(symbols);
+				while(true)
 				{
-					/**	s must be a string of digits [0-9].
-					 */
-					static RationalType decimalPoint(RationalType r, const std::vector<char> &s)
-					{ // TODO: make overflow safe
-						unsigned long long n = 0;
-						unsigned long long d = 1;
-
-						for(auto c : s)
-						{
-							n *= 10;
-							n += c - '0';
-							d *= 10;
-						} // end foreach
-
-						return r + RationalType(n,d);
-					} // end function decimalPoint
-
-					static void populate(const RationalType &coeff, const NameType &symbol, ParseResult<IDType,RationalType> &result,
-						std::shared_ptr<Symbolic::Common::SymbolTable<NameType,IDType>> symbols)
+					skipSpaces();
+					bool negative = current != end && *current == '-';
+					if(negative)
+						++current;
+
+					// coefficient: [digits [('/' digits) | ('.' digits*)]]
+					bool hasNumber = isDigit();
+					UIntType numerator = 0, denominator = 1, scale = 1;
+					digits(numerator,scale);
+					if(!hasNumber)
+						numerator = 1;
+					else if(current != end && *current == '/')
+					{
+						++current;
+						if(!isDigit())
+							error();
+						denominator = 0;
+						digits(denominator,scale = 1);
+					}
+					else if(current != end && *current == '.')
 					{
-						if(symbol == "mm")
-							result.rhsConstant -= coeff;
-						else if(symbol == "px")
-							result.pxSizeCoeff += coeff;
-						else
-							result.varCoeff[symbols->declare(symbol)] += coeff;
-					} // end function populate
-				}; // end local struct Workaround
-
-				rule<typename TextType::const_iterator,NameType()> identifier = (alpha | char_('_')) > *(alnum | char_('_'));
-				rule<typename TextType::const_iterator,RationalType()> coefficient = (char_('-')[_val = -1] | eps[_val = 1]) >
-						-(ulong_long[_val *= _1] > -('/' > ulong_long[_val /= _1] | '.' > (*digit)[_val = px::bind(Workaround::decimalPoint,_val,_1)]));
-				rule<typename TextType::const_iterator,space_type> constraint = (coefficient > identifier)[px::bind(Workaround::populate,_1,_2,px::ref(result),px::ref(symbols))] % '+';
-
-				auto begin = this->text().begin();
-				auto end = this->text().end();
-
-				bool success = phrase_parse(begin,end,constraint,space);
-				if(!success || begin != end)
-					throw std::runtime_error("Error parsing constraint!");
-
-				return result;
-			} // end method parse
+						++current;
+						digits(numerator,denominator);
+					} // end else
+
+					// unit or variable
+					skipSpaces();
+					if(current == end || !(std::isalpha(static_cast<unsigned char>(*current)) || *current == '_'))
+						error();
+					NameType symbol;
+					for( ; current != end && (std::isalnum(static_cast<unsigned char>(*current)) || *current == '_') ; ++current)
+						symbol.push_back(*current);
+
+					expression_type coefficient = denominator == 1 ? expression_type(numerator,symbols)
+																   : expression_type(numerator,symbols) / expression_type(denominator,symbols);
+					expression_type term = symbol == "mm" ? coefficient
+										 : hasNumber ? coefficient * expression_type(symbol,symbols) : expression_type(symbol,symbols);
+					if(negative)
+						term = -term;
+					result = result.empty() ? term : result + term;
+
+					skipSpaces();
+					if(current == end)
+						return result;
+					if(*current != '+')
+						error();
+					++current;
+				} // end while
+			} // end method expression
 		}; // end class Constraint
 
 	} // end namespace Controls
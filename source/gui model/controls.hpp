@@ -25,6 +25,7 @@
 #include <boost/property_tree/xml_parser.hpp>
 
 #include "graphene.hpp"
+#include "xml reader.hpp"
 
 namespace GUIModel
 {
@@ -192,6 +193,22 @@ namespace GUIModel
 				this->focused() = focused;
 			} // end Control conversion constructor
 
+			/** Construct a Control from an element of a .las file, without building a property tree.
+			 */
+			Control(const XML::Element &element, bool selected = false, bool highlighted = false, bool focused = false)
+			{
+				this->left() = element.get<coordinate_type>("sides.left");
+				this->bottom() = element.get<coordinate_type>("sides.bottom");
+				this->right() = element.get<coordinate_type>("sides.right");
+				this->top() = element.get<coordinate_type>("sides.top");
+				this->borderSize() = element.get<coordinate_type>("borderSize");
+				this->name() = element.get<TextType>("name");
+				this->nameHeight() = element.get<coordinate_type>("nameHeight");
+				this->selected() = selected;
+				this->highlighted() = highlighted;
+				this->focused() = focused;
+			} // end Control conversion constructor
+
 			/****************
 			*    Methods    *
 			****************/
@@ -0,0 +1,605 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <deque>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+
+#include <boost/variant.hpp>
+
+#include "geometry.hpp"
+
+namespace GUIModel
+{
+	namespace Controls
+	{
+		/** An undo/redo history of the edits made to a Model, recorded as small deltas rather
+		 *	than snapshots: old and new values of moved sides, the changed part of edited texts
+		 *	and the fields of created or erased controls and constraints. Undoing or redoing an
+		 *	entry takes time proportional to its size.
+		 *	Entries are dropped oldest first when the estimated memory used by the history exceeds
+		 *	a configurable budget.
+		 *	Elements are referred to by the stable handles of the Model's slot maps. Erased elements
+		 *	are restored under their old handles and at their old places, so entries recorded
+		 *	later remain valid when applied in order.
+		 */
+		template<typename CoordinateType, typename TextType, typename ControlKeyType, typename ConstraintKeyType>
+		class Journal
+		{
+			/*********************
+			*    Member Types    *
+			*********************/
+		public:
+			using coordinate_type = CoordinateType;
+			using text_type = TextType;
+			using control_key_type = ControlKeyType;
+			using constraint_key_type = ConstraintKeyType;
+			using side_type = geometry::RectangleSide;
+
+			struct ControlSideChange
+			{
+				// Fields
+				ControlKeyType control;
+				side_type side;
+				CoordinateType from;
+				CoordinateType to;
+			}; // end struct ControlSideChange
+
+			struct LocalSideChange
+			{
+				// Fields
+				ConstraintKeyType constraint;
+				unsigned char index;
+				CoordinateType from;
+				CoordinateType to;
+			}; // end struct LocalSideChange
+
+			// Replacement of removed by inserted at position.
+			struct ControlNameChange
+			{
+				// Fields
+				ControlKeyType control;
+				size_t position;
+				TextType removed;
+				TextType inserted;
+			}; // end struct ControlNameChange
+
+			struct ConstraintTextChange
+			{
+				// Fields
+				ConstraintKeyType constraint;
+				size_t position;
+				TextType removed;
+				TextType inserted;
+			}; // end struct ConstraintTextChange
+
+			struct ControlLifetime
+			{
+				// Fields
+				bool created; // or erased
+				ControlKeyType control;
+				unsigned long long sequence;
+				bool last;
+				ControlKeyType successor;
+				TextType name;
+				CoordinateType nameHeight;
+				CoordinateType borderSize;
+				CoordinateType sides[4];
+			}; // end struct ControlLifetime
+
+			struct ConstraintLifetime
+			{
+				// Fields
+				bool created; // or erased
+				ConstraintKeyType constraint;
+				unsigned long long sequence;
+				bool last;
+				ConstraintKeyType successor;
+				ControlKeyType controls[2];
+				side_type sides[2];
+				CoordinateType localSides[2];
+				TextType text;
+				CoordinateType textHeight;
+			}; // end struct ConstraintLifetime
+
+			using delta_type = boost::variant<ControlSideChange,LocalSideChange,ControlNameChange,ConstraintTextChange,ControlLifetime,ConstraintLifetime>;
+
+		private:
+			struct Entry
+			{
+				// Fields
+				std::vector<delta_type> deltas;
+				size_t bytes;
+			}; // end struct Entry
+
+			// Estimates the heap memory owned by a delta, beyond the delta itself.
+			struct TextBytes : boost::static_visitor<size_t>
+			{
+				template<typename Delta>
+				size_t operator()(const Delta &) const
+				{
+					return 0;
+				} // end method operator()
+
+				size_t operator()(const ControlNameChange &change) const
+				{
+					return bytes(change.removed) + bytes(change.inserted);
+				} // end method operator()
+
+				size_t operator()(const ConstraintTextChange &change) const
+				{
+					return bytes(change.removed) + bytes(change.inserted);
+				} // end method operator()
+
+				size_t operator()(const ControlLifetime &lifetime) const
+				{
+					return bytes(lifetime.name);
+				} // end method operator()
+
+				size_t operator()(const ConstraintLifetime &lifetime) const
+				{
+					return bytes(lifetime.text);
+				} // end method operator()
+
+				static size_t bytes(const TextType &text)
+				{
+					return text.capacity()*sizeof(typename TextType::value_type);
+				} // end method bytes
+			}; // end struct TextBytes
+
+			template<typename ModelType>
+			struct Applier : boost::static_visitor<void>
+			{
+				// Fields
+				ModelType &model;
+				bool forward;
+
+				// Constructors
+				Applier(ModelType &model, bool forward)
+					:model(model),forward(forward)
+				{
+					// empty body
+				} // end Applier constructor
+
+				// Methods
+				void operator()(const ControlSideChange &change) const
+				{
+					if(!model.controls.contains(change.control))
+						return;
+					model.controls[change.control].side(change.side) = forward ? change.to : change.from;
+					model.reindexControl(change.control);
+					model.updateAttachedConstraints(change.control);
+				} // end method operator()
+
+				void operator()(const LocalSideChange &change) const
+				{
+					if(!model.constraints.contains(change.constraint))
+						return;
+					auto &constraint = model.constraints[change.constraint];
+					constraint.localSides()[change.index] = forward ? change.to : change.from;
+					constraint.updateSides();
+					model.reindexConstraint(change.constraint);
+				} // end method operator()
+
+				void operator()(const ControlNameChange &change) const
+				{
+					if(model.controls.contains(change.control))
+						replace(model.controls[change.control].name(),change.position,change.removed,change.inserted);
+				} // end method operator()
+
+				void operator()(const ConstraintTextChange &change) const
+				{
+					if(model.constraints.contains(change.constraint))
+						replace(model.constraints[change.constraint].text(),change.position,change.removed,change.inserted);
+				} // end method operator()
+
+				void operator()(const ControlLifetime &lifetime) const
+				{
+					if(forward == lifetime.created)
+					{
+						model.controls.restore(lifetime.control,lifetime.sequence,
+							lifetime.last ? model.controls.end() : model.controls.find(lifetime.successor),
+							lifetime.nameHeight,lifetime.name,lifetime.borderSize,
+							lifetime.sides[0],lifetime.sides[1],lifetime.sides[2],lifetime.sides[3]);
+						model.indexControl(lifetime.control);
+					}
+					else if(model.controls.contains(lifetime.control))
+						model.eraseControl(model.controls.find(lifetime.control));
+				} // end method operator()
+
+				void operator()(const ConstraintLifetime &lifetime) const
+				{
+					if(forward == lifetime.created)
+					{
+						model.constraints.restore(lifetime.constraint,lifetime.sequence,
+							lifetime.last ? model.constraints.end() : model.constraints.find(lifetime.successor),
+							&model.controls,lifetime.controls[0],lifetime.sides[0],lifetime.controls[1],lifetime.sides[1],
+							lifetime.localSides[0],lifetime.localSides[1],lifetime.text,lifetime.textHeight);
+						model.indexConstraint(lifetime.constraint);
+					}
+					else if(model.constraints.contains(lifetime.constraint))
+						model.eraseConstraint(model.constraints.find(lifetime.constraint));
+				} // end method operator()
+
+				void replace(TextType &text, size_t position, const TextType &removed, const TextType &inserted) const
+				{
+					if(forward)
+						text.replace(position,removed.size(),inserted);
+					else
+						text.replace(position,inserted.size(),removed);
+				} // end method replace
+			}; // end struct Applier
+
+			/***************
+			*    Fields    *
+			***************/
+
+			std::deque<Entry> iUndoStack;
+			std::vector<Entry> iRedoStack;
+			std::vector<delta_type> iGroup; // deltas of the entry being recorded
+			size_t iGroupDepth;
+			size_t iMemoryUsage;
+			size_t iMemoryBudget;
+			bool iApplying;
+
+			// state at the start of a drag or text edit
+			std::vector<ControlSideChange> iDragControlSides;
+			std::vector<LocalSideChange> iDragLocalSides;
+			bool iDragCreates;
+			bool iEditingControl;
+			bool iEditingConstraint;
+			ControlKeyType iEditedControl;
+			ConstraintKeyType iEditedConstraint;
+			TextType iEditedText;
+
+			/*********************
+			*    Constructors    *
+			*********************/
+		public:
+			/** Construct an empty Journal that uses about memoryBudget bytes at most.
+			 */
+			explicit Journal(size_t memoryBudget = size_t(1)<<22)
+				:iGroupDepth(0),iMemoryUsage(0),iMemoryBudget(memoryBudget),iApplying(false),
+				iDragCreates(false),iEditingControl(false),iEditingConstraint(false)
+			{
+				// empty body
+			} // end Journal constructor
+
+			/*************************
+			*    Accessor Methods    *
+			*************************/
+
+			bool canUndo() const
+			{
+				return !iUndoStack.empty();
+			} // end method canUndo
+
+			bool canRedo() const
+			{
+				return !iRedoStack.empty();
+			} // end method canRedo
+
+			size_t undoSize() const
+			{
+				return iUndoStack.size();
+			} // end method undoSize
+
+			size_t redoSize() const
+			{
+				return iRedoStack.size();
+			} // end method redoSize
+
+			/** Returns the estimated number of bytes used by the recorded entries.
+			 */
+			size_t memoryUsage() const
+			{
+				return iMemoryUsage;
+			} // end method memoryUsage
+
+			size_t memoryBudget() const
+			{
+				return iMemoryBudget;
+			} // end method memoryBudget
+
+			/** Changes the memory budget, dropping the oldest entries if needed.
+			 */
+			void setMemoryBudget(size_t memoryBudget)
+			{
+				iMemoryBudget = memoryBudget;
+				enforceBudget();
+			} // end method setMemoryBudget
+
+			/****************
+			*    Methods    *
+			****************/
+
+			void clear()
+			{
+				iUndoStack.clear();
+				iRedoStack.clear();
+				iGroup.clear();
+				iGroupDepth = 0;
+				iMemoryUsage = 0;
+				iDragControlSides.clear();
+				iDragLocalSides.clear();
+				iDragCreates = iEditingControl = iEditingConstraint = false;
+			} // end method clear
+
+			/** Records a delta, as a new entry or as part of the open group.
+			 *	Deltas are ignored while an entry is being undone or redone.
+			 */
+			void record(delta_type delta)
+			{
+				if(iApplying)
+					return;
+				iGroup.push_back(std::move(delta));
+				if(iGroupDepth == 0)
+					commit();
+			} // end method record
+
+			/** Starts an entry that will collect the deltas recorded until the matching closeGroup.
+			 *	Groups can be nested.
+			 */
+			void openGroup()
+			{
+				++iGroupDepth;
+			} // end method openGroup
+
+			void closeGroup()
+			{
+				if(--iGroupDepth == 0 && !iApplying)
+					commit();
+			} // end method closeGroup
+
+			template<typename ModelType>
+			bool undo(ModelType &model)
+			{
+				if(iUndoStack.empty())
+					return false;
+
+				Entry entry = std::move(iUndoStack.back());
+				iUndoStack.pop_back();
+				apply(model,entry,false);
+				iRedoStack.push_back(std::move(entry));
+				return true;
+			} // end method undo
+
+			template<typename ModelType>
+			bool redo(ModelType &model)
+			{
+				if(iRedoStack.empty())
+					return false;
+
+				Entry entry = std::move(iRedoStack.back());
+				iRedoStack.pop_back();
+				apply(model,entry,true);
+				iUndoStack.push_back(std::move(entry));
+				return true;
+			} // end method redo
+
+			/** Builds the delta describing the creation or erasure of a control.
+			 */
+			template<typename ContainerType>
+			static ControlLifetime controlLifetime(const ContainerType &controls, typename ContainerType::const_iterator control, bool created)
+			{
+				ControlLifetime lifetime;
+				lifetime.created = created;
+				lifetime.control = controls.key(control);
+				lifetime.sequence = controls.sequence(control);
+				lifetime.last = std::next(control) == controls.end();
+				lifetime.successor = lifetime.last ? lifetime.control : controls.key(std::next(control));
+				lifetime.name = control->name();
+				lifetime.nameHeight = control->nameHeight();
+				lifetime.borderSize = control->borderSize();
+				std::copy(std::begin(control->sides()),std::end(control->sides()),lifetime.sides);
+				return lifetime;
+			} // end method controlLifetime
+
+			/** Builds the delta describing the creation or erasure of a constraint.
+			 */
+			template<typename ContainerType>
+			static ConstraintLifetime constraintLifetime(const ContainerType &constraints, typename ContainerType::const_iterator constraint, bool created)
+			{
+				ConstraintLifetime lifetime;
+				lifetime.created = created;
+				lifetime.constraint = constraints.key(constraint);
+				lifetime.sequence = constraints.sequence(constraint);
+				lifetime.last = std::next(constraint) == constraints.end();
+				lifetime.successor = lifetime.last ? lifetime.constraint : constraints.key(std::next(constraint));
+				for(size_t i = 0 ; i < 2 ; ++i)
+				{
+					lifetime.controls[i] = constraint->endPoints()[i].control;
+					lifetime.sides[i] = constraint->endPoints()[i].side;
+					lifetime.localSides[i] = constraint->localSides()[i];
+				} // end for
+				lifetime.text = constraint->text();
+				lifetime.textHeight = constraint->textHeight();
+				return lifetime;
+			} // end method constraintLifetime
+
+			/** Remembers the sides the selected control or constraint of model can move, so that the
+			 *	whole drag can be recorded as a single entry by endDrag. If creating is true, the
+			 *	selected control was just created and its creation becomes part of the same entry.
+			 */
+			template<typename ModelType>
+			void beginDrag(const ModelType &model, bool creating = false)
+			{
+				iDragControlSides.clear();
+				iDragLocalSides.clear();
+				if((iDragCreates = creating))
+				{
+					openGroup();
+					record(controlLifetime(model.controls,model.selectedControl,true));
+				} // end if
+
+				auto rememberControl = [this,&model](ControlKeyType control){
+					for(auto side : {side_type::LEFT,side_type::BOTTOM,side_type::RIGHT,side_type::TOP})
+						iDragControlSides.push_back({control,side,model.controls[control].side(side),CoordinateType()});
+				};
+
+				if(model.selectedControl != model.controls.end())
+					rememberControl(model.controls.key(model.selectedControl));
+				if(model.selectedConstraint != model.constraints.end())
+				{
+					const auto &endPoints = model.selectedConstraint->endPoints();
+					rememberControl(endPoints[0].control);
+					if(endPoints[1].control != endPoints[0].control)
+						rememberControl(endPoints[1].control);
+					for(unsigned char i = 0 ; i < 2 ; ++i)
+						iDragLocalSides.push_back({model.constraints.key(model.selectedConstraint),i,model.selectedConstraint->localSides()[i],CoordinateType()});
+				} // end if
+			} // end method beginDrag
+
+			template<typename ModelType>
+			void endDrag(const ModelType &model)
+			{
+				openGroup();
+				for(auto change : iDragControlSides)
+					if(model.controls.contains(change.control) && (change.to = model.controls[change.control].side(change.side)) != change.from)
+						record(change);
+				for(auto change : iDragLocalSides)
+					if(model.constraints.contains(change.constraint) && (change.to = model.constraints[change.constraint].localSides()[change.index]) != change.from)
+						record(change);
+				closeGroup();
+				if(iDragCreates)
+					closeGroup();
+
+				iDragControlSides.clear();
+				iDragLocalSides.clear();
+				iDragCreates = false;
+			} // end method endDrag
+
+			/** Remembers the text of the focused control or constraint of model, so that all the
+			 *	typing until endTextEdit can be recorded as a single entry.
+			 */
+			template<typename ModelType>
+			void beginTextEdit(const ModelType &model)
+			{
+				iEditingControl = model.focusedControl != model.controls.end();
+				iEditingConstraint = model.focusedConstraint != model.constraints.end();
+				if(iEditingControl)
+				{
+					iEditedControl = model.controls.key(model.focusedControl);
+					iEditedText = model.focusedControl->name();
+				}
+				else if(iEditingConstraint)
+				{
+					iEditedConstraint = model.constraints.key(model.focusedConstraint);
+					iEditedText = model.focusedConstraint->text();
+				} // end else
+			} // end method beginTextEdit
+
+			template<typename ModelType>
+			void endTextEdit(const ModelType &model)
+			{
+				if(iEditingControl && model.controls.contains(iEditedControl))
+				{
+					ControlNameChange change{iEditedControl,0,TextType(),TextType()};
+					if(difference(iEditedText,model.controls[iEditedControl].name(),change.position,change.removed,change.inserted))
+						record(std::move(change));
+				}
+				else if(iEditingConstraint && model.constraints.contains(iEditedConstraint))
+				{
+					ConstraintTextChange change{iEditedConstraint,0,TextType(),TextType()};
+					if(difference(iEditedText,model.constraints[iEditedConstraint].text(),change.position,change.removed,change.inserted))
+						record(std::move(change));
+				} // end if
+				iEditingControl = iEditingConstraint = false;
+			} // end method endTextEdit
+
+		private:
+			/** Finds the part of before that was replaced to produce after, excluding the longest
+			 *	common prefix and suffix. Returns false if the texts are equal.
+			 */
+			static bool difference(const TextType &before, const TextType &after, size_t &position, TextType &removed, TextType &inserted)
+			{
+				if(before == after)
+					return false;
+
+				size_t prefix = std::mismatch(before.begin(),before.begin()+std::min(before.size(),after.size()),after.begin()).first - before.begin();
+				size_t suffix = 0;
+				while(suffix < before.size()-prefix && suffix < after.size()-prefix && before[before.size()-1-suffix] == after[after.size()-1-suffix])
+					++suffix;
+
+				position = prefix;
+				removed = before.substr(prefix,before.size()-prefix-suffix);
+				inserted = after.substr(prefix,after.size()-prefix-suffix);
+				return true;
+			} // end method difference
+
+			template<typename ModelType>
+			void apply(ModelType &model, const Entry &entry, bool forward)
+			{
+				iApplying = true;
+				Applier<ModelType> applier(model,forward);
+				if(forward)
+					for(const auto &delta : entry.deltas)
+						boost::apply_visitor(applier,delta);
+				else
+					for(auto delta = entry.deltas.rbegin() ; delta != entry.deltas.rend() ; ++delta)
+						boost::apply_visitor(applier,*delta);
+				iApplying = false;
+			} // end method apply
+
+			void commit()
+			{
+				if(iGroup.empty())
+					return;
+
+				Entry entry{std::move(iGroup),sizeof(Entry)};
+				iGroup.clear();
+				entry.deltas.shrink_to_fit();
+				entry.bytes += entry.deltas.capacity()*sizeof(delta_type);
+				for(const auto &delta : entry.deltas)
+					entry.bytes += boost::apply_visitor(TextBytes(),delta);
+
+				for(const auto &redone : iRedoStack)
+					iMemoryUsage -= redone.bytes;
+				iRedoStack.clear();
+
+				iMemoryUsage += entry.bytes;
+				iUndoStack.push_back(std::move(entry));
+				enforceBudget();
+			} // end method commit
+
+			void enforceBudget()
+			{
+				while(iMemoryUsage > iMemoryBudget && !iUndoStack.empty())
+				{
+					iMemoryUsage -= iUndoStack.front().bytes;
+					iUndoStack.pop_front();
+				} // end while
+				while(iMemoryUsage > iMemoryBudget && !iRedoStack.empty())
+				{
+					iMemoryUsage -= iRedoStack.front().bytes;
+					iRedoStack.erase(iRedoStack.begin());
+				} // end while
+			} // end method enforceBudget
+		}; // end class Journal
+
+	} // end namespace Controls
+
+} // end namespace GUIModel
+
+#endif // JOURNAL_H
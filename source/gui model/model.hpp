@@ -26,6 +26,7 @@
 #include <memory>
 #include <thread>
 #include <cstdlib>
+#include <tuple>
 #include <utility>
 #include <fstream>
 #include <cstdlib>
@@ -48,12 +49,17 @@
 #include <Eigen/Dense>
 
 #include "geometry.hpp"
+#include "spatial index.hpp"
+#include "slot map.hpp"
+#include "xml reader.hpp"
 #include "graphene.hpp"
 #include "symbol table.hpp"
 #include "portable type names.hpp"
+#include "linear lowering.hpp"
 #include "linear system solving.hpp"
 #include "gui model/controls.hpp"
 #include "gui model/constraint.hpp"
+#include "gui model/journal.hpp"
 
 namespace GUIModel
 {
@@ -89,13 +95,13 @@ namespace GUIModel
 
 			// components
 			using control_type = Control<geometry::Rectangle<CoordinateType>,std::ratio<-1>,std::ratio<2>,std::ratio<1>,TextType>;
-			using constraint_type = Constraint<geometry::Rectangle<CoordinateType>,std::vector<control_type>,std::ratio<1,2>,std::ratio<1,2>,std::ratio<1>,TextType>;
+			using constraint_type = Constraint<geometry::Rectangle<CoordinateType>,Containers::SlotMap<control_type>,std::ratio<1,2>,std::ratio<1,2>,std::ratio<1>,TextType>;
 			using button_type = Button<geometry::Rectangle<CoordinateType>,std::ratio<-1>,std::ratio<2>,TextType>;
 			using text_box_type = TextBox<geometry::Rectangle<CoordinateType>,std::ratio<-1>,std::ratio<2>,std::ratio<1>,TextType>;
 
 			// containers
-			using control_container_type = std::vector<control_type>;
-			using constraint_container_type = std::vector<constraint_type>;
+			using control_container_type = Containers::SlotMap<control_type>;
+			using constraint_container_type = Containers::SlotMap<constraint_type>;
 			using button_container_type = std::vector<std::pair<button_type,std::function<void()>>>;
 
 			// iterators
@@ -103,6 +109,11 @@ namespace GUIModel
 			using constraint_iterator = typename constraint_container_type::iterator;
 			using button_iterator = typename button_container_type::iterator;
 
+			// keys
+			using control_key_type = typename control_container_type::key_type;
+			using constraint_key_type = typename constraint_container_type::key_type;
+			using journal_type = Journal<CoordinateType,TextType,control_key_type,constraint_key_type>;
+
 			// shorthands
 			using property_tree_type = boost::property_tree::ptree;
 			using char_type = typename TextType::value_type;
@@ -124,18 +135,26 @@ namespace GUIModel
 			static constexpr int controlTextHeight = buttonTextHeight;
 			static constexpr int constraintTextHeight = 7;
 			static constexpr int constraintThickness = 7;
+			static constexpr int gridCellSize = 20; // in millimeters
 
 			// Colors
 			std::array<float,4> buttonColour = {{0.94f, 0.9f, 0.55f, 1.0f}}; // khaki
 			std::array<float,4> controlColour = {{1.0f, 0.75f, 0.0f, 1.0f}};	// gold
 			std::array<float,4> constraintColour = {{0.0f, 0.5f, 0.0f, 1.0f}}; // dark green
 
-			// TODO: change vector to list for faster operations, updating ConstraintEndPoints.
 			control_container_type controls;
 			constraint_container_type constraints;
 			button_container_type buttons;
 			text_box_type tbFileName;
 
+			// Hit testing indices, keyed by slot. Code that modifies the geometry of controls or
+			// constraints directly, rather than through the event handlers, should reindex them.
+			geometry::UniformGrid<CoordinateType,typename control_container_type::index_type> controlGrid;
+			geometry::UniformGrid<CoordinateType,typename constraint_container_type::index_type> constraintGrid;
+			std::vector<std::vector<constraint_key_type>> attachedConstraints; // constraints referring to each control slot
+
+			journal_type journal; // undo/redo history
+
 			button_iterator highlightedButton;
 			button_iterator pressedButton;
 
@@ -156,13 +175,14 @@ namespace GUIModel
 			unsigned long long controlIndex;
 
 			bool firstResize; // GLUT workaround (can't do first resize in constructor)
+			bool iInvalidated; // changed since last rendered
 			bool createOnMove;
 			bool inConstraintAddMode;
 
 			std::unique_ptr<IShapePart<CoordinateType>> endPoint1;
 			std::unique_ptr<IShapePart<CoordinateType>> endPoint2;
-			size_t control1;
-			size_t control2;
+			control_key_type control1;
+			control_key_type control2;
 			side_type side1;
 			side_type side2;
 
@@ -173,8 +193,8 @@ namespace GUIModel
 			/** Construct an empty Model.
 			 */
 			Model()
-				:tbFileName(textBoxTextHeight,"last session.las",borderSize,0,0,0,0),
-				controlIndex(0),firstResize(true),createOnMove(false),inConstraintAddMode(false)
+				:tbFileName(textBoxTextHeight,"last session.las",borderSize,0,0,0,0),controlGrid(gridCellSize),constraintGrid(gridCellSize),
+				controlIndex(0),firstResize(true),iInvalidated(true),createOnMove(false),inConstraintAddMode(false)
 			{
 				// initialize buttons
 				buttons.emplace_back(button_type(buttonTextHeight,"Load",borderSize,0,0,0,0),[this](){load(tbFileName.text());});
@@ -186,7 +206,7 @@ namespace GUIModel
 					[this](){run("build");});
 
 				// initialize controls
-				controls.emplace_back(controlTextHeight,"Screen",borderSize,0,0,0,0);
+				indexControl(controls.emplace_back(controlTextHeight,"Screen",borderSize,0,0,0,0));
 
 				// initialize pointers and iterators
 				highlightedButton = buttons.end();
@@ -205,7 +225,26 @@ namespace GUIModel
 			*    Methods    *
 			****************/
 		public:
-			// TODO: remove when converted to use std::list
+			/** Returns whether the model has changed in a way that affects rendering since the last
+			 *	call to validate. Event handlers invalidate the model when they change its state.
+			 */
+			bool invalidated() const
+			{
+				return iInvalidated;
+			} // end method invalidated
+
+			void invalidate()
+			{
+				iInvalidated = true;
+			} // end method invalidate
+
+			/** Should be called after rendering the model.
+			 */
+			void validate()
+			{
+				iInvalidated = false;
+			} // end method validate
+
 			void clearControlIterators()
 			{
 				highlightedControl = selectedControl = focusedControl = controls.end();
@@ -216,10 +255,97 @@ namespace GUIModel
 				highlightedConstraint = selectedConstraint = focusedConstraint = constraints.end();
 			} // end method clearConstraintIterators
 
+			/** Returns the rectangle in which the control responds to the mouse.
+			 */
+			static geometry::Rectangle<CoordinateType> bounds(const control_type &control)
+			{
+				return geometry::Rectangle<CoordinateType>(control.left(),control.bottom(),control.right(),control.top());
+			} // end method bounds
+
+			/** Returns the rectangle in which the constraint responds to the mouse.
+			 *	Vertical constraints store their sides transposed.
+			 */
+			static geometry::Rectangle<CoordinateType> bounds(const constraint_type &constraint)
+			{
+				if(constraint.isHorizontal())
+					return geometry::Rectangle<CoordinateType>(constraint.left(),constraint.bottom(),constraint.right(),constraint.top());
+				else
+					return geometry::Rectangle<CoordinateType>(constraint.bottom(),constraint.left(),constraint.top(),constraint.right());
+			} // end method bounds
+
+			void reindexControl(control_key_type control)
+			{
+				controlGrid.update(control.slot,bounds(controls[control]));
+			} // end method reindexControl
+
+			void reindexConstraint(constraint_key_type constraint)
+			{
+				constraintGrid.update(constraint.slot,bounds(constraints[constraint]));
+			} // end method reindexConstraint
+
+			/** Adds a control created without going through the Model to the indices.
+			 */
+			void indexControl(control_key_type control)
+			{
+				controlGrid.insert(control.slot,bounds(controls[control]));
+				if(attachedConstraints.size() < controls.slotCount())
+					attachedConstraints.resize(controls.slotCount());
+			} // end method indexControl
+
+			/** Adds a constraint to the indices and records that it refers to its end point controls.
+			 */
+			void indexConstraint(constraint_key_type constraint)
+			{
+				constraintGrid.insert(constraint.slot,bounds(constraints[constraint]));
+				const auto &endPoints = constraints[constraint].endPoints();
+				attachedConstraints[endPoints[0].control.slot].push_back(constraint);
+				if(endPoints[1].control != endPoints[0].control)
+					attachedConstraints[endPoints[1].control.slot].push_back(constraint);
+			} // end method indexConstraint
+
+			void rebuildIndices()
+			{
+				controlGrid.clear();
+				constraintGrid.clear();
+				attachedConstraints.assign(controls.slotCount(),std::vector<constraint_key_type>());
+
+				for(auto control = controls.begin() ; control != controls.end() ; ++control)
+					indexControl(controls.key(control));
+				for(auto constraint = constraints.begin() ; constraint != constraints.end() ; ++constraint)
+					indexConstraint(constraints.key(constraint));
+			} // end method rebuildIndices
+
+			/** Recomputes the cached geometry of the constraints referring to the given control
+			 *	after its sides have moved. The cost is proportional to the number of such
+			 *	constraints rather than to the number of all constraints.
+			 */
+			void updateAttachedConstraints(control_key_type control)
+			{
+				for(auto constraint : attachedConstraints[control.slot])
+				{
+					constraints[constraint].updateSides();
+					reindexConstraint(constraint);
+				} // end foreach
+			} // end method updateAttachedConstraints
+
+			/** Rebuilds the hit testing indices if controls or constraints were added or removed
+			 *	without going through the Model.
+			 */
+			void syncIndices()
+			{
+				if(controlGrid.size() != controls.size() || attachedConstraints.size() != controls.slotCount()
+					|| constraintGrid.size() != constraints.size())
+					rebuildIndices();
+			} // end method syncIndices
+
 			void clear()
 			{
 				controls.clear();
 				constraints.clear();
+				controlGrid.clear();
+				constraintGrid.clear();
+				attachedConstraints.clear();
+				journal.clear();
 
 				clearControlIterators();
 				clearConstraintIterators();
@@ -228,27 +354,43 @@ namespace GUIModel
 				caret = nullptr; // TODO: change to only become null if not pointing to text box.
 			} // end method clear
 
+			/** Erases a control together with the constraints referring to it. Takes time
+			 *	proportional to the number of those constraints. Iterators to erased elements
+			 *	held by the Model are reset. The erasure is recorded in the journal as one entry.
+			 */
 			auto eraseControl(control_iterator control)
 			{
-				size_t index = control - controls.begin();
-				auto result = controls.erase(control);
-				// TODO: replace with STL algorithms
-				for(auto constraint = constraints.begin() ; constraint < constraints.end() ; )
-					if(constraint->endPoints()[0].control == index || constraint->endPoints()[1].control == index)
-						constraint = constraints.erase(constraint);
-					else
-					{
-						if(constraint->endPoints()[0].control > index)
-							--constraint->endPoints()[0].control;
-						if(constraint->endPoints()[1].control > index)
-							--constraint->endPoints()[1].control;
-						++constraint;
-					} // end else
-				return result;
+				syncIndices();
+				auto key = controls.key(control);
+				auto &attached = attachedConstraints[key.slot];
+				journal.openGroup();
+				while(!attached.empty())
+					eraseConstraint(constraints.find(attached.back()));
+				journal.record(journal_type::controlLifetime(controls,control,false));
+				journal.closeGroup();
+
+				controlGrid.erase(key.slot);
+				for(auto iterator : {&highlightedControl,&selectedControl,&focusedControl})
+					if(*iterator == control)
+						*iterator = controls.end();
+				return controls.erase(control);
 			} // end method eraseControl
 
 			auto eraseConstraint(constraint_iterator constraint)
 			{
+				syncIndices();
+				auto key = constraints.key(constraint);
+				journal.record(journal_type::constraintLifetime(constraints,constraint,false));
+				for(const auto &endPoint : constraint->endPoints())
+				{
+					auto &attached = attachedConstraints[endPoint.control.slot];
+					attached.erase(std::remove(attached.begin(),attached.end(),key),attached.end());
+				} // end foreach
+
+				constraintGrid.erase(key.slot);
+				for(auto iterator : {&highlightedConstraint,&selectedConstraint,&focusedConstraint})
+					if(*iterator == constraint)
+						*iterator = constraints.end();
 				return constraints.erase(constraint);
 			} // end method eraseConstraint
 
@@ -288,6 +430,7 @@ namespace GUIModel
 
 			void unfocusAll()
 			{
+				journal.endTextEdit(*this);
 				if(focusedConstraint != constraints.end())
 				{
 					focusedConstraint->unfocus();
@@ -302,21 +445,50 @@ namespace GUIModel
 				caret = nullptr;
 			} // end method unfocusAll
 
+			/** Undoes the last entry of the journal, if any. Ends any pending drag or text edit first
+			 *	and clears highlighting, selection and focus, which may refer to affected elements.
+			 */
+			bool undo()
+			{
+				prepareForJournal();
+				return journal.undo(*this);
+			} // end method undo
+
+			bool redo()
+			{
+				prepareForJournal();
+				return journal.redo(*this);
+			} // end method redo
+
+			void prepareForJournal()
+			{
+				journal.endDrag(*this);
+				unfocusAll();
+				deselectAll();
+				dehighlightAll();
+				endPoint1 = nullptr;
+				endPoint2 = nullptr;
+			} // end method prepareForJournal
+
 			// TODO: check that there is at least one control (the screen) and that all constraints refer to
 			// existent controls! Also that endpoints are consistent.
+			/** Reads the file directly into controls and constraints, with the semantics and errors of
+			 *	reading it in a property tree with boost::property_tree::read_xml first.
+			 */
 			void load(const std::string &fileName)
 			{
 				clear();
-				property_tree_type tree, emptyTree;
-
-				boost::property_tree::read_xml(fileName,tree);
+				XML::Document document(fileName);
+				auto tree = document.root();
 
 				for(const auto &control : tree.get_child("gui-model.controls"))
-					controls.emplace_back(control.second);
+					controls.emplace_back(control);
 
-				for(const auto &constraint : tree.get_child("gui-model.constraints",emptyTree))
-					constraints.emplace_back(constraint.second,&controls);
+				if(auto constraintElements = tree.get_child_optional("gui-model.constraints"))
+					for(const auto &constraint : *constraintElements)
+						constraints.emplace_back(constraint,&controls);
 
+				rebuildIndices();
 				clearControlIterators();
 				clearConstraintIterators();
 			} // end method load
@@ -340,17 +512,29 @@ namespace GUIModel
 			Eigen::Matrix<RationalType,Eigen::Dynamic,Eigen::Dynamic> generateSystemMatrix() const
 			{
 				auto symbols = std::make_shared<Symbolic::Common::SymbolTable<NameType,IDType>>();
-				std::vector<typename constraint_type::template ParseResult<IDType,RationalType>> parseResults;
-
+				const IDType pixel = symbols->declare("px"); // an unknown constant rather than a named variable
+				std::vector<Symbolic::FreeForms::Expression<unsigned long long int,NameType,IDType>> expressions;
+				expressions.reserve(constraints.size());
 				for(const auto &constraint : constraints)
-					parseResults.push_back(constraint.template parse<RationalType,IDType,NameType>(symbols));
+					expressions.push_back(constraint.template expression<IDType,NameType>(symbols));
 				// TODO: optimize to not include unknown constants that are not present.
 
-				Eigen::Matrix<RationalType,Eigen::Dynamic,Eigen::Dynamic> result;
-				result.setZero(constraints.size(),4*controls.size() + symbols->size() + 1); // 4*(nControls-1) + nSymbols + 4 + 1
 				// the layout is control sides, then named variables, then unknown constants then known constant.
+				const size_t nSides = 4*(controls.size()-1);
+				const size_t firstUnknownConstant = nSides + symbols->size()-1;
+				const size_t knownConstant = firstUnknownConstant + 4;
 
-				// Fill in the augmented system matrix
+				// map symbol IDs to columns once for all constraints. A pixel has a different size horizontally and vertically.
+				std::vector<size_t> columns[2];
+				for(size_t orientation = 0 ; orientation < 2 ; ++orientation)
+				{
+					columns[orientation].reserve(symbols->size());
+					for(size_t id = 0 ; id < symbols->size() ; ++id)
+						columns[orientation].push_back(id == pixel ? firstUnknownConstant + 2 + orientation : nSides + id - (id > pixel));
+				} // end for
+
+				// Lower each constraint into a row of the augmented system matrix
+				LinearSystem::SparseRows<RationalType> rows(constraints.size(),4*constraints.size());
 				size_t i = 0;
 				for(const auto &constraint : constraints)
 				{
@@ -360,24 +544,21 @@ namespace GUIModel
 
 					for(size_t ep = 0 ; ep < 2 ; ++ep)
 					{
-						if(constraint.endPoints()[ep].control != 0)
-							result(i,4*(constraint.endPoints()[ep].control-1) + size_t(constraint.endPoints()[ep].side)) += coeffs[ep];
+						size_t control = controls.position(constraint.endPoints()[ep].control); // ordinal number of the referred control
+						if(control != 0)
+							rows.append(4*(control-1) + size_t(constraint.endPoints()[ep].side),coeffs[ep]);
 						else if(constraint.endPoints()[ep].side == geometry::RectangleSide::RIGHT || constraint.endPoints()[ep].side == geometry::RectangleSide::TOP)
-							result(i,4*(controls.size()-1) + symbols->size() + size_t(constraint.endPoints()[ep].side) - 2) += coeffs[ep];
+							rows.append(firstUnknownConstant + size_t(constraint.endPoints()[ep].side) - 2,coeffs[ep]);
 					} // end for
 
-					for(const auto &var : parseResults[i].varCoeff)
-						result(i,4*(controls.size()-1) + var.first) = var.second;
-
-					size_t offset = constraint.endPoints()[0].side == geometry::RectangleSide::LEFT || constraint.endPoints()[0].side == geometry::RectangleSide::RIGHT ? 0 : 1;
-					result(i,4*(controls.size()-1) + symbols->size() + 2 + offset) = parseResults[i].pxSizeCoeff;
-
-					result(i,4*(controls.size()-1) + symbols->size() + 4) = parseResults[i].rhsConstant; // already moved to rhs during parsing
+					size_t orientation = constraint.endPoints()[0].side == geometry::RectangleSide::LEFT || constraint.endPoints()[0].side == geometry::RectangleSide::RIGHT ? 0 : 1;
+					rows.append(knownConstant,-LinearSystem::lower(expressions[i],columns[orientation],rows)); // move to rhs
+					rows.endRow();
 
 					++i;
 				} // end foreach
 
-				return result;
+				return rows.toDense(knownConstant+1);
 			} // end method generateSystemMatrix
 
 
@@ -522,12 +703,18 @@ namespace GUIModel
 
 			void keyboardAscii(unsigned char code, bool down, CoordinateType x, CoordinateType y)
 			{
+				if(down) // shortcuts and carets ignore key releases
+					invalidate();
 				// TODO: move application exit somewhere outside Model class (or any UI widget for that matter)
 				if(code == 27 && down) // escape key
 					if(caret)
 						unfocusAll();
 					else
 						std::exit(0);
+				else if(code == 26 && down) // Ctrl+Z
+					undo();
+				else if(code == 25 && down) // Ctrl+Y
+					redo();
 				else if(caret)
 					caret->keyboardAscii(code,down,x,y);
 				else if(down && code == 0x7f) // delete key
@@ -535,15 +722,11 @@ namespace GUIModel
 					if(selectedConstraint != constraints.end())
 					{
 						eraseConstraint(selectedConstraint);
-						clearConstraintIterators();
 						selectedPart = nullptr;
 					}
 					else if(selectedControl != controls.end() && selectedControl != controls.begin()) // not screen
 					{
 						eraseControl(selectedControl);
-						clearControlIterators();
-						clearConstraintIterators();
-						// assumes more invalidations than actually happen but will fix when I switch to std::list
 						selectedPart = nullptr;
 					} // end if
 				} // end else
@@ -551,13 +734,16 @@ namespace GUIModel
 
 			void keyboardNonAscii(graphene::Frames::Interface::NonAsciiKey key, bool down, CoordinateType x, CoordinateType y)
 			{
+				if(down) // carets ignore key releases
+					invalidate();
 				if(key == graphene::Frames::Interface::NonAsciiKey::L_CTRL)
 				{
-					if(!(inConstraintAddMode = down))
+					if(!(inConstraintAddMode = down) && (endPoint1 || endPoint2))
 					{
 						endPoint1 = nullptr;
 						endPoint2 = nullptr;
-					} // end else
+						invalidate();
+					} // end if
 				}
 				else if(caret)
 					caret->keyboardNonAscii(key,down,x,y);
@@ -565,6 +751,7 @@ namespace GUIModel
 
 			void mouseButton(unsigned button, bool down, CoordinateType x, CoordinateType y)
 			{
+				invalidate();
 				if(button == 0)
 				{
 					if(down)
@@ -574,7 +761,7 @@ namespace GUIModel
 							if(highlightedControl != controls.end())
 							{
 								endPoint1 = highlightedControl->partUnderPoint(x,y);
-								control1 = highlightedControl - controls.begin();
+								control1 = controls.key(highlightedControl);
 								// Currently partUnderPoint returns a 'left' object if (x,y) is really left (where left < right),
 								// not on the LEFT side of the object.
 								// TODO: investigate if this is what we want.
@@ -598,10 +785,12 @@ namespace GUIModel
 										deselectAll();
 										auto avg = geometry::isHorizontal(side1) ? (endPoint1->left() + endPoint1->right() + endPoint2->left() + endPoint2->right())/4.0
 																				 : (endPoint1->bottom() + endPoint1->top() + endPoint2->bottom() + endPoint2->top())/4.0;
-										constraints.emplace_back(&controls,control1,side1,control2,side2,avg-0.5*constraintThickness,avg+0.5*constraintThickness,"",constraintTextHeight);
+										indexConstraint(constraints.emplace_back(&controls,control1,side1,control2,side2,avg-0.5*constraintThickness,avg+0.5*constraintThickness,"",constraintTextHeight));
 										highlightedConstraint = constraints.end();
 										(selectedConstraint = focusedConstraint = --constraints.end())->select().focus(); // no constraint was highlighted
 										caret = focusedConstraint->charAtIndex(focusedConstraint->text().size());
+										journal.record(journal_type::constraintLifetime(constraints,focusedConstraint,true));
+										journal.beginTextEdit(*this);
 
 										endPoint1 = nullptr;
 										endPoint2 = nullptr;
@@ -651,6 +840,7 @@ namespace GUIModel
 								{
 									unfocusAll();
 									caret = (focusedControl = highlightedControl)->focus().charUnderPoint(x,y);
+									journal.beginTextEdit(*this);
 								} // end else
 							} // end if
 
@@ -659,8 +849,12 @@ namespace GUIModel
 								selectedPart = (selectedConstraint = highlightedConstraint)->select().partUnderPoint(x,y);
 								unfocusAll();
 								caret = (focusedConstraint = highlightedConstraint)->focus().charUnderPoint(x,y);
+								journal.beginTextEdit(*this);
 							} // end if
 
+							if(selectedPart)
+								journal.beginDrag(*this);
+
 							if(pressedButton == buttons.end() && selectedControl == controls.end() && !tbFileName.highlighted() && selectedConstraint == constraints.end())
 								createOnMove = true;
 
@@ -677,6 +871,7 @@ namespace GUIModel
 						} // end if
 						pressedButton = buttons.end();
 
+						journal.endDrag(*this);
 						selectedPart = nullptr;
 
 						createOnMove = false;
@@ -689,24 +884,37 @@ namespace GUIModel
 				// do nothing
 			} // end method mouseEnter
 
+			/** Only invalidates the model if the highlighted item changes or something is moved, since
+			 *	most mouse moves change nothing.
+			 */
 			void mouseMove(CoordinateType x, CoordinateType y)
 			{
 				if(pressedButton != buttons.end())
+				{
+					if(pressedButton->first.pressed() != pressedButton->first.contains(x,y))
+						invalidate();
 					pressedButton->first.pressed() = pressedButton->first.contains(x,y);
+				}
 				else
 				{
+					syncIndices();
+					auto highlighted = std::make_tuple(highlightedButton,tbFileName.highlighted(),highlightedControl,highlightedConstraint);
+
 					if(createOnMove)
 					{
+						invalidate();
 						createOnMove = false;
 						// create new control
 						// TODO: push at front
 						unfocusAll();
 						if(highlightedControl != controls.end())
 							highlightedControl->dehighlight();
-						controls.emplace_back(controlTextHeight,"control"+std::to_string(controlIndex++),borderSize,x,y,x,y);
+						indexControl(controls.emplace_back(controlTextHeight,"control"+std::to_string(controlIndex++),borderSize,x,y,x,y));
 						(focusedControl = highlightedControl = selectedControl = --controls.end())->highlight().select().focus();
 						selectedPart = selectedControl->partUnderPoint(x,y); // TODO: guarantee this will be a corner
 						caret = focusedControl->charUnderPoint(x,y);
+						journal.beginTextEdit(*this);
+						journal.beginDrag(*this,true);
 
 						// add automatic constraints (temporary code)
 						//constraints.emplace_back(&controls,controls.size()-1,side_type::LEFT,controls.size()-1,side_type::RIGHT,y,y+constraintThickness,"0mm",constraintTextHeight);
@@ -720,12 +928,26 @@ namespace GUIModel
 
 					if(selectedPart)
 					{
+						if(x != lastX || y != lastY)
+							invalidate();
 						selectedPart->move(x-lastX,y-lastY);
 						lastX = x;
 						lastY = y;
 
-						for(auto &constraint : constraints) // TODO: detect and update only the affected constraints.
-							constraint.updateSides();
+						// moving a constraint moves the sides of the controls it refers to.
+						auto moved = [this](control_key_type control){
+							reindexControl(control);
+							updateAttachedConstraints(control);
+						};
+						if(selectedControl != controls.end())
+							moved(controls.key(selectedControl));
+						if(selectedConstraint != constraints.end())
+						{
+							const auto &endPoints = selectedConstraint->endPoints();
+							moved(endPoints[0].control);
+							if(endPoints[1].control != endPoints[0].control)
+								moved(endPoints[1].control);
+						} // end if
 					}
 					else // if dropping an object on another makes sence, then highlighting should be done regardless of selectedPart
 					{
@@ -740,22 +962,34 @@ namespace GUIModel
 						if(highlightedButton == buttons.end())
 							tbFileName.highlighted() = tbFileName.contains(x,y);
 
+						// only items indexed in the cell under the cursor can contain it. Candidates come in
+						// slot order, so the stacking order of the containers is restored with precedes.
 						if(!tbFileName.highlighted())
-							for(auto constraint = constraints.begin() ; constraint < constraints.end() ; ++constraint)
-								if(constraint->contains(x,y))
-								{
-									(highlightedConstraint = constraint)->highlight();
-									break;
-								} // end if
+							for(auto slot : constraintGrid.candidates(x,y))
+							{
+								auto constraint = constraints.fromSlot(slot);
+								if(constraint->contains(x,y) && (highlightedConstraint == constraints.end() || constraints.precedes(constraint,highlightedConstraint)))
+									highlightedConstraint = constraint;
+							} // end for
 
-						if(highlightedConstraint == constraints.end())
-							for(auto control = controls.rbegin() ; control < controls.rend() ; ++control) // TODO: restore front to back iteration when screen-at-front issue fixed
-								if(control->contains(x,y))
-								{
-									(highlightedControl = --control.base())->highlight();
-									break;
-								} // end if
+						if(highlightedConstraint != constraints.end())
+							highlightedConstraint->highlight();
+						else
+						{
+							for(auto slot : controlGrid.candidates(x,y)) // TODO: restore front to back order when screen-at-front issue fixed
+							{
+								auto control = controls.fromSlot(slot);
+								if(control->contains(x,y) && (highlightedControl == controls.end() || controls.precedes(highlightedControl,control)))
+									highlightedControl = control;
+							} // end for
+
+							if(highlightedControl != controls.end())
+								highlightedControl->highlight();
+						} // end else
 					} // end else
+
+					if(highlighted != std::make_tuple(highlightedButton,tbFileName.highlighted(),highlightedControl,highlightedConstraint))
+						invalidate();
 				} // end else
 			} // end method mouseMove
 
@@ -767,6 +1001,7 @@ namespace GUIModel
 			// TODO: perhaps replace resize with use of properties for left,right,bottom,top?
 			void resize(CoordinateType left, CoordinateType bottom, CoordinateType right, CoordinateType top)
 			{
+				invalidate();
 				this->left() = left;
 				this->bottom() = bottom;
 				this->right() = right;
@@ -807,6 +1042,7 @@ namespace GUIModel
 					controls.front().bottom() = bottom+margin;
 					controls.front().right() = right-margin;
 					controls.front().top() = top-2*margin-buttonHeight;
+					reindexControl(controls.key(controls.begin()));
 				} // end if
 			} // end method resize
 		}; // end class Model
@@ -822,6 +1058,8 @@ namespace GUIModel
 		constexpr int Model<CoordinateType,TextType>::textBoxTextHeight;
 		template<typename CoordinateType, typename TextType>
 		constexpr int Model<CoordinateType,TextType>::constraintTextHeight;
+		template<typename CoordinateType, typename TextType>
+		constexpr int Model<CoordinateType,TextType>::gridCellSize;
 
 	} // end namespace Controls
 
@@ -0,0 +1,406 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef INTERVAL_ARITHMETIC_H
+#define INTERVAL_ARITHMETIC_H
+
+#include <vector>
+#include <utility>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+
+#include <boost/rational.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#include <Eigen/Dense>
+
+#include "symbolic computation.hpp"
+
+namespace IntervalArithmetic
+{
+	/** A closed interval [lower,upper] of exact rational numbers. Operations return the
+	 *	smallest interval containing every result of the operation applied to members of
+	 *	the operands. RationalType should support exact arithmetic, e.g. boost::rational or
+	 *	boost::multiprecision::cpp_rational.
+	 */
+	template<typename RationalType>
+	class Interval
+	{
+		// Member Types
+	public:
+		using rational_type = RationalType;
+
+		// Fields
+	private:
+		RationalType lower;
+		RationalType upper;
+
+		// Constructors
+	public:
+		/** Construct the interval containing just value.
+		 */
+		Interval(const RationalType &value = RationalType(0))
+			:lower(value),upper(value)
+		{
+			// empty body
+		} // end Interval conversion constructor
+
+		Interval(RationalType lower, RationalType upper)
+			:lower(std::move(lower)),upper(std::move(upper))
+		{
+			if(this->upper < this->lower)
+				throw std::invalid_argument("The lower bound of an interval cannot exceed the upper bound!");
+		} // end Interval constructor
+
+		// Accessors
+		const RationalType &lowerBound() const
+		{
+			return lower;
+		} // end method lowerBound
+
+		const RationalType &upperBound() const
+		{
+			return upper;
+		} // end method upperBound
+
+		// Methods
+		bool contains(const RationalType &value) const
+		{
+			return !(value < lower) && !(upper < value);
+		} // end method contains
+
+		bool isPoint() const
+		{
+			return lower == upper;
+		} // end method isPoint
+
+		RationalType width() const
+		{
+			return upper - lower;
+		} // end method width
+
+		// Operators
+		Interval operator+() const
+		{
+			return *this;
+		} // end method operator+
+
+		Interval operator-() const
+		{
+			return Interval(-upper,-lower);
+		} // end method operator-
+
+		Interval &operator+=(const Interval &other)
+		{
+			lower += other.lower;
+			upper += other.upper;
+			return *this;
+		} // end method operator+=
+
+		Interval &operator-=(const Interval &other)
+		{
+			lower -= other.upper;
+			upper -= other.lower;
+			return *this;
+		} // end method operator-=
+
+		Interval &operator*=(const Interval &other)
+		{
+			if(isPoint())
+				return *this = other.scaled(lower);
+			if(other.isPoint())
+				return *this = scaled(other.lower);
+
+			RationalType products[] = {lower*other.lower, lower*other.upper, upper*other.lower, upper*other.upper};
+			auto bounds = std::minmax_element(std::begin(products),std::end(products));
+			lower = *bounds.first;
+			upper = *bounds.second;
+			return *this;
+		} // end method operator*=
+
+		Interval &operator/=(const Interval &other)
+		{
+			return *this *= other.reciprocal();
+		} // end method operator/=
+
+		bool operator==(const Interval &other) const
+		{
+			return lower == other.lower && upper == other.upper;
+		} // end method operator==
+
+		bool operator!=(const Interval &other) const
+		{
+			return !(*this == other);
+		} // end method operator!=
+
+		/** Returns the interval containing 1/x for every x in this one.
+		 *	Throws std::domain_error if this interval contains 0.
+		 */
+		Interval reciprocal() const
+		{
+			if(contains(RationalType(0)))
+				throw std::domain_error("Division by an interval containing zero!");
+			return Interval(RationalType(1)/upper,RationalType(1)/lower);
+		} // end method reciprocal
+
+		/** Returns the interval containing x^exponent for every x in this one. Even powers of
+		 *	intervals containing 0 are tight, unlike repeated multiplication.
+		 */
+		template<typename Integer>
+		Interval power(Integer exponent) const
+		{
+			static_assert(std::is_integral<Integer>::value, "The exponent must be an integer!");
+
+			if(exponent < 0)
+				return reciprocal().power(-exponent); // the result may be empty otherwise
+			if(exponent == 0)
+				return Interval(RationalType(1));
+
+			RationalType lowerPower = raise(lower,exponent);
+			RationalType upperPower = raise(upper,exponent);
+			if(exponent % 2 == 1 || !(lower < 0))
+				return Interval(std::move(lowerPower),std::move(upperPower));
+			if(!(0 < upper))
+				return Interval(std::move(upperPower),std::move(lowerPower));
+			return Interval(RationalType(0),std::max(lowerPower,upperPower));
+		} // end method power
+
+	private:
+		Interval scaled(const RationalType &factor) const
+		{
+			RationalType first = lower*factor;
+			RationalType second = upper*factor;
+			if(factor < 0)
+				return Interval(std::move(second),std::move(first));
+			return Interval(std::move(first),std::move(second));
+		} // end method scaled
+
+		template<typename Integer>
+		static RationalType raise(RationalType base, Integer exponent)
+		{
+			RationalType result(1);
+			while(exponent)
+			{
+				if(exponent % 2 == 1)
+					result *= base;
+				exponent /= 2;
+				if(exponent)
+					base *= base;
+			} // end while
+			return result;
+		} // end function raise
+	}; // end class Interval
+
+	template<typename RationalType>
+	inline Interval<RationalType> operator+(Interval<RationalType> left, const Interval<RationalType> &right)
+	{
+		return left += right;
+	} // end function operator+
+
+	template<typename RationalType>
+	inline Interval<RationalType> operator-(Interval<RationalType> left, const Interval<RationalType> &right)
+	{
+		return left -= right;
+	} // end function operator-
+
+	template<typename RationalType>
+	inline Interval<RationalType> operator*(Interval<RationalType> left, const Interval<RationalType> &right)
+	{
+		return left *= right;
+	} // end function operator*
+
+	template<typename RationalType>
+	inline Interval<RationalType> operator/(Interval<RationalType> left, const Interval<RationalType> &right)
+	{
+		return left /= right;
+	} // end function operator/
+
+	template<typename RationalType>
+	std::ostream &operator<<(std::ostream &out, const Interval<RationalType> &interval)
+	{
+		return out << '[' << interval.lowerBound() << ',' << interval.upperBound() << ']';
+	} // end function operator<<
+
+
+	/** An algebra for Symbolic::FreeForms::Expression::fold computing the range of an expression
+	 *	when each variable ranges over an interval. ranges.at(id) should return the interval of
+	 *	the variable with the given id, or throw if there is none. A std::vector indexed by ID
+	 *	or a std::map from IDs will do.
+	 *
+	 *	Each node is evaluated once, so the result is exact when every variable appears at most
+	 *	once in the expression and may be wider, but still contains the range, otherwise.
+	 *	Exponents must be integer constants.
+	 */
+	template<typename RationalType, typename RangeMap>
+	class Evaluator
+	{
+		// Member Types
+	public:
+		using result_type = Interval<RationalType>;
+
+		// Fields
+	private:
+		const RangeMap &ranges;
+
+		// Constructors
+	public:
+		explicit Evaluator(const RangeMap &ranges)
+			:ranges(ranges)
+		{
+			// empty body
+		} // end Evaluator constructor
+
+		// Folding Methods
+		template<typename Integer>
+		result_type literal(const Integer &value) const
+		{
+			return result_type(toRational(value,std::is_constructible<RationalType,const Integer &>()));
+		} // end method literal
+
+		template<typename IDType>
+		result_type variable(IDType id) const
+		{
+			return ranges.at(id);
+		} // end method variable
+
+		template<template<class> class Operator>
+		result_type unary(result_type child) const
+		{
+			return Operator<result_type>()(child);
+		} // end method unary
+
+		template<template<class> class Operator>
+		result_type binary(result_type left, result_type right) const
+		{
+			return apply(Operator<result_type>(),left,right);
+		} // end method binary
+
+	private:
+		template<typename Integer>
+		static RationalType toRational(const Integer &value, std::true_type)
+		{
+			return RationalType(value);
+		} // end function toRational
+
+		template<typename Integer>
+		static RationalType toRational(const Integer &, std::false_type)
+		{
+			throw std::overflow_error("Literal too large for the rational type used in interval evaluation!");
+		} // end function toRational
+
+		template<typename Operator>
+		static result_type apply(Operator op, const result_type &left, const result_type &right)
+		{
+			return op(left,right);
+		} // end function apply
+
+		static result_type apply(Symbolic::FreeForms::OpTags::bit_xor<result_type>, const result_type &base, const result_type &exponent)
+		{
+			if(!exponent.isPoint() || !isInteger(exponent.lowerBound()))
+				throw std::domain_error("Only integer constant exponents are supported in interval evaluation!");
+			return base.power(toInteger(exponent.lowerBound()));
+		} // end function apply
+
+		template<typename IntType>
+		static bool isInteger(const boost::rational<IntType> &value)
+		{
+			return value.denominator() == 1;
+		} // end function isInteger
+
+		template<typename IntType>
+		static long long int toInteger(const boost::rational<IntType> &value)
+		{
+			return boost::numeric_cast<long long int>(value.numerator());
+		} // end function toInteger
+
+		// for boost::multiprecision rationals
+		template<typename Number>
+		static bool isInteger(const Number &value)
+		{
+			return denominator(value) == 1;
+		} // end function isInteger
+
+		template<typename Number>
+		static long long int toInteger(const Number &value)
+		{
+			auto integer = numerator(value);
+			if(integer < std::numeric_limits<long long int>::min() || std::numeric_limits<long long int>::max() < integer)
+				throw std::overflow_error("Exponent too large for interval evaluation!");
+			return static_cast<long long int>(integer);
+		} // end function toInteger
+	}; // end class Evaluator
+
+	/** Convenience function returning the range of expression when each of its variables
+	 *	ranges over the interval given by ranges.at(id).
+	 */
+	template<typename RationalType, typename RangeMap, typename... ExpressionParameters>
+	Interval<RationalType> evaluate(const Symbolic::FreeForms::Expression<ExpressionParameters...> &expression, const RangeMap &ranges)
+	{
+		return expression.fold(Evaluator<RationalType,RangeMap>(ranges));
+	} // end function evaluate
+
+	/** Takes the base and offset of an affine solution as returned by LinearSystem::semiSymbolicSolve
+	 *	and the intervals the parameters range over, one for each column of base, and returns the
+	 *	range of each variable in the solution. Each parameter appears once per variable, so the
+	 *	ranges are exact, and computing them takes a single pass over base.
+	 */
+	template<typename DerivedBase, typename DerivedOffset>
+	auto evaluate(const Eigen::MatrixBase<DerivedBase> &base, const Eigen::MatrixBase<DerivedOffset> &offset,
+		const std::vector<Interval<typename Eigen::MatrixBase<DerivedBase>::Scalar>> &parameterRanges)->
+		std::vector<Interval<typename Eigen::MatrixBase<DerivedBase>::Scalar>>
+	{
+		using IndexType = typename Eigen::MatrixBase<DerivedBase>::Index;
+		using RationalType = typename Eigen::MatrixBase<DerivedBase>::Scalar;
+
+		if(static_cast<size_t>(base.cols()) != parameterRanges.size())
+			throw std::invalid_argument("There must be exactly one parameter range for each column of the base!");
+		if(base.rows() != offset.rows())
+			throw std::invalid_argument("The base and offset must have the same number of rows!");
+
+		std::vector<Interval<RationalType>> result;
+		result.reserve(base.rows());
+		for(IndexType i = 0 ; i < base.rows() ; ++i)
+		{
+			RationalType lower = offset(i);
+			RationalType upper = offset(i);
+			for(IndexType j = 0 ; j < base.cols() ; ++j)
+			{
+				const RationalType &coefficient = base(i,j);
+				if(0 < coefficient)
+				{
+					lower += coefficient*parameterRanges[j].lowerBound();
+					upper += coefficient*parameterRanges[j].upperBound();
+				}
+				else if(coefficient < 0)
+				{
+					lower += coefficient*parameterRanges[j].upperBound();
+					upper += coefficient*parameterRanges[j].lowerBound();
+				} // end if
+			} // end for
+			result.emplace_back(std::move(lower),std::move(upper));
+		} // end for
+
+		return result;
+	} // end function evaluate
+
+} // end namespace IntervalArithmetic
+
+#endif // INTERVAL_ARITHMETIC_H
@@ -0,0 +1,231 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LINEAR_LOWERING_H
+#define LINEAR_LOWERING_H
+
+#include <vector>
+#include <limits>
+#include <utility>
+#include <stdexcept>
+#include <type_traits>
+
+#include <cassert>
+
+#include <boost/rational.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
+#include "symbolic computation.hpp"
+#include "linear system solving.hpp"
+
+namespace LinearSystem
+{
+	/** An algebra for Symbolic::FreeForms::Expression::fold that lowers a linear expression into
+	 *	the open row of a SparseRows buffer in a single pass. Each variable is appended as soon as
+	 *	it's visited, in the column columns[id] of its symbol ID, and constant factors are applied
+	 *	in place to the entries of the subexpression they multiply. Since fold visits nodes in
+	 *	postorder, the entries of any subexpression are contiguous in the buffer. The constant
+	 *	term is returned instead of being appended, as its column depends on the caller.
+	 *
+	 *	Expressions that aren't linear, e.g. containing products of variables, divisions by
+	 *	variables or variable exponents, throw std::domain_error.
+	 */
+	template<typename RationalType>
+	class Lowering
+	{
+		// member types
+	public:
+		struct result_type
+		{
+			// fields
+			RationalType constant;
+			size_t begin; // entries for the variables are in [begin,end)
+			size_t end;
+
+			// methods
+			bool isConstant() const
+			{
+				return begin == end;
+			} // end method isConstant
+		}; // end struct result_type
+
+		// fields
+	private:
+		SparseRows<RationalType> &rows;
+		const std::vector<size_t> &columns;
+
+		// constructors
+	public:
+		Lowering(SparseRows<RationalType> &rows, const std::vector<size_t> &columns)
+			:rows(rows),columns(columns)
+		{
+			// empty body
+		} // end Lowering constructor
+
+		// folding methods
+		template<typename Integer>
+		result_type literal(const Integer &value) const
+		{
+			return {toRational(value,std::is_constructible<RationalType,const Integer &>()),rows.size(),rows.size()};
+		} // end method literal
+
+		template<typename IDType>
+		result_type variable(IDType id) const
+		{
+			rows.append(columns.at(id),RationalType(1));
+			return {RationalType(0),rows.size()-1,rows.size()};
+		} // end method variable
+
+		template<template<class> class Operator>
+		result_type unary(result_type child) const
+		{
+			return apply(Operator<RationalType>(),std::move(child));
+		} // end method unary
+
+		template<template<class> class Operator>
+		result_type binary(result_type left, result_type right) const
+		{
+			assert(left.end == right.begin);
+			return apply(Operator<RationalType>(),std::move(left),std::move(right));
+		} // end method binary
+
+	private:
+		result_type scaled(result_type operand, const RationalType &factor) const
+		{
+			operand.constant *= factor;
+			for(size_t e = operand.begin ; e < operand.end ; ++e)
+				rows.entry(e).second *= factor;
+			return operand;
+		} // end method scaled
+
+		static result_type apply(Symbolic::FreeForms::OpTags::unary_plus<RationalType>, result_type operand)
+		{
+			return operand;
+		} // end function apply
+
+		result_type apply(Symbolic::FreeForms::OpTags::negate<RationalType>, result_type operand) const
+		{
+			return scaled(std::move(operand),RationalType(-1));
+		} // end method apply
+
+		static result_type apply(Symbolic::FreeForms::OpTags::plus<RationalType>, result_type left, result_type right)
+		{
+			return {left.constant + right.constant,left.begin,right.end};
+		} // end function apply
+
+		result_type apply(Symbolic::FreeForms::OpTags::minus<RationalType>, result_type left, result_type right) const
+		{
+			return apply(Symbolic::FreeForms::OpTags::plus<RationalType>(),std::move(left),scaled(std::move(right),RationalType(-1)));
+		} // end method apply
+
+		result_type apply(Symbolic::FreeForms::OpTags::multiplies<RationalType>, result_type left, result_type right) const
+		{
+			// the entries of a constant operand are empty, so those of the other one are those of the product
+			if(left.isConstant())
+				return scaled(std::move(right),left.constant);
+			if(right.isConstant())
+				return scaled(std::move(left),right.constant);
+			throw std::domain_error("Products of variables are not linear!");
+		} // end method apply
+
+		result_type apply(Symbolic::FreeForms::OpTags::divides<RationalType>, result_type left, result_type right) const
+		{
+			if(!right.isConstant())
+				throw std::domain_error("Divisions by variables are not linear!");
+			if(right.constant == 0)
+				throw std::domain_error("Division by zero!");
+			return scaled(std::move(left),RationalType(1)/right.constant);
+		} // end method apply
+
+		static result_type apply(Symbolic::FreeForms::OpTags::bit_xor<RationalType>, result_type base, result_type exponent)
+		{
+			if(!exponent.isConstant() || !isInteger(exponent.constant))
+				throw std::domain_error("Only integer constant exponents are supported in linear expressions!");
+			if(exponent.constant == 1)
+				return base;
+			if(!base.isConstant())
+				throw std::domain_error("Powers of variables are not linear!");
+
+			long long int n = toInteger(exponent.constant);
+			RationalType factor = n < 0 ? RationalType(1)/base.constant : base.constant;
+			RationalType result(1);
+			for(unsigned long long int e = n < 0 ? -static_cast<unsigned long long int>(n) : n ; e ; e /= 2)
+			{
+				if(e % 2 == 1)
+					result *= factor;
+				if(e > 1)
+					factor *= factor;
+			} // end for
+			return {std::move(result),base.begin,base.end};
+		} // end function apply
+
+		template<typename Integer>
+		static RationalType toRational(const Integer &value, std::true_type)
+		{
+			return RationalType(value);
+		} // end function toRational
+
+		template<typename Integer>
+		static RationalType toRational(const Integer &, std::false_type)
+		{
+			throw std::overflow_error("Literal too large for the rational type used in lowering!");
+		} // end function toRational
+
+		template<typename IntType>
+		static bool isInteger(const boost::rational<IntType> &value)
+		{
+			return value.denominator() == 1;
+		} // end function isInteger
+
+		template<typename IntType>
+		static long long int toInteger(const boost::rational<IntType> &value)
+		{
+			return boost::numeric_cast<long long int>(value.numerator());
+		} // end function toInteger
+
+		// for boost::multiprecision rationals
+		template<typename Number>
+		static bool isInteger(const Number &value)
+		{
+			return denominator(value) == 1;
+		} // end function isInteger
+
+		template<typename Number>
+		static long long int toInteger(const Number &value)
+		{
+			auto integer = numerator(value);
+			if(integer < std::numeric_limits<long long int>::min() || std::numeric_limits<long long int>::max() < integer)
+				throw std::overflow_error("Exponent too large for lowering!");
+			return static_cast<long long int>(integer);
+		} // end function toInteger
+	}; // end class Lowering
+
+	/** Appends the variable terms of a linear expression to the open row of rows, mapping symbol
+	 *	IDs to columns through columns, and returns its constant term. The row is left open so
+	 *	that the caller can add more entries, like the constant term, before closing it.
+	 */
+	template<typename RationalType, typename... ExpressionParameters>
+	RationalType lower(const Symbolic::FreeForms::Expression<ExpressionParameters...> &expression,
+		const std::vector<size_t> &columns, SparseRows<RationalType> &rows)
+	{
+		return expression.fold(Lowering<RationalType>(rows,columns)).constant;
+	} // end function lower
+
+} // end namespace LinearSystem
+
+#endif // LINEAR_LOWERING_H
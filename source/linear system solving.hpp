@@ -276,6 +276,132 @@ namespace LinearSystem
 								numSolution.second.bottomRows(properties.isImpossible ? 0 : properties.nUnknownConstants));
 	} // end function semiSymbolicSolve
 
+
+	/** An augmented system matrix stored by rows, keeping only the nonzero coefficients. Rows are
+	 *	assembled one at a time by appending (column,coefficient) entries to the open row in any
+	 *	order, possibly more than once per column, and then closing it with endRow(), which sorts
+	 *	the entries by column, adds up the ones in the same column and drops the zeros.
+	 *	All rows share a single entry buffer that can be reserved in advance.
+	 */
+	template<typename RationalType>
+	class SparseRows
+	{
+		// member types
+	public:
+		using entry_type = std::pair<size_t,RationalType>;
+		using const_iterator = typename std::vector<entry_type>::const_iterator;
+
+		// fields
+	private:
+		std::vector<entry_type> entries;
+		std::vector<size_t> rowEnds; // entries of row i are in [rowEnds[i-1],rowEnds[i]) with rowEnds[-1] == 0
+		size_t nColumns = 0; // 1 + the largest column appearing in a closed row
+
+		// constructors
+	public:
+		explicit SparseRows(size_t expectedRows = 0, size_t expectedEntries = 0)
+		{
+			reserve(expectedRows,expectedEntries);
+		} // end SparseRows constructor
+
+		// methods
+		void reserve(size_t expectedRows, size_t expectedEntries)
+		{
+			rowEnds.reserve(expectedRows);
+			entries.reserve(expectedEntries);
+		} // end method reserve
+
+		size_t rows() const
+		{
+			return rowEnds.size();
+		} // end method rows
+
+		/** The number of columns needed to hold every closed row.
+		 */
+		size_t cols() const
+		{
+			return nColumns;
+		} // end method cols
+
+		/** The number of entries appended so far, including those of the open row.
+		 */
+		size_t size() const
+		{
+			return entries.size();
+		} // end method size
+
+		void append(size_t column, RationalType coefficient)
+		{
+			entries.emplace_back(column,std::move(coefficient));
+		} // end method append
+
+		/** Gives access to an entry of the open row by its index in the whole buffer, so that
+		 *	code assembling the row can revise coefficients it has already appended.
+		 */
+		entry_type &entry(size_t index)
+		{
+			assert(index >= openRowBegin() && index < entries.size());
+			return entries[index];
+		} // end method entry
+
+		void endRow()
+		{
+			auto begin = entries.begin() + openRowBegin();
+			std::sort(begin,entries.end(),[](const entry_type &a, const entry_type &b){return a.first < b.first;});
+
+			auto out = begin;
+			for(auto in = begin ; in != entries.end() ; )
+			{
+				entry_type merged = std::move(*in);
+				for(++in ; in != entries.end() && in->first == merged.first ; ++in)
+					merged.second += in->second;
+				if(merged.second != 0)
+					*out++ = std::move(merged);
+			} // end for
+			entries.erase(out,entries.end());
+
+			if(begin != entries.end())
+				nColumns = std::max(nColumns,entries.back().first+1);
+			rowEnds.push_back(entries.size());
+		} // end method endRow
+
+		std::pair<const_iterator,const_iterator> row(size_t i) const
+		{
+			return std::make_pair(entries.begin() + (i ? rowEnds[i-1] : 0),entries.begin() + rowEnds[i]);
+		} // end method row
+
+		/** Writes the nonzero coefficients into a matrix with enough rows and columns.
+		 *	Other elements are left untouched, so the matrix should normally be zeroed first.
+		 */
+		template<typename Derived>
+		void scatter(Eigen::MatrixBase<Derived> &matrix) const
+		{
+			assert(matrix.rows() >= static_cast<typename Eigen::MatrixBase<Derived>::Index>(rows()));
+			assert(matrix.cols() >= static_cast<typename Eigen::MatrixBase<Derived>::Index>(cols()));
+
+			for(size_t i = 0 ; i < rows() ; ++i)
+				for(auto range = row(i) ; range.first != range.second ; ++range.first)
+					matrix(i,range.first->first) = range.first->second;
+		} // end method scatter
+
+		Eigen::Matrix<RationalType,Eigen::Dynamic,Eigen::Dynamic> toDense(size_t nColumns) const
+		{
+			if(nColumns < cols())
+				throw std::out_of_range("The dense matrix must have a column for every coefficient!");
+
+			Eigen::Matrix<RationalType,Eigen::Dynamic,Eigen::Dynamic> result;
+			result.setZero(rows(),nColumns);
+			scatter(result);
+			return result;
+		} // end method toDense
+
+	private:
+		size_t openRowBegin() const
+		{
+			return rowEnds.empty() ? 0 : rowEnds.back();
+		} // end method openRowBegin
+	}; // end class SparseRows
+
 } // end namespace LinearSystem
 
 #endif // LINEAR_SYSTEM_SOLVING_H
@@ -45,10 +45,10 @@ int main(int argc, char **argv)
 
 	// application initialization
 	using AdaptorType = graphene::EventAdaptors::GLUT<GUIModel::Controls::Model<float>>;
-	AdaptorType::initialize();
+	AdaptorType::initialize("LostArt");
 
 	// event handling initialization
-	glutIdleFunc(AdaptorType::idle);
+	// (no idle function: the window is only redisplayed after events that change the model)
 	glutDisplayFunc(AdaptorType::display);
 	glutKeyboardFunc(AdaptorType::keyboard);
 	glutKeyboardUpFunc(AdaptorType::keyboardUp);
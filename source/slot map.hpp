@@ -0,0 +1,601 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <limits>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+#include <cassert>
+
+#include <boost/optional.hpp>
+
+namespace Containers
+{
+	/** A stable reference to an element of a SlotMap. A handle stays valid until its element is
+	 *	erased and is never reused for another element, since erasing an element bumps the
+	 *	generation of its slot.
+	 */
+	template<typename IndexType>
+	struct SlotHandle
+	{
+		// Fields
+		IndexType slot;
+		IndexType generation;
+
+		// Methods
+		bool operator==(const SlotHandle &other) const
+		{
+			return slot == other.slot && generation == other.generation;
+		} // end method operator==
+
+		bool operator!=(const SlotHandle &other) const
+		{
+			return !(*this == other);
+		} // end method operator!=
+
+		bool operator<(const SlotHandle &other) const
+		{
+			return slot < other.slot || (slot == other.slot && generation < other.generation);
+		} // end method operator<
+	}; // end struct SlotHandle
+
+	/** A sequence container whose elements are referred to by generational handles instead of
+	 *	positions. Elements are kept in insertion order by a doubly linked list threaded through
+	 *	a vector of slots, so insertion at the back and erasure anywhere take constant time and
+	 *	invalidate neither the handles nor the iterators of other elements. References may be
+	 *	invalidated by insertion, as with std::vector.
+	 *	Freed slots are recycled, so slot indices stay small and can index side tables.
+	 *	Positions in the sequence are only computed on demand, in linear time after a
+	 *	modification and in constant time otherwise, for (de)serialization to dense indices.
+	 */
+	template<typename ValueType, typename IndexType = std::uint32_t>
+	class SlotMap
+	{
+		/*********************
+		*    Member Types    *
+		*********************/
+	public:
+		using value_type = ValueType;
+		using size_type = size_t;
+		using index_type = IndexType;
+		using key_type = SlotHandle<IndexType>;
+		using reference = ValueType &;
+		using const_reference = const ValueType &;
+
+		static constexpr IndexType none = std::numeric_limits<IndexType>::max();
+
+	private:
+		struct Slot
+		{
+			// Fields
+			boost::optional<ValueType> value;
+			IndexType generation;
+			IndexType latestGeneration; // differs from generation after restore
+			IndexType previous; // previous free slot for empty slots
+			IndexType next; // next free slot for empty slots
+			unsigned long long sequence; // increases with insertion order
+		}; // end struct Slot
+
+		template<bool constant>
+		class Iterator
+		{
+			// Member Types
+		public:
+			using map_type = typename std::conditional<constant,const SlotMap,SlotMap>::type;
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = ValueType;
+			using difference_type = std::ptrdiff_t;
+			using pointer = typename std::conditional<constant,const ValueType*,ValueType*>::type;
+			using reference = typename std::conditional<constant,const ValueType&,ValueType&>::type;
+
+			// Fields
+		private:
+			map_type *iMap;
+			IndexType iSlot;
+
+			// Constructors
+		public:
+			Iterator() = default;
+
+			Iterator(map_type *map, IndexType slot)
+				:iMap(map),iSlot(slot)
+			{
+				// empty body
+			} // end Iterator constructor
+
+			template<bool otherConstant, typename = typename std::enable_if<constant && !otherConstant>::type>
+			Iterator(const Iterator<otherConstant> &other)
+				:iMap(other.map()),iSlot(other.slot())
+			{
+				// empty body
+			} // end Iterator conversion constructor
+
+			// Methods
+			map_type *map() const
+			{
+				return iMap;
+			} // end method map
+
+			IndexType slot() const
+			{
+				return iSlot;
+			} // end method slot
+
+			reference operator*() const
+			{
+				return *iMap->iSlots[iSlot].value;
+			} // end method operator*
+
+			pointer operator->() const
+			{
+				return &**this;
+			} // end method operator->
+
+			Iterator &operator++()
+			{
+				iSlot = iMap->iSlots[iSlot].next;
+				return *this;
+			} // end method operator++
+
+			Iterator operator++(int)
+			{
+				Iterator old = *this;
+				++*this;
+				return old;
+			} // end method operator++
+
+			Iterator &operator--()
+			{
+				iSlot = iSlot == none ? iMap->iTail : iMap->iSlots[iSlot].previous;
+				return *this;
+			} // end method operator--
+
+			Iterator operator--(int)
+			{
+				Iterator old = *this;
+				--*this;
+				return old;
+			} // end method operator--
+
+			template<bool otherConstant>
+			bool operator==(const Iterator<otherConstant> &other) const
+			{
+				return iSlot == other.slot();
+			} // end method operator==
+
+			template<bool otherConstant>
+			bool operator!=(const Iterator<otherConstant> &other) const
+			{
+				return iSlot != other.slot();
+			} // end method operator!=
+		}; // end class Iterator
+
+	public:
+		using iterator = Iterator<false>;
+		using const_iterator = Iterator<true>;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		/***************
+		*    Fields    *
+		***************/
+	private:
+		std::vector<Slot> iSlots;
+		IndexType iHead;
+		IndexType iTail;
+		IndexType iFree;
+		size_t iSize;
+		unsigned long long iNextSequence;
+		mutable std::vector<IndexType> iOrder; // slots in sequence order
+		mutable std::vector<size_t> iPositions; // sequence positions indexed by slot
+		mutable bool iPositionsValid;
+
+		/*********************
+		*    Constructors    *
+		*********************/
+	public:
+		/** Construct an empty SlotMap.
+		 */
+		SlotMap()
+			:iHead(none),iTail(none),iFree(none),iSize(0),iNextSequence(0),iPositionsValid(false)
+		{
+			// empty body
+		} // end SlotMap constructor
+
+		/*************************
+		*    Accessor Methods    *
+		*************************/
+
+		size_t size() const
+		{
+			return iSize;
+		} // end method size
+
+		bool empty() const
+		{
+			return iSize == 0;
+		} // end method empty
+
+		/** Returns one past the largest slot index in use, suitable for sizing tables indexed by slot.
+		 */
+		size_t slotCount() const
+		{
+			return iSlots.size();
+		} // end method slotCount
+
+		iterator begin()
+		{
+			return iterator(this,iHead);
+		} // end method begin
+
+		const_iterator begin() const
+		{
+			return const_iterator(this,iHead);
+		} // end method begin
+
+		iterator end()
+		{
+			return iterator(this,none);
+		} // end method end
+
+		const_iterator end() const
+		{
+			return const_iterator(this,none);
+		} // end method end
+
+		const_iterator cbegin() const
+		{
+			return begin();
+		} // end method cbegin
+
+		const_iterator cend() const
+		{
+			return end();
+		} // end method cend
+
+		reverse_iterator rbegin()
+		{
+			return reverse_iterator(end());
+		} // end method rbegin
+
+		const_reverse_iterator rbegin() const
+		{
+			return const_reverse_iterator(end());
+		} // end method rbegin
+
+		reverse_iterator rend()
+		{
+			return reverse_iterator(begin());
+		} // end method rend
+
+		const_reverse_iterator rend() const
+		{
+			return const_reverse_iterator(begin());
+		} // end method rend
+
+		reference front()
+		{
+			return *begin();
+		} // end method front
+
+		const_reference front() const
+		{
+			return *begin();
+		} // end method front
+
+		reference back()
+		{
+			return *--end();
+		} // end method back
+
+		const_reference back() const
+		{
+			return *--end();
+		} // end method back
+
+		/****************
+		*    Methods    *
+		****************/
+
+		/** Constructs a new element at the end of the sequence and returns its handle.
+		 */
+		template<typename... Arguments>
+		key_type emplace_back(Arguments &&...arguments)
+		{
+			IndexType slot;
+			if(iFree != none)
+			{
+				slot = iFree;
+				unlinkFree(slot);
+			}
+			else
+			{
+				if(iSlots.size() == none)
+					throw std::length_error("SlotMap can't hold more elements!");
+				slot = iSlots.size();
+				iSlots.emplace_back();
+				iSlots.back().generation = iSlots.back().latestGeneration = 0;
+			} // end else
+
+			Slot &newSlot = iSlots[slot];
+			newSlot.value.emplace(std::forward<Arguments>(arguments)...);
+			newSlot.sequence = iNextSequence++;
+			newSlot.previous = iTail;
+			newSlot.next = none;
+			(iTail == none ? iHead : iSlots[iTail].next) = slot;
+			iTail = slot;
+			++iSize;
+			iPositionsValid = false;
+
+			return {slot,newSlot.generation};
+		} // end method emplace_back
+
+		key_type push_back(const ValueType &value)
+		{
+			return emplace_back(value);
+		} // end method push_back
+
+		key_type push_back(ValueType &&value)
+		{
+			return emplace_back(std::move(value));
+		} // end method push_back
+
+		/** Erases the element at position and returns an iterator to the one following it.
+		 */
+		iterator erase(const_iterator position)
+		{
+			IndexType slot = position.slot();
+			Slot &oldSlot = iSlots[slot];
+			IndexType next = oldSlot.next;
+
+			(oldSlot.previous == none ? iHead : iSlots[oldSlot.previous].next) = oldSlot.next;
+			(oldSlot.next == none ? iTail : iSlots[oldSlot.next].previous) = oldSlot.previous;
+			oldSlot.value = boost::none;
+			oldSlot.generation = ++oldSlot.latestGeneration;
+			oldSlot.previous = none;
+			oldSlot.next = iFree;
+			if(iFree != none)
+				iSlots[iFree].previous = slot;
+			iFree = slot;
+			--iSize;
+			iPositionsValid = false;
+
+			return iterator(this,next);
+		} // end method erase
+
+		/** Erases the element referred to by key, if any, and returns the number of elements erased.
+		 */
+		size_t erase(key_type key)
+		{
+			if(!contains(key))
+				return 0;
+			erase(const_iterator(this,key.slot));
+			return 1;
+		} // end method erase
+
+		/** Constructs an element again under a handle of an erased element, before position and
+		 *	with the given sequence number, which should be those the element had when it was
+		 *	erased. Undoing erasures and insertions in reverse order this way restores both the
+		 *	handles and the order of the elements exactly. The handle's slot must be empty and key
+		 *	must have been issued before. Erasing the element again still gives the slot a
+		 *	generation that was never issued.
+		 */
+		template<typename... Arguments>
+		iterator restore(key_type key, unsigned long long sequence, const_iterator position, Arguments &&...arguments)
+		{
+			if(key.slot >= iSlots.size() || iSlots[key.slot].value || iSlots[key.slot].generation <= key.generation)
+				throw std::invalid_argument("Can't restore a SlotMap handle that is in use or was never erased!");
+
+			Slot &newSlot = iSlots[key.slot];
+			newSlot.value.emplace(std::forward<Arguments>(arguments)...);
+			unlinkFree(key.slot);
+			newSlot.generation = key.generation;
+			newSlot.sequence = sequence;
+			newSlot.next = position.slot();
+			newSlot.previous = position.slot() == none ? iTail : iSlots[position.slot()].previous;
+			(newSlot.previous == none ? iHead : iSlots[newSlot.previous].next) = key.slot;
+			(newSlot.next == none ? iTail : iSlots[newSlot.next].previous) = key.slot;
+			++iSize;
+			iPositionsValid = false;
+
+			return iterator(this,key.slot);
+		} // end method restore
+
+		void clear()
+		{
+			while(!empty())
+				erase(cbegin());
+		} // end method clear
+
+		bool contains(key_type key) const
+		{
+			return key.slot < iSlots.size() && iSlots[key.slot].value && iSlots[key.slot].generation == key.generation;
+		} // end method contains
+
+		reference operator[](key_type key)
+		{
+			assert(contains(key));
+			return *iSlots[key.slot].value;
+		} // end method operator[]
+
+		const_reference operator[](key_type key) const
+		{
+			assert(contains(key));
+			return *iSlots[key.slot].value;
+		} // end method operator[]
+
+		reference at(key_type key)
+		{
+			if(!contains(key))
+				throw std::out_of_range("Invalid or stale SlotMap handle!");
+			return *iSlots[key.slot].value;
+		} // end method at
+
+		const_reference at(key_type key) const
+		{
+			if(!contains(key))
+				throw std::out_of_range("Invalid or stale SlotMap handle!");
+			return *iSlots[key.slot].value;
+		} // end method at
+
+		/** Returns an iterator to the element referred to by key or end() if there is none.
+		 */
+		iterator find(key_type key)
+		{
+			return iterator(this,contains(key) ? key.slot : none);
+		} // end method find
+
+		const_iterator find(key_type key) const
+		{
+			return const_iterator(this,contains(key) ? key.slot : none);
+		} // end method find
+
+		/** Returns an iterator to the element stored in slot or end() if the slot is empty.
+		 */
+		iterator fromSlot(IndexType slot)
+		{
+			return iterator(this,slot < iSlots.size() && iSlots[slot].value ? slot : none);
+		} // end method fromSlot
+
+		const_iterator fromSlot(IndexType slot) const
+		{
+			return const_iterator(this,slot < iSlots.size() && iSlots[slot].value ? slot : none);
+		} // end method fromSlot
+
+		/** Returns the handle of the element at the dereferenceable iterator position.
+		 */
+		key_type key(const_iterator position) const
+		{
+			return {position.slot(),iSlots[position.slot()].generation};
+		} // end method key
+
+		/** Returns the sequence number of the element at the dereferenceable iterator position.
+		 *	Sequence numbers increase in the order of the elements.
+		 */
+		unsigned long long sequence(const_iterator position) const
+		{
+			return iSlots[position.slot()].sequence;
+		} // end method sequence
+
+		/** Returns whether the element at a comes before the one at b in the sequence.
+		 *	Both iterators must be dereferenceable.
+		 */
+		bool precedes(const_iterator a, const_iterator b) const
+		{
+			return iSlots[a.slot()].sequence < iSlots[b.slot()].sequence;
+		} // end method precedes
+
+		/** Returns the zero-based position in the sequence of the element referred to by key.
+		 */
+		size_t position(key_type key) const
+		{
+			if(!contains(key))
+				throw std::out_of_range("Invalid or stale SlotMap handle!");
+			updatePositions();
+			return iPositions[key.slot];
+		} // end method position
+
+		/** Returns the handle of the element at the given zero-based position in the sequence.
+		 */
+		key_type keyAt(size_t position) const
+		{
+			if(position >= iSize)
+				throw std::out_of_range("SlotMap position out of range!");
+			updatePositions();
+			return {iOrder[position],iSlots[iOrder[position]].generation};
+		} // end method keyAt
+
+	private:
+		void unlinkFree(IndexType slot)
+		{
+			Slot &freeSlot = iSlots[slot];
+			(freeSlot.previous == none ? iFree : iSlots[freeSlot.previous].next) = freeSlot.next;
+			if(freeSlot.next != none)
+				iSlots[freeSlot.next].previous = freeSlot.previous;
+		} // end method unlinkFree
+
+		void updatePositions() const
+		{
+			if(iPositionsValid)
+				return;
+
+			iOrder.clear();
+			iPositions.assign(iSlots.size(),none);
+			for(IndexType slot = iHead ; slot != none ; slot = iSlots[slot].next)
+			{
+				iPositions[slot] = iOrder.size();
+				iOrder.push_back(slot);
+			} // end for
+			iPositionsValid = true;
+		} // end method updatePositions
+	}; // end class SlotMap
+
+	template<typename ValueType, typename IndexType>
+	constexpr IndexType SlotMap<ValueType,IndexType>::none;
+
+	/** The type ContainerType uses to refer to its elements: positions for std::vector
+	 *	and handles for SlotMap.
+	 */
+	template<typename ContainerType>
+	struct ContainerKey
+	{
+		using type = typename ContainerType::size_type;
+	}; // end struct ContainerKey
+
+	template<typename ValueType, typename IndexType>
+	struct ContainerKey<SlotMap<ValueType,IndexType>>
+	{
+		using type = typename SlotMap<ValueType,IndexType>::key_type;
+	}; // end struct ContainerKey specialization
+
+	// Conversions between keys and dense positions, used for (de)serialization.
+	template<typename ValueType, typename Allocator>
+	size_t position(const std::vector<ValueType,Allocator> &, size_t key)
+	{
+		return key;
+	} // end function position
+
+	template<typename ValueType, typename Allocator>
+	size_t keyAt(const std::vector<ValueType,Allocator> &, size_t position)
+	{
+		return position;
+	} // end function keyAt
+
+	template<typename ValueType, typename IndexType>
+	size_t position(const SlotMap<ValueType,IndexType> &container, SlotHandle<IndexType> key)
+	{
+		return container.position(key);
+	} // end function position
+
+	template<typename ValueType, typename IndexType>
+	SlotHandle<IndexType> keyAt(const SlotMap<ValueType,IndexType> &container, size_t position)
+	{
+		return container.keyAt(position);
+	} // end function keyAt
+
+} // end namespace Containers
+
+#endif // SLOT_MAP_H
@@ -0,0 +1,266 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SPATIAL_INDEX_H
+#define SPATIAL_INDEX_H
+
+#include <cmath>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+#include <functional>
+#include <unordered_map>
+
+#include "geometry.hpp"
+
+namespace geometry
+{
+	/** A uniform grid over the plane that maps each cell to the indices of the items whose
+	 *	bounding rectangles overlap it. Items are identified by small non-negative integers,
+	 *	like slot indices, that are used to index a table of bounding rectangles, so the
+	 *	identifiers in use should be reasonably dense.
+	 *	Point queries return the items overlapping a single cell in increasing index order.
+	 *	Candidates should still be tested exactly, since a cell is coarser than the items in it.
+	 *	Queries take expected constant time for items no larger than a few cells.
+	 */
+	template<typename CoordinateType, typename IndexType = size_t>
+	class UniformGrid
+	{
+		/*********************
+		*    Member Types    *
+		*********************/
+	public:
+		using coordinate_type = CoordinateType;
+		using index_type = IndexType;
+		using rectangle_type = Rectangle<CoordinateType>;
+
+	private:
+		using cell_type = std::pair<long long,long long>;
+
+		struct CellHash
+		{
+			size_t operator()(const cell_type &cell) const
+			{
+				return std::hash<long long>()(cell.first*73856093LL ^ cell.second*19349663LL);
+			} // end method operator()
+		}; // end struct CellHash
+
+		struct CellRange
+		{
+			// Fields
+			long long left, bottom, right, top; // inclusive
+		}; // end struct CellRange
+
+		/***************
+		*    Fields    *
+		***************/
+
+		CoordinateType iCellSize;
+		std::vector<rectangle_type> iBounds; // normalized so that left <= right && bottom <= top
+		std::vector<bool> iIndexed;
+		size_t iSize;
+		std::unordered_map<cell_type,std::vector<IndexType>,CellHash> iCells; // indices kept sorted
+
+	public:
+		/*********************
+		*    Constructors    *
+		*********************/
+
+		/** Construct an empty grid with square cells of the given size.
+		 */
+		explicit UniformGrid(CoordinateType cellSize)
+			:iCellSize(cellSize),iSize(0)
+		{
+			if(!(cellSize > 0))
+				throw std::invalid_argument("Grid cell size must be positive!");
+		} // end UniformGrid constructor
+
+		/*************************
+		*    Accessor Methods    *
+		*************************/
+
+		CoordinateType cellSize() const
+		{
+			return iCellSize;
+		} // end method cellSize
+
+		size_t size() const
+		{
+			return iSize;
+		} // end method size
+
+		bool empty() const
+		{
+			return iSize == 0;
+		} // end method empty
+
+		bool contains(IndexType item) const
+		{
+			return item < iIndexed.size() && iIndexed[item];
+		} // end method contains
+
+		/** Returns the bounding rectangle the item was last indexed with, normalized
+		 *	so that left <= right and bottom <= top.
+		 */
+		const rectangle_type &bounds(IndexType item) const
+		{
+			check(item);
+			return iBounds[item];
+		} // end method bounds
+
+		/****************
+		*    Methods    *
+		****************/
+
+		/** Indexes a new item with the given bounding rectangle.
+		 *	The sides of the rectangle need not be ordered.
+		 */
+		void insert(IndexType item, const rectangle_type &bounds)
+		{
+			if(contains(item))
+				throw std::invalid_argument("Item is already indexed!");
+			if(item >= iBounds.size())
+			{
+				iBounds.resize(item+size_t(1));
+				iIndexed.resize(item+size_t(1),false);
+			} // end if
+
+			iBounds[item] = normalized(bounds);
+			iIndexed[item] = true;
+			++iSize;
+			add(item,range(iBounds[item]));
+		} // end method insert
+
+		/** Changes the bounding rectangle of an item. Only the cells that the item
+		 *	enters or leaves are touched.
+		 */
+		void update(IndexType item, const rectangle_type &bounds)
+		{
+			check(item);
+			auto &oldBounds = iBounds[item];
+			auto newBounds = normalized(bounds);
+			auto oldRange = range(oldBounds);
+			auto newRange = range(newBounds);
+			oldBounds = newBounds;
+
+			if(oldRange.left == newRange.left && oldRange.bottom == newRange.bottom
+				&& oldRange.right == newRange.right && oldRange.top == newRange.top)
+				return;
+
+			for(long long i = oldRange.left ; i <= oldRange.right ; ++i)
+				for(long long j = oldRange.bottom ; j <= oldRange.top ; ++j)
+					if(!inside(i,j,newRange))
+						remove(item,cell_type(i,j));
+			for(long long i = newRange.left ; i <= newRange.right ; ++i)
+				for(long long j = newRange.bottom ; j <= newRange.top ; ++j)
+					if(!inside(i,j,oldRange))
+						add(item,cell_type(i,j));
+		} // end method update
+
+		/** Removes an item. Other items keep their indices.
+		 */
+		void erase(IndexType item)
+		{
+			check(item);
+			auto itemRange = range(iBounds[item]);
+			for(long long i = itemRange.left ; i <= itemRange.right ; ++i)
+				for(long long j = itemRange.bottom ; j <= itemRange.top ; ++j)
+					remove(item,cell_type(i,j));
+			iIndexed[item] = false;
+			--iSize;
+		} // end method erase
+
+		void clear()
+		{
+			iBounds.clear();
+			iIndexed.clear();
+			iSize = 0;
+			iCells.clear();
+		} // end method clear
+
+		/** Returns, in increasing order, the indices of the items whose bounding
+		 *	rectangles overlap the cell containing (x,y). The result is invalidated
+		 *	by any modification of the grid.
+		 */
+		const std::vector<IndexType> &candidates(CoordinateType x, CoordinateType y) const
+		{
+			static const std::vector<IndexType> noItems;
+			auto cell = iCells.find(cell_type(coordinate(x),coordinate(y)));
+			return cell == iCells.end() ? noItems : cell->second;
+		} // end method candidates
+
+	private:
+		void check(IndexType item) const
+		{
+			if(!contains(item))
+				throw std::out_of_range("Item is not indexed!");
+		} // end method check
+
+		static rectangle_type normalized(const rectangle_type &bounds)
+		{
+			return rectangle_type(std::min(bounds.left(),bounds.right()),std::min(bounds.bottom(),bounds.top()),
+								  std::max(bounds.left(),bounds.right()),std::max(bounds.bottom(),bounds.top()));
+		} // end method normalized
+
+		long long coordinate(CoordinateType value) const
+		{
+			return static_cast<long long>(std::floor(static_cast<double>(value)/static_cast<double>(iCellSize)));
+		} // end method coordinate
+
+		CellRange range(const rectangle_type &bounds) const
+		{
+			return {coordinate(bounds.left()),coordinate(bounds.bottom()),coordinate(bounds.right()),coordinate(bounds.top())};
+		} // end method range
+
+		static bool inside(long long i, long long j, const CellRange &range)
+		{
+			return range.left <= i && i <= range.right && range.bottom <= j && j <= range.top;
+		} // end method inside
+
+		void add(IndexType item, const CellRange &itemRange)
+		{
+			for(long long i = itemRange.left ; i <= itemRange.right ; ++i)
+				for(long long j = itemRange.bottom ; j <= itemRange.top ; ++j)
+					add(item,cell_type(i,j));
+		} // end method add
+
+		void add(IndexType item, const cell_type &cell)
+		{
+			auto &items = iCells[cell];
+			items.insert(std::lower_bound(items.begin(),items.end(),item),item);
+		} // end method add
+
+		void remove(IndexType item, const cell_type &cell)
+		{
+			auto found = iCells.find(cell);
+			if(found == iCells.end())
+				return;
+			auto &items = found->second;
+			auto position = std::lower_bound(items.begin(),items.end(),item);
+			if(position != items.end() && *position == item)
+				items.erase(position);
+			if(items.empty())
+				iCells.erase(found);
+		} // end method remove
+	}; // end class UniformGrid
+
+} // end namespace geometry
+
+#endif // SPATIAL_INDEX_H
@@ -20,10 +20,25 @@
 #define SYMBOL_TABLE_H
 
 #include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
 #include <stdexcept>
+#include <functional>
 #include <type_traits>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include <boost/container_hash/hash.hpp>
+#include <boost/utility/string_view.hpp>
 
 namespace Symbolic
 {
@@ -37,6 +52,10 @@ namespace Symbolic
 		 *	IDType should be usable as an index to std::vector and
 		 *	it is assumed sizeof(IDType) <= sizeof(IDType *) in
 		 *	efficiency considerations.
+		 *	Symbols can be undeclared in any order. The IDs of symbols
+		 *	undeclared before the last one are left as holes that are
+		 *	recycled, smallest first, by later declarations, or removed
+		 *	by compact.
 		 */
 		template<typename NameType = std::string, typename IDType = size_t>
 		class SymbolTable
@@ -46,7 +65,8 @@ namespace Symbolic
 
 			// Fields
 			std::map<NameType,IDType> names;
-			std::vector<typename std::map<NameType,IDType>::iterator> IDs;
+			std::vector<typename std::map<NameType,IDType>::iterator> IDs; // names.end() for holes
+			std::set<IDType> freeIDs; // holes in IDs
 
 		public:
 			// Types
@@ -54,6 +74,9 @@ namespace Symbolic
 			using name_type = NameType;
 			using id_type = IDType;
 
+			// Constants
+			static constexpr IDType noID = std::numeric_limits<IDType>::max(); // IDs of removed symbols in compact's result
+
 
 			// Constructors / Destructor
 
@@ -62,7 +85,7 @@ namespace Symbolic
 			SymbolTable() = default;
 
 			SymbolTable(const SymbolTable &other)
-				:names(other.names),IDs(other.IDs.size())
+				:names(other.names),IDs(other.IDs.size(),names.end()),freeIDs(other.freeIDs)
 			{
 				for(auto begin = names.begin() ; begin != names.end() ; ++begin)
 					IDs[begin->second] = begin;
@@ -72,9 +95,9 @@ namespace Symbolic
 			/**	Leaves other in a valid, but unspecified state
 			 */
 			SymbolTable(SymbolTable &&other)
-				:names(std::move(other.names)),IDs(std::move(other.IDs))
+				:names(std::move(other.names)),IDs(std::move(other.IDs)),freeIDs(std::move(other.freeIDs))
 			{
-				// empty body
+				markHoles();
 			} // end SymbolTable move constructor
 
 			/** Construct a symbol table from a sequence of names
@@ -100,7 +123,7 @@ namespace Symbolic
 
 			bool declared(IDType id) const
 			{
-				return id < IDs.size();
+				return id < IDs.size() && IDs[id] != names.end();
 			} // end method declared
 
 			IDType id(const NameType &name) const
@@ -110,16 +133,27 @@ namespace Symbolic
 
 			const NameType &name(IDType id) const
 			{
-				return IDs.at(id)->first;
+				if(!declared(id))
+					throw std::out_of_range("Undeclared symbol ID!");
+				return IDs[id]->first;
 			} // end method name
 
-			/**	Returns the number of currently declared symbols.
+			/**	Returns one more than the largest ID in use, which is the size needed by vectors
+			 *	indexed by ID. This is the number of currently declared symbols, unless there are
+			 *	holes left by undeclared symbols.
 			 */
 			size_type size() const
 			{
 				return IDs.size();
 			} // end method size
 
+			/**	Returns the number of currently declared symbols.
+			 */
+			size_type declaredCount() const
+			{
+				return names.size();
+			} // end method declaredCount
+
 			bool empty() const
 			{
 				return IDs.empty();
@@ -127,14 +161,30 @@ namespace Symbolic
 
 			IDType declare(const NameType &name)
 			{
-				auto result = names.insert(std::make_pair(name,IDs.size()));
+				IDType id = freeIDs.empty() ? static_cast<IDType>(IDs.size()) : *freeIDs.begin();
+				auto result = names.insert(std::make_pair(name,id));
 				if(result.second)
-					IDs.push_back(result.first);
+				{
+					if(freeIDs.empty())
+						IDs.push_back(result.first);
+					else
+					{
+						IDs[id] = result.first;
+						freeIDs.erase(freeIDs.begin());
+					} // end else
+				} // end if
 				return result.first->second;
 			} // end method declare
 
+			/** Declares the name made of the characters in [begin,end).
+			 */
+			template<typename ForwardIterator>
+			IDType declare(ForwardIterator begin, ForwardIterator end)
+			{
+				return declare(NameType(begin,end));
+			} // end method declare
+
 			/** Undeclares a symbol removing it from the symbol table.
-			 *	Symbols can only be undeclared in reverse declaration order!
 			 *	Return the old numerical id corresponding to name.
 			 */
 			IDType undeclare(const NameType &name)
@@ -144,29 +194,1391 @@ namespace Symbolic
 				return id;
 			} // end method undeclare
 
+			/** Undeclares the symbol with the given ID, leaving a hole unless it's the last one.
+			 *	Holes at the end are removed, so size() shrinks to one more than the largest
+			 *	remaining ID.
+			 */
 			void undeclare(IDType id)
 			{
-				if(id+1 != IDs.size())
-					throw std::logic_error("Symbols can only be undeclared in reverse declaration order!");
+				if(!declared(id))
+					throw std::out_of_range("Undeclared symbol ID!");
 				names.erase(IDs[id]);
-				IDs.pop_back();
+				IDs[id] = names.end();
+				freeIDs.insert(id);
+
+				while(!IDs.empty() && IDs.back() == names.end())
+				{
+					freeIDs.erase(static_cast<IDType>(IDs.size()-1));
+					IDs.pop_back();
+				} // end while
 			} // end method undeclare
 
+			/** Removes the holes left by undeclared symbols, renumbering the remaining symbols
+			 *	with IDs 0 to declaredCount()-1 while preserving their order. Returns a table mapping
+			 *	each old ID to the new one, or to noID for holes, e.g. to renumber the columns of
+			 *	matrices indexed by ID or the variables of expressions.
+			 */
+			std::vector<IDType> compact()
+			{
+				std::vector<IDType> newIDs(IDs.size(),noID);
+				size_t nextID = 0;
+				for(size_t id = 0 ; id < IDs.size() ; ++id)
+					if(IDs[id] != names.end())
+					{
+						newIDs[id] = static_cast<IDType>(nextID);
+						IDs[id]->second = static_cast<IDType>(nextID);
+						IDs[nextID++] = IDs[id];
+					} // end if
+				IDs.resize(nextID);
+				freeIDs.clear();
+				return newIDs;
+			} // end method compact
+
 			void clear()
 			{
 				IDs.clear();
 				names.clear();
+				freeIDs.clear();
 			} // end method clear
 
 			SymbolTable &operator=(SymbolTable other)
 			{
 				names = std::move(other.names);
 				IDs = std::move(other.IDs);
+				freeIDs = std::move(other.freeIDs);
+				markHoles();
 				return *this;
 			} // end method operator=
 
+		private:
+			/** Holes are marked with names.end(), which doesn't survive moving names.
+			 */
+			void markHoles()
+			{
+				for(auto id : freeIDs)
+					IDs[id] = names.end();
+			} // end method markHoles
 		}; // end class SymbolTable
 
+		template<typename NameType, typename IDType>
+		constexpr IDType SymbolTable<NameType,IDType>::noID;
+
+		/** Single-scope symbol table that can be shared by threads declaring and looking up
+		 *	symbols concurrently, e.g. while parsing expressions on multiple threads.
+		 *	Names are partitioned among shards by hash, each guarded by its own reader-writer
+		 *	lock, so lookups by name only wait for declarations of new names in the same shard.
+		 *	Lookups by ID don't lock at all: names never move once declared and they are indexed
+		 *	by a segmented array that grows without relocating existing segments. Only declaring
+		 *	a new name takes a global lock, briefly, to assign the next ID, so IDs are dense and
+		 *	stable just like in SymbolTable. Symbols can't be undeclared.
+		 */
+		template<typename NameType = std::string, typename IDType = size_t>
+		class ConcurrentSymbolTable
+		{
+			// Concept Checks
+			static_assert(std::is_unsigned<IDType>::value, "IDType must be an unsigned integral type!");
+
+			// Constants
+			static constexpr size_t nShards = 16;
+			static constexpr unsigned log2FirstSegmentSize = 4; // segment k holds 2^(k+log2FirstSegmentSize) names
+			static constexpr unsigned nSegments = std::numeric_limits<size_t>::digits - log2FirstSegmentSize;
+
+			// Member Types
+			struct Shard
+			{
+				mutable std::shared_timed_mutex mutex;
+				std::unordered_map<NameType,IDType> names;
+			}; // end struct Shard
+
+			// Fields
+			Shard shards[nShards];
+			std::mutex declarationMutex;
+			std::atomic<const NameType **> segments[nSegments];
+			std::atomic<size_t> nSymbols;
+
+		public:
+			// Types
+			using size_type = size_t;
+			using name_type = NameType;
+			using id_type = IDType;
+
+
+			// Constructors / Destructor
+
+			/**	Construct an empty symbol table
+			 */
+			ConcurrentSymbolTable()
+				:nSymbols(0)
+			{
+				for(auto &segment : segments)
+					segment.store(nullptr,std::memory_order_relaxed);
+			} // end ConcurrentSymbolTable default constructor
+
+			/** Construct a symbol table from a sequence of names
+			 */
+			template<typename InputIterator>
+			ConcurrentSymbolTable(InputIterator begin, InputIterator end)
+				:ConcurrentSymbolTable()
+			{
+				while(begin != end)
+				{
+					declare(*begin);
+					++begin;
+				} // end while
+			} // end ConcurrentSymbolTable constructor
+
+			ConcurrentSymbolTable(const ConcurrentSymbolTable &other) = delete;
+			ConcurrentSymbolTable &operator=(const ConcurrentSymbolTable &other) = delete;
+
+			~ConcurrentSymbolTable()
+			{
+				for(auto &segment : segments)
+					delete[] segment.load(std::memory_order_relaxed);
+			} // end ConcurrentSymbolTable destructor
+
+
+			// Methods
+			bool declared(const NameType &name) const
+			{
+				const Shard &shard = shardOf(name);
+				std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+				return shard.names.count(name) != 0;
+			} // end method declared
+
+			bool declared(IDType id) const
+			{
+				return id < size();
+			} // end method declared
+
+			IDType id(const NameType &name) const
+			{
+				const Shard &shard = shardOf(name);
+				std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+				return shard.names.at(name);
+			} // end method id
+
+			const NameType &name(IDType id) const
+			{
+				if(id >= size())
+					throw std::out_of_range("Undeclared symbol ID!");
+				return *slot(id);
+			} // end method name
+
+			/**	Returns the number of currently declared symbols.
+			 */
+			size_type size() const
+			{
+				return nSymbols.load(std::memory_order_acquire);
+			} // end method size
+
+			bool empty() const
+			{
+				return size() == 0;
+			} // end method empty
+
+			IDType declare(const NameType &name)
+			{
+				Shard &shard = shardOf(name);
+				{ // the common case is that the name has already been declared
+					std::shared_lock<std::shared_timed_mutex> lock(shard.mutex);
+					auto position = shard.names.find(name);
+					if(position != shard.names.end())
+						return position->second;
+				} // end block
+
+				std::lock_guard<std::shared_timed_mutex> shardLock(shard.mutex);
+				auto result = shard.names.emplace(name,IDType());
+				if(!result.second) // declared by another thread in the meantime
+					return result.first->second;
+
+				std::lock_guard<std::mutex> declarationLock(declarationMutex);
+				size_t id = nSymbols.load(std::memory_order_relaxed);
+				if(id > std::numeric_limits<IDType>::max())
+				{
+					shard.names.erase(result.first);
+					throw std::length_error("Too many symbols for IDType!");
+				} // end if
+				newSlot(id) = &result.first->first; // keys of unordered_map nodes never move
+				result.first->second = static_cast<IDType>(id);
+				nSymbols.store(id+1,std::memory_order_release); // publish the name to lock-free readers
+				return result.first->second;
+			} // end method declare
+
+			/** Declares the name made of the characters in [begin,end).
+			 */
+			template<typename ForwardIterator>
+			IDType declare(ForwardIterator begin, ForwardIterator end)
+			{
+				return declare(NameType(begin,end));
+			} // end method declare
+
+		private:
+			Shard &shardOf(const NameType &name)
+			{
+				return shards[std::hash<NameType>()(name) % nShards];
+			} // end method shardOf
+
+			const Shard &shardOf(const NameType &name) const
+			{
+				return shards[std::hash<NameType>()(name) % nShards];
+			} // end method shardOf
+
+			static unsigned floorLog2(size_t x)
+			{
+				unsigned result = 0;
+				for(unsigned shift = std::numeric_limits<size_t>::digits/2 ; shift ; shift /= 2)
+					if(x >> shift)
+					{
+						x >>= shift;
+						result += shift;
+					} // end if
+				return result;
+			} // end function floorLog2
+
+			/** Returns the slot of an already published ID.
+			 */
+			const NameType *slot(size_t id) const
+			{
+				size_t index = id + (size_t(1) << log2FirstSegmentSize);
+				unsigned segment = floorLog2(index) - log2FirstSegmentSize;
+				return segments[segment].load(std::memory_order_relaxed)[index - (size_t(1) << (segment + log2FirstSegmentSize))];
+			} // end method slot
+
+			/** Returns the slot of the next ID, allocating its segment if needed.
+			 *	Must be called with declarationMutex locked.
+			 */
+			const NameType *&newSlot(size_t id)
+			{
+				size_t index = id + (size_t(1) << log2FirstSegmentSize);
+				unsigned segment = floorLog2(index) - log2FirstSegmentSize;
+				const NameType **names = segments[segment].load(std::memory_order_relaxed);
+				if(!names)
+				{
+					names = new const NameType *[size_t(1) << (segment + log2FirstSegmentSize)];
+					segments[segment].store(names,std::memory_order_relaxed); // published along with the ID
+				} // end if
+				return names[index - (size_t(1) << (segment + log2FirstSegmentSize))];
+			} // end method newSlot
+		}; // end class ConcurrentSymbolTable
+
+		/** Single-scope symbol table storing all names in one contiguous pool of characters,
+		 *	indexed by an open-addressing hash table with linear probing. Unlike SymbolTable,
+		 *	there are no allocations per symbol, and names can be looked up and declared from
+		 *	string views or pairs of character iterators, e.g. the bounds of a token in the input,
+		 *	without constructing a NameType. name(id) returns a view into the pool, which is
+		 *	invalidated by declaring more symbols. Otherwise it can replace SymbolTable, e.g. as
+		 *	the SymbolTableType of an Expression, except that symbols can only be undeclared in
+		 *	reverse declaration order.
+		 */
+		template<typename NameType = std::string, typename IDType = size_t>
+		class InternedSymbolTable
+		{
+			// Concept Checks
+			static_assert(std::is_unsigned<IDType>::value, "IDType must be an unsigned integral type!");
+
+		public:
+			// Types
+			using size_type = size_t;
+			using name_type = NameType;
+			using id_type = IDType;
+			using char_type = typename NameType::value_type;
+			using view_type = boost::basic_string_view<char_type>;
+
+		private:
+			// Constants
+			static constexpr IDType emptySlot = std::numeric_limits<IDType>::max();
+			static constexpr size_t minIndexSize = 16;
+
+			// Fields
+			std::vector<char_type> pool;
+			std::vector<size_t> offsets; // the name of id starts at pool[offsets[id]]
+			std::vector<size_t> hashes; // of each name, so that the index can grow without rehashing names
+			std::vector<IDType> index; // size is 0 or a power of 2 and at most half the slots are used
+
+		public:
+			// Constructors / Destructor
+
+			/**	Construct an empty symbol table
+			 */
+			InternedSymbolTable() = default;
+
+			/** Construct a symbol table from a sequence of names
+			 */
+			template<typename InputIterator>
+			InternedSymbolTable(InputIterator begin, InputIterator end)
+			{
+				while(begin != end)
+				{
+					declare(*begin);
+					++begin;
+				} // end while
+			} // end InternedSymbolTable constructor
+
+
+			// Methods
+			bool declared(view_type name) const
+			{
+				return !index.empty() && index[findSlot(name.begin(),name.end(),hash(name.begin(),name.end()))] != emptySlot;
+			} // end method declared
+
+			bool declared(IDType id) const
+			{
+				return id < size();
+			} // end method declared
+
+			IDType id(view_type name) const
+			{
+				IDType id = index.empty() ? emptySlot : index[findSlot(name.begin(),name.end(),hash(name.begin(),name.end()))];
+				if(id == emptySlot)
+					throw std::out_of_range("Undeclared symbol name!");
+				return id;
+			} // end method id
+
+			view_type name(IDType id) const
+			{
+				if(id >= size())
+					throw std::out_of_range("Undeclared symbol ID!");
+				size_t end = id+size_t(1) < size() ? offsets[id+1] : pool.size();
+				return view_type(pool.data() + offsets[id],end - offsets[id]);
+			} // end method name
+
+			/**	Returns the number of currently declared symbols.
+			 */
+			size_type size() const
+			{
+				return hashes.size();
+			} // end method size
+
+			bool empty() const
+			{
+				return hashes.empty();
+			} // end method empty
+
+			IDType declare(view_type name)
+			{
+				return declare(name.begin(),name.end());
+			} // end method declare
+
+			/** Declares the name made of the characters in [begin,end).
+			 */
+			template<typename ForwardIterator>
+			IDType declare(ForwardIterator begin, ForwardIterator end)
+			{
+				if(index.size() < 2*(size()+1))
+					grow();
+
+				size_t nameHash = hash(begin,end);
+				size_t slot = findSlot(begin,end,nameHash);
+				if(index[slot] != emptySlot)
+					return index[slot];
+				if(size() >= emptySlot) // the largest value is reserved for empty slots
+					throw std::length_error("Too many symbols for IDType!");
+
+				offsets.push_back(pool.size());
+				pool.insert(pool.end(),begin,end);
+				hashes.push_back(nameHash);
+				return index[slot] = static_cast<IDType>(size()-1);
+			} // end method declare
+
+			/** Undeclares a symbol removing it from the symbol table.
+			 *	Symbols can only be undeclared in reverse declaration order!
+			 *	Return the old numerical id corresponding to name.
+			 */
+			IDType undeclare(view_type name)
+			{
+				auto id = this->id(name);
+				undeclare(id);
+				return id;
+			} // end method undeclare
+
+			void undeclare(IDType id)
+			{
+				if(id+size_t(1) != size())
+					throw std::logic_error("Symbols can only be undeclared in reverse declaration order!");
+
+				// Remove the slot of id, shifting back any later slots of the same probe sequence
+				// that would otherwise become unreachable.
+				view_type name = this->name(id);
+				size_t mask = index.size()-1;
+				size_t hole = findSlot(name.begin(),name.end(),hashes[id]);
+				for(size_t slot = (hole+1) & mask ; index[slot] != emptySlot ; slot = (slot+1) & mask)
+				{
+					size_t home = hashes[index[slot]] & mask;
+					if(((slot - home) & mask) >= ((slot - hole) & mask)) // hole is between home and slot
+					{
+						index[hole] = index[slot];
+						hole = slot;
+					} // end if
+				} // end for
+				index[hole] = emptySlot;
+
+				pool.resize(offsets[id]);
+				offsets.pop_back();
+				hashes.pop_back();
+			} // end method undeclare
+
+			void clear()
+			{
+				pool.clear();
+				offsets.clear();
+				hashes.clear();
+				index.clear();
+			} // end method clear
+
+		private:
+			template<typename ForwardIterator>
+			static size_t hash(ForwardIterator begin, ForwardIterator end)
+			{
+				return boost::hash_range(begin,end);
+			} // end function hash
+
+			/** Returns the slot of the name in [begin,end) if it's declared, or the empty slot
+			 *	where it should be inserted otherwise. The index must not be empty.
+			 */
+			template<typename ForwardIterator>
+			size_t findSlot(ForwardIterator begin, ForwardIterator end, size_t nameHash) const
+			{
+				size_t mask = index.size()-1;
+				for(size_t slot = nameHash & mask ; ; slot = (slot+1) & mask)
+				{
+					IDType id = index[slot];
+					if(id == emptySlot)
+						return slot;
+					if(hashes[id] == nameHash)
+					{
+						view_type name = this->name(id);
+						if(std::equal(name.begin(),name.end(),begin,end))
+							return slot;
+					} // end if
+				} // end for
+			} // end method findSlot
+
+			void grow()
+			{
+				index.assign(std::max(minIndexSize,2*index.size()),emptySlot);
+				size_t mask = index.size()-1;
+				for(size_t id = 0 ; id < size() ; ++id)
+				{
+					size_t slot = hashes[id] & mask;
+					while(index[slot] != emptySlot)
+						slot = (slot+1) & mask;
+					index[slot] = static_cast<IDType>(id);
+				} // end for
+			} // end method grow
+		}; // end class InternedSymbolTable
+
+		template<typename NameType, typename IDType>
+		constexpr IDType InternedSymbolTable<NameType,IDType>::emptySlot;
+		template<typename NameType, typename IDType>
+		constexpr size_t InternedSymbolTable<NameType,IDType>::minIndexSize;
+
+		/** Single-scope symbol table indexing names by a compressed radix tree (a.k.a. Patricia
+		 *	trie), in which each edge is labelled by a whole substring and nodes with a single child
+		 *	and no symbol are merged with it. Finding a name takes time proportional to its length,
+		 *	independently of the number of symbols, and the symbols whose names start with a given
+		 *	prefix can be enumerated in lexicographical order in time proportional to the length of
+		 *	the prefix plus the number of results, e.g. for completing names while typing formulas.
+		 *	Otherwise it can replace SymbolTable, except that symbols can only be undeclared in
+		 *	reverse declaration order.
+		 */
+		template<typename NameType = std::string, typename IDType = size_t>
+		class RadixSymbolTable
+		{
+			// Concept Checks
+			static_assert(std::is_unsigned<IDType>::value, "IDType must be an unsigned integral type!");
+
+		public:
+			// Types
+			using size_type = size_t;
+			using name_type = NameType;
+			using id_type = IDType;
+			using char_type = typename NameType::value_type;
+			using view_type = boost::basic_string_view<char_type>;
+
+		private:
+			// Constants
+			static constexpr IDType noSymbol = std::numeric_limits<IDType>::max();
+			static constexpr size_t root = 0;
+
+			// Member Types
+			struct Node
+			{
+				NameType label; // of the edge from the parent
+				IDType id = noSymbol; // of the symbol whose name ends here, if any
+				size_t parent = root;
+				std::vector<std::pair<char_type,size_t>> children; // sorted by the first character of their labels
+			}; // end struct Node
+
+			// Fields
+			std::vector<Node> nodes = std::vector<Node>(1); // nodes[root] has an empty label
+			std::vector<size_t> freeNodes; // indices of unused elements of nodes
+			std::vector<NameType> names;
+			std::vector<size_t> symbolNodes; // node of each ID
+
+		public:
+			// Constructors / Destructor
+
+			/**	Construct an empty symbol table
+			 */
+			RadixSymbolTable() = default;
+
+			/** Construct a symbol table from a sequence of names
+			 */
+			template<typename InputIterator>
+			RadixSymbolTable(InputIterator begin, InputIterator end)
+			{
+				while(begin != end)
+				{
+					declare(*begin);
+					++begin;
+				} // end while
+			} // end RadixSymbolTable constructor
+
+
+			// Methods
+			bool declared(view_type name) const
+			{
+				size_t node = find(name);
+				return node != nodes.size() && nodes[node].id != noSymbol;
+			} // end method declared
+
+			bool declared(IDType id) const
+			{
+				return id < size();
+			} // end method declared
+
+			IDType id(view_type name) const
+			{
+				size_t node = find(name);
+				if(node == nodes.size() || nodes[node].id == noSymbol)
+					throw std::out_of_range("Undeclared symbol name!");
+				return nodes[node].id;
+			} // end method id
+
+			const NameType &name(IDType id) const
+			{
+				return names.at(id);
+			} // end method name
+
+			/**	Returns the number of currently declared symbols.
+			 */
+			size_type size() const
+			{
+				return names.size();
+			} // end method size
+
+			bool empty() const
+			{
+				return names.empty();
+			} // end method empty
+
+			IDType declare(view_type name)
+			{
+				size_t node = insert(name);
+				if(nodes[node].id == noSymbol)
+				{
+					if(size() >= noSymbol) // the largest value is reserved for nodes without a symbol
+					{
+						erase(node);
+						throw std::length_error("Too many symbols for IDType!");
+					} // end if
+					nodes[node].id = static_cast<IDType>(size());
+					names.emplace_back(name.begin(),name.end());
+					symbolNodes.push_back(node);
+				} // end if
+				return nodes[node].id;
+			} // end method declare
+
+			/** Declares the name made of the characters in [begin,end).
+			 */
+			template<typename ForwardIterator>
+			IDType declare(ForwardIterator begin, ForwardIterator end)
+			{
+				return declare(NameType(begin,end));
+			} // end method declare
+
+			/** Undeclares a symbol removing it from the symbol table.
+			 *	Symbols can only be undeclared in reverse declaration order!
+			 *	Return the old numerical id corresponding to name.
+			 */
+			IDType undeclare(view_type name)
+			{
+				auto id = this->id(name);
+				undeclare(id);
+				return id;
+			} // end method undeclare
+
+			void undeclare(IDType id)
+			{
+				if(id+size_t(1) != size())
+					throw std::logic_error("Symbols can only be undeclared in reverse declaration order!");
+				size_t node = symbolNodes.back();
+				nodes[node].id = noSymbol;
+				erase(node);
+				symbolNodes.pop_back();
+				names.pop_back();
+			} // end method undeclare
+
+			void clear()
+			{
+				nodes.assign(1,Node());
+				freeNodes.clear();
+				names.clear();
+				symbolNodes.clear();
+			} // end method clear
+
+			/** Writes to out the IDs of the symbols whose names start with prefix, in lexicographical
+			 *	order of their names, stopping after maxResults of them. Returns the end of the output.
+			 */
+			template<typename OutputIterator>
+			OutputIterator withPrefix(view_type prefix, OutputIterator out, size_t maxResults = std::numeric_limits<size_t>::max()) const
+			{
+				// find the first node whose path from the root starts with prefix
+				size_t node = root;
+				while(!prefix.empty())
+				{
+					size_t child = childOf(node,prefix.front());
+					if(child == nodes.size())
+						return out;
+					const NameType &label = nodes[child].label;
+					size_t common = commonPrefixLength(label,prefix);
+					if(common < label.size() && common < prefix.size())
+						return out;
+					prefix.remove_prefix(std::min(label.size(),prefix.size()));
+					node = child;
+				} // end while
+
+				// preorder traversal of its subtree visits names in lexicographical order
+				std::vector<size_t> pending(1,node);
+				while(!pending.empty() && maxResults)
+				{
+					const Node &current = nodes[pending.back()];
+					pending.pop_back();
+					if(current.id != noSymbol)
+					{
+						*out++ = current.id;
+						--maxResults;
+					} // end if
+					for(auto child = current.children.rbegin() ; child != current.children.rend() ; ++child)
+						pending.push_back(child->second);
+				} // end while
+				return out;
+			} // end method withPrefix
+
+			/** Returns the IDs written by withPrefix in a vector, e.g. to offer completions of prefix.
+			 */
+			std::vector<IDType> completions(view_type prefix, size_t maxResults = std::numeric_limits<size_t>::max()) const
+			{
+				std::vector<IDType> result;
+				withPrefix(prefix,std::back_inserter(result),maxResults);
+				return result;
+			} // end method completions
+
+		private:
+			template<typename String>
+			static size_t commonPrefixLength(const String &a, view_type b)
+			{
+				return std::mismatch(a.begin(),a.begin()+std::min<size_t>(a.size(),b.size()),b.begin()).first - a.begin();
+			} // end function commonPrefixLength
+
+			/** Returns the child of node whose label starts with first, or nodes.size() if none.
+			 */
+			size_t childOf(size_t node, char_type first) const
+			{
+				const auto &children = nodes[node].children;
+				auto position = std::lower_bound(children.begin(),children.end(),std::make_pair(first,size_t(0)),
+					[](const std::pair<char_type,size_t> &a, const std::pair<char_type,size_t> &b){return a.first < b.first;});
+				return position != children.end() && position->first == first ? position->second : nodes.size();
+			} // end method childOf
+
+			/** Returns the node where name ends or nodes.size() if there's none.
+			 */
+			size_t find(view_type name) const
+			{
+				size_t node = root;
+				while(!name.empty())
+				{
+					node = childOf(node,name.front());
+					if(node == nodes.size())
+						return node;
+					const NameType &label = nodes[node].label;
+					if(name.size() < label.size() || commonPrefixLength(label,name) < label.size())
+						return nodes.size();
+					name.remove_prefix(label.size());
+				} // end while
+				return node;
+			} // end method find
+
+			size_t newNode(NameType label, size_t parent)
+			{
+				size_t node;
+				if(freeNodes.empty())
+				{
+					node = nodes.size();
+					nodes.emplace_back();
+				}
+				else
+				{
+					node = freeNodes.back();
+					freeNodes.pop_back();
+				} // end else
+				nodes[node].label = std::move(label);
+				nodes[node].parent = parent;
+				return node;
+			} // end method newNode
+
+			void addChild(size_t parent, size_t child)
+			{
+				auto &children = nodes[parent].children;
+				auto entry = std::make_pair(nodes[child].label.front(),child);
+				children.insert(std::lower_bound(children.begin(),children.end(),entry),entry);
+			} // end method addChild
+
+			void removeChild(size_t parent, size_t child)
+			{
+				auto &children = nodes[parent].children;
+				children.erase(std::find(children.begin(),children.end(),std::make_pair(nodes[child].label.front(),child)));
+			} // end method removeChild
+
+			/** Returns the node where name ends, creating it, and splitting an edge, if needed.
+			 */
+			size_t insert(view_type name)
+			{
+				size_t node = root;
+				while(!name.empty())
+				{
+					size_t child = childOf(node,name.front());
+					if(child == nodes.size())
+					{
+						child = newNode(NameType(name.begin(),name.end()),node);
+						addChild(node,child);
+						return child;
+					} // end if
+
+					size_t common = commonPrefixLength(nodes[child].label,name);
+					if(common < nodes[child].label.size())
+					{
+						// split the edge to child after the common prefix
+						size_t middle = newNode(nodes[child].label.substr(0,common),node);
+						removeChild(node,child);
+						nodes[child].label.erase(0,common);
+						nodes[child].parent = middle;
+						addChild(middle,child);
+						addChild(node,middle);
+						child = middle;
+					} // end if
+					name.remove_prefix(common);
+					node = child;
+				} // end while
+				return node;
+			} // end method insert
+
+			/** Removes node if it has no symbol and no children, and merges its parent or itself with
+			 *	a single remaining child, to keep the tree compressed.
+			 */
+			void erase(size_t node)
+			{
+				if(node == root || nodes[node].id != noSymbol)
+					return;
+				if(nodes[node].children.empty())
+				{
+					size_t parent = nodes[node].parent;
+					removeChild(parent,node);
+					release(node);
+					node = parent;
+					if(node == root || nodes[node].id != noSymbol)
+						return;
+				} // end if
+				if(nodes[node].children.size() == 1)
+				{
+					// merge node into its only child
+					size_t child = nodes[node].children.front().second;
+					size_t parent = nodes[node].parent;
+					removeChild(parent,node);
+					nodes[child].label.insert(0,nodes[node].label);
+					nodes[child].parent = parent;
+					addChild(parent,child);
+					release(node);
+				} // end if
+			} // end method erase
+
+			void release(size_t node)
+			{
+				nodes[node] = Node();
+				freeNodes.push_back(node);
+			} // end method release
+		}; // end class RadixSymbolTable
+
+		template<typename NameType, typename IDType>
+		constexpr IDType RadixSymbolTable<NameType,IDType>::noSymbol;
+		template<typename NameType, typename IDType>
+		constexpr size_t RadixSymbolTable<NameType,IDType>::root;
+
+		/** Single-scope symbol table that can be copied in constant time, e.g. to take a snapshot
+		 *	for undo, for a background solver or for parsing on another thread, while the original
+		 *	keeps being modified. Copies share their structure: names are indexed by a hash array
+		 *	mapped trie and IDs by a 32-way trie of names, and modifying a table copies just the
+		 *	nodes on the path to the modified leaf that are shared with other tables. Nodes that
+		 *	aren't shared are modified in place, so a table that is never copied allocates about as
+		 *	often as SymbolTable. Lookups visit O(log32 n) nodes. Distinct tables, including copies
+		 *	of each other, can be used by different threads without synchronization.
+		 *	Symbols can only be undeclared in reverse declaration order.
+		 */
+		template<typename NameType = std::string, typename IDType = size_t, typename Hash = std::hash<NameType>>
+		class PersistentSymbolTable
+		{
+			// Concept Checks
+			static_assert(std::is_unsigned<IDType>::value, "IDType must be an unsigned integral type!");
+
+			// Constants
+			static constexpr unsigned bitsPerLevel = 5;
+			static constexpr size_t branching = size_t(1) << bitsPerLevel;
+			static constexpr unsigned nHashLevels = (std::numeric_limits<size_t>::digits + bitsPerLevel - 1) / bitsPerLevel;
+
+			// Member Types
+			/** A node of the trie over the hashes of names. At levels below nHashLevels, bitmap
+			 *	tells which of the branching children exist and entries holds just those, in order.
+			 *	At level nHashLevels all hash bits are used up and entries is a list of symbols
+			 *	whose names have the same hash.
+			 */
+			struct HashNode
+			{
+				struct Entry
+				{
+					std::shared_ptr<HashNode> child; // null for symbols
+					size_t hash;
+					IDType id;
+				}; // end struct Entry
+
+				std::uint32_t bitmap = 0;
+				std::vector<Entry> entries;
+			}; // end struct HashNode
+
+			/** A node of the trie over IDs. Leaves hold names and other nodes hold children.
+			 */
+			struct NameNode
+			{
+				std::vector<std::shared_ptr<NameNode>> children;
+				std::vector<NameType> names;
+			}; // end struct NameNode
+
+			// Fields
+			std::shared_ptr<HashNode> index;
+			std::shared_ptr<NameNode> names;
+			unsigned nameLevels = 1; // the leaves of names are at depth nameLevels-1
+			size_t nSymbols = 0;
+
+		public:
+			// Types
+			using size_type = size_t;
+			using name_type = NameType;
+			using id_type = IDType;
+
+
+			// Constructors / Destructor
+
+			/**	Construct an empty symbol table
+			 */
+			PersistentSymbolTable()
+				:index(std::make_shared<HashNode>()),names(std::make_shared<NameNode>())
+			{
+				// empty body
+			} // end PersistentSymbolTable default constructor
+
+			/** Construct a symbol table from a sequence of names
+			 */
+			template<typename InputIterator>
+			PersistentSymbolTable(InputIterator begin, InputIterator end)
+				:PersistentSymbolTable()
+			{
+				while(begin != end)
+				{
+					declare(*begin);
+					++begin;
+				} // end while
+			} // end PersistentSymbolTable constructor
+
+
+			// Methods
+			/** Returns a copy of the table, in constant time. The same as copy construction.
+			 */
+			PersistentSymbolTable snapshot() const
+			{
+				return *this;
+			} // end method snapshot
+
+			bool declared(const NameType &name) const
+			{
+				return find(name) != nullptr;
+			} // end method declared
+
+			bool declared(IDType id) const
+			{
+				return id < nSymbols;
+			} // end method declared
+
+			IDType id(const NameType &name) const
+			{
+				if(const auto *entry = find(name))
+					return entry->id;
+				throw std::out_of_range("Undeclared symbol name!");
+			} // end method id
+
+			const NameType &name(IDType id) const
+			{
+				if(id >= nSymbols)
+					throw std::out_of_range("Undeclared symbol ID!");
+				const NameNode *node = names.get();
+				for(unsigned level = nameLevels-1 ; level ; --level)
+					node = node->children[(id >> level*bitsPerLevel) % branching].get();
+				return node->names[id % branching];
+			} // end method name
+
+			/**	Returns the number of currently declared symbols.
+			 */
+			size_type size() const
+			{
+				return nSymbols;
+			} // end method size
+
+			bool empty() const
+			{
+				return nSymbols == 0;
+			} // end method empty
+
+			IDType declare(const NameType &name)
+			{
+				size_t hash = Hash()(name);
+				if(const auto *entry = find(name,hash))
+					return entry->id;
+				if(nSymbols > std::numeric_limits<IDType>::max())
+					throw std::length_error("Too many symbols for IDType!");
+
+				IDType id = static_cast<IDType>(nSymbols);
+				pushName(name);
+				insert(writable(index),0,{nullptr,hash,id});
+				return id;
+			} // end method declare
+
+			/** Declares the name made of the characters in [begin,end).
+			 */
+			template<typename ForwardIterator>
+			IDType declare(ForwardIterator begin, ForwardIterator end)
+			{
+				return declare(NameType(begin,end));
+			} // end method declare
+
+			/** Undeclares a symbol removing it from the symbol table.
+			 *	Symbols can only be undeclared in reverse declaration order!
+			 *	Return the old numerical id corresponding to name.
+			 */
+			IDType undeclare(const NameType &name)
+			{
+				auto id = this->id(name);
+				undeclare(id);
+				return id;
+			} // end method undeclare
+
+			void undeclare(IDType id)
+			{
+				if(id+size_t(1) != nSymbols)
+					throw std::logic_error("Symbols can only be undeclared in reverse declaration order!");
+				erase(writable(index),0,Hash()(name(id)),id);
+				popName();
+			} // end method undeclare
+
+			void clear()
+			{
+				*this = PersistentSymbolTable();
+			} // end method clear
+
+		private:
+			/** Makes node safe to modify, by copying it if it's shared with other tables, and
+			 *	returns it. Must be called top-down, so that copying a parent makes its children shared.
+			 */
+			template<typename Node>
+			static Node &writable(std::shared_ptr<Node> &node)
+			{
+				if(node.use_count() > 1)
+					node = std::make_shared<Node>(*node);
+				else // synchronize with other threads that released their references
+					std::atomic_thread_fence(std::memory_order_acquire);
+				return *node;
+			} // end function writable
+
+			static size_t popcount(std::uint32_t bits)
+			{
+				size_t count = 0;
+				for( ; bits ; bits &= bits-1)
+					++count;
+				return count;
+			} // end function popcount
+
+			const typename HashNode::Entry *find(const NameType &name) const
+			{
+				return find(name,Hash()(name));
+			} // end method find
+
+			/** Returns the entry of name, or nullptr if it isn't declared.
+			 */
+			const typename HashNode::Entry *find(const NameType &name, size_t hash) const
+			{
+				const HashNode *node = index.get();
+				for(unsigned level = 0 ; level < nHashLevels ; ++level)
+				{
+					std::uint32_t bit = std::uint32_t(1) << (hash >> level*bitsPerLevel) % branching;
+					if(!(node->bitmap & bit))
+						return nullptr;
+					const auto &entry = node->entries[popcount(node->bitmap & (bit-1))];
+					if(!entry.child)
+						return entry.hash == hash && this->name(entry.id) == name ? &entry : nullptr;
+					node = entry.child.get();
+				} // end for
+				for(const auto &entry : node->entries)
+					if(entry.hash == hash && this->name(entry.id) == name)
+						return &entry;
+				return nullptr;
+			} // end method find
+
+			/** Inserts symbol, which must not be present, into the subtree of node at level.
+			 */
+			static void insert(HashNode &node, unsigned level, typename HashNode::Entry symbol)
+			{
+				if(level == nHashLevels)
+				{
+					node.entries.push_back(std::move(symbol));
+					return;
+				} // end if
+
+				std::uint32_t bit = std::uint32_t(1) << (symbol.hash >> level*bitsPerLevel) % branching;
+				size_t position = popcount(node.bitmap & (bit-1));
+				if(!(node.bitmap & bit))
+				{
+					node.bitmap |= bit;
+					node.entries.insert(node.entries.begin()+position,std::move(symbol));
+					return;
+				} // end if
+
+				auto &entry = node.entries[position];
+				if(!entry.child) // push the symbol already here one level down
+				{
+					auto child = std::make_shared<HashNode>();
+					insert(*child,level+1,std::move(entry));
+					entry = {std::move(child),0,0};
+				} // end if
+				insert(writable(entry.child),level+1,std::move(symbol));
+			} // end function insert
+
+			/** Removes the symbol with the given hash and id from the subtree of node at level.
+			 *	Returns whether node became empty.
+			 */
+			static bool erase(HashNode &node, unsigned level, size_t hash, IDType id)
+			{
+				if(level == nHashLevels)
+				{
+					node.entries.erase(std::find_if(node.entries.begin(),node.entries.end(),
+						[id](const typename HashNode::Entry &entry){return entry.id == id;}));
+					return node.entries.empty();
+				} // end if
+
+				std::uint32_t bit = std::uint32_t(1) << (hash >> level*bitsPerLevel) % branching;
+				size_t position = popcount(node.bitmap & (bit-1));
+				auto &entry = node.entries[position];
+				if(!entry.child || erase(writable(entry.child),level+1,hash,id))
+				{
+					node.bitmap &= ~bit;
+					node.entries.erase(node.entries.begin()+position);
+				} // end if
+				return node.entries.empty();
+			} // end function erase
+
+			void pushName(const NameType &name)
+			{
+				if(nSymbols == size_t(1) << nameLevels*bitsPerLevel) // full: add a level above the root
+				{
+					auto root = std::make_shared<NameNode>();
+					root->children.push_back(std::move(names));
+					names = std::move(root);
+					++nameLevels;
+				} // end if
+
+				NameNode *node = &writable(names);
+				for(unsigned level = nameLevels-1 ; level ; --level)
+				{
+					size_t child = (nSymbols >> level*bitsPerLevel) % branching;
+					if(child == node->children.size())
+						node->children.push_back(std::make_shared<NameNode>());
+					node = &writable(node->children[child]);
+				} // end for
+				node->names.push_back(name);
+				++nSymbols;
+			} // end method pushName
+
+			void popName()
+			{
+				--nSymbols;
+				NameNode *node = &writable(names);
+				for(unsigned level = nameLevels-1 ; level ; --level)
+				{
+					size_t child = (nSymbols >> level*bitsPerLevel) % branching;
+					if(nSymbols % (size_t(1) << level*bitsPerLevel) == 0) // the subtree becomes empty
+					{
+						node->children.pop_back();
+						return;
+					} // end if
+					node = &writable(node->children[child]);
+				} // end for
+				node->names.pop_back();
+			} // end method popName
+		}; // end class PersistentSymbolTable
+
+		template<typename NameType, typename IDType, typename Hash>
+		constexpr unsigned PersistentSymbolTable<NameType,IDType,Hash>::bitsPerLevel;
+		template<typename NameType, typename IDType, typename Hash>
+		constexpr size_t PersistentSymbolTable<NameType,IDType,Hash>::branching;
+		template<typename NameType, typename IDType, typename Hash>
+		constexpr unsigned PersistentSymbolTable<NameType,IDType,Hash>::nHashLevels;
+
+		/** Symbol table with nested scopes, e.g. one per module of a specification. Declarations
+		 *	go to the innermost open scope and shadow those with the same name in enclosing scopes
+		 *	until the scope is popped. Each name maps to the stack of its visible declarations, so
+		 *	resolving a name takes a single hash table lookup, like a flat table, independently of
+		 *	the depth of nesting. Pushing a scope takes constant time and popping it takes time
+		 *	proportional to the number of names declared in it.
+		 *
+		 *	Scopes can be named, and the symbols of named scopes, open or popped, can be found by
+		 *	qualified names: sequences of scope names ending with a symbol name, where the first
+		 *	scope is searched among the open scopes and their children, innermost first.
+		 *
+		 *	IDs are unique across scopes and remain valid after their scope is popped, so that
+		 *	expressions parsed in a scope can still be printed. Symbols can't be undeclared.
+		 */
+		template<typename NameType = std::string, typename IDType = size_t>
+		class ScopedSymbolTable
+		{
+			// Concept Checks
+			static_assert(std::is_unsigned<IDType>::value, "IDType must be an unsigned integral type!");
+
+			// Constants
+			static constexpr size_t globalScope = 0;
+
+			// Member Types
+			struct Symbol
+			{
+				NameType name;
+				size_t scope;
+			}; // end struct Symbol
+
+			struct Scope
+			{
+				NameType name;
+				size_t parent;
+				std::vector<IDType> members;
+			}; // end struct Scope
+
+			using ScopedName = std::pair<size_t,NameType>;
+
+			// Fields
+			std::vector<Symbol> symbols; // indexed by ID
+			std::vector<Scope> scopes = {Scope{NameType(),globalScope,{}}};
+			std::vector<size_t> openScopes = {globalScope}; // innermost last
+			std::unordered_map<NameType,std::vector<IDType>> visible; // innermost declaration last
+			std::unordered_map<ScopedName,IDType,boost::hash<ScopedName>> members;
+			std::unordered_map<ScopedName,size_t,boost::hash<ScopedName>> namedScopes; // children by name
+
+		public:
+			// Types
+			using size_type = size_t;
+			using name_type = NameType;
+			using id_type = IDType;
+
+
+			// Constructors / Destructor
+
+			/**	Construct a symbol table with just the global scope open.
+			 */
+			ScopedSymbolTable() = default;
+
+			/** Construct a symbol table from a sequence of names declared in the global scope
+			 */
+			template<typename InputIterator>
+			ScopedSymbolTable(InputIterator begin, InputIterator end)
+			{
+				while(begin != end)
+				{
+					declare(*begin);
+					++begin;
+				} // end while
+			} // end ScopedSymbolTable constructor
+
+
+			// Methods
+			/** Opens a new scope nested in the innermost one. Named scopes must have names distinct
+			 *	from the other named scopes in the same enclosing scope. Unnamed scopes can't be
+			 *	referred to in qualified names.
+			 */
+			void pushScope(const NameType &scopeName = NameType())
+			{
+				size_t scope = scopes.size();
+				if(!scopeName.empty() && !namedScopes.emplace(ScopedName(openScopes.back(),scopeName),scope).second)
+					throw std::invalid_argument("A scope with the same name already exists in the enclosing scope!");
+				scopes.push_back({scopeName,openScopes.back(),{}});
+				openScopes.push_back(scope);
+			} // end method pushScope
+
+			/** Closes the innermost scope, making the declarations of enclosing scopes that it
+			 *	shadowed visible again.
+			 */
+			void popScope()
+			{
+				if(openScopes.size() == 1)
+					throw std::logic_error("The global scope can't be popped!");
+				for(auto id : scopes[openScopes.back()].members)
+				{
+					auto position = visible.find(symbols[id].name);
+					position->second.pop_back();
+					if(position->second.empty())
+						visible.erase(position);
+				} // end foreach
+				openScopes.pop_back();
+			} // end method popScope
+
+			/** Returns the number of open scopes nested in the global one.
+			 */
+			size_t depth() const
+			{
+				return openScopes.size()-1;
+			} // end method depth
+
+			/** Returns whether name is visible from the innermost scope.
+			 */
+			bool declared(const NameType &name) const
+			{
+				return visible.count(name) != 0;
+			} // end method declared
+
+			bool declared(IDType id) const
+			{
+				return id < symbols.size();
+			} // end method declared
+
+			/** Returns the ID of the innermost declaration of name among the open scopes.
+			 */
+			IDType id(const NameType &name) const
+			{
+				return visible.at(name).back();
+			} // end method id
+
+			/** Returns the ID of the symbol with the given qualified name. e.g. {"dialog","margin"}.
+			 *	A single name is resolved like id(name).
+			 */
+			IDType qualifiedID(const std::vector<NameType> &qualifiedName) const
+			{
+				if(qualifiedName.empty())
+					throw std::invalid_argument("Qualified names can't be empty!");
+				if(qualifiedName.size() == 1)
+					return id(qualifiedName.front());
+
+				for(auto open = openScopes.rbegin() ; open != openScopes.rend() ; ++open)
+				{
+					size_t scope;
+					if(*open != globalScope && scopes[*open].name == qualifiedName.front())
+						scope = *open;
+					else
+					{
+						auto child = namedScopes.find(ScopedName(*open,qualifiedName.front()));
+						if(child == namedScopes.end())
+							continue;
+						scope = child->second;
+					} // end else
+
+					for(size_t part = 1 ; part+1 < qualifiedName.size() ; ++part)
+						scope = namedScopes.at(ScopedName(scope,qualifiedName[part]));
+					return members.at(ScopedName(scope,qualifiedName.back()));
+				} // end for
+				throw std::out_of_range("Undeclared scope!");
+			} // end method qualifiedID
+
+			const NameType &name(IDType id) const
+			{
+				return symbols.at(id).name;
+			} // end method name
+
+			/** Returns the names of the named scopes enclosing the symbol, outermost first, and
+			 *	its name, joined by separator.
+			 */
+			NameType qualifiedName(IDType id, const NameType &separator) const
+			{
+				NameType result = name(id);
+				for(size_t scope = symbols[id].scope ; scope != globalScope ; scope = scopes[scope].parent)
+					if(!scopes[scope].name.empty())
+						result = scopes[scope].name + separator + result;
+				return result;
+			} // end method qualifiedName
+
+			/**	Returns the number of symbols declared in any scope, which is one more than the largest ID.
+			 */
+			size_type size() const
+			{
+				return symbols.size();
+			} // end method size
+
+			bool empty() const
+			{
+				return symbols.empty();
+			} // end method empty
+
+			/** Returns the ID of name if it's visible, like SymbolTable::declare does for names
+			 *	already declared, and declares it in the innermost scope otherwise. This lets formulas
+			 *	parsed in a scope refer to the symbols of enclosing scopes.
+			 */
+			IDType declare(const NameType &name)
+			{
+				auto position = visible.find(name);
+				return position != visible.end() ? position->second.back() : declareLocal(name);
+			} // end method declare
+
+			/** Declares the name made of the characters in [begin,end).
+			 */
+			template<typename ForwardIterator>
+			IDType declare(ForwardIterator begin, ForwardIterator end)
+			{
+				return declare(NameType(begin,end));
+			} // end method declare
+
+			/** Declares name in the innermost scope, shadowing any declarations of enclosing
+			 *	scopes, unless it's already declared there.
+			 */
+			IDType declareLocal(const NameType &name)
+			{
+				size_t scope = openScopes.back();
+				auto result = members.emplace(ScopedName(scope,name),static_cast<IDType>(symbols.size()));
+				if(!result.second)
+					return result.first->second;
+				if(symbols.size() > std::numeric_limits<IDType>::max())
+				{
+					members.erase(result.first);
+					throw std::length_error("Too many symbols for IDType!");
+				} // end if
+
+				IDType id = result.first->second;
+				symbols.push_back({name,scope});
+				scopes[scope].members.push_back(id);
+				visible[name].push_back(id);
+				return id;
+			} // end method declareLocal
+
+			/** Removes every symbol and scope, leaving just the global scope open.
+			 */
+			void clear()
+			{
+				*this = ScopedSymbolTable();
+			} // end method clear
+		}; // end class ScopedSymbolTable
+
+		template<typename NameType, typename IDType>
+		constexpr size_t ScopedSymbolTable<NameType,IDType>::globalScope;
+
 	} // end namespace Common
 
 } // end namespace Symbolic
@@ -25,15 +25,23 @@
 #include <memory>
 #include <sstream>
 #include <utility>
+#include <numeric>
 #include <iterator>
 #include <algorithm>
 #include <stdexcept>
+#include <type_traits>
 #include <functional>
 
 #include <boost/spirit/include/qi.hpp>
 #include <boost/spirit/include/lex_lexertl.hpp>
 #include <boost/spirit/include/phoenix.hpp>
 
+#include <boost/rational.hpp>
+#include <boost/variant.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <boost/numeric/conversion/cast.hpp>
+
 #include "symbol table.hpp"
 
 namespace Symbolic
@@ -177,14 +185,28 @@ namespace Symbolic
 
 		} // end namespace OpTags
 
+		/** Tags selecting the parser used to construct an Expression from a sequence of characters.
+		 */
+		namespace Parsers
+		{
+			struct Spirit{}; // Boost.Spirit lex/qi based parser. Slow, kept for reference and comparisons.
+			struct Pratt{};	 // Hand-written operator precedence parser. Lexes in place without allocating.
+			struct StrictPratt{}; // Like Pratt, but rejects invalid characters instead of skipping them.
+			struct Binary{}; // Reads the binary format written by Expression::serialize, instead of text.
+		} // end namespace Parsers
+
 
 
 		/** A class to represent free-form mathematical expressions.
 		 *  Unsigned integral (natural) numbers are represented internally as UIntType.
+		 *	Natural numbers too large for UIntType are represented as big_uint_type.
 		 *	Signed, rational and fixed point real numbers are represented using negation,
 		 *	division and natural numbers.
+		 *	Variable names are mapped to IDs by a shared SymbolTableType, which can be
+		 *	Common::ConcurrentSymbolTable when expressions are constructed on multiple threads.
 		 */
-		template<typename UIntType = unsigned long long int, typename NameType = std::string, typename IDType = size_t>
+		template<typename UIntType = unsigned long long int, typename NameType = std::string, typename IDType = size_t,
+			typename SymbolTableType = Common::SymbolTable<NameType,IDType>>
 		class Expression
 		{
 			/**********************
@@ -199,9 +221,10 @@ namespace Symbolic
 			*********************/
 		public:
 			using uint_type = UIntType;
+			using big_uint_type = boost::multiprecision::cpp_int; // only used for literals that don't fit in UIntType.
 			using name_type = NameType;
 			using id_type = IDType;
-			using symbol_table_type = Common::SymbolTable<NameType,IDType>;
+			using symbol_table_type = SymbolTableType;
 
 		private:
 			struct Extends
@@ -211,254 +234,458 @@ namespace Symbolic
 				// height == aboveBaseLine + belowBaseLine + 1
 				size_t aboveBaseLine;
 				size_t belowBaseLine;
+				size_t size; // number of nodes in the subtree. Used to skip over subtrees in the extends container.
+				size_t textOffset; // where the serialized literal starts in Layout::literals (literal nodes only)
 
 				Extends() = default;
 
-				Extends(size_t width, size_t aboveBaseLine, size_t belowBaseLine)
-					:width(width),aboveBaseLine(aboveBaseLine),belowBaseLine(belowBaseLine)
+				Extends(size_t width, size_t aboveBaseLine, size_t belowBaseLine, size_t size = 1, size_t textOffset = 0)
+					:width(width),aboveBaseLine(aboveBaseLine),belowBaseLine(belowBaseLine),size(size),textOffset(textOffset)
 				{
 					// empty body
 				} // end Extends constructor
 			}; // end struct Extends
 
 			using extends_container = std::vector<Extends>; // I would like to make that a template parameter...
-			static constexpr  char quotientSymbol = '_'; // should consider using a nicer (Unicode) character...
-				// '_' is too low and '-' creates ambiguities with minus which must be resolved with extra parenthesis...
 
-			struct AbstractNode
+			/** The result of measuring an expression for 2D printing. Literals are serialized
+			 *	once, during measuring, and their text is kept for when they are printed.
+			 */
+			struct Layout
 			{
-			public:
-				virtual void print1D(std::ostream &out, const symbol_table_type &symbols, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const = 0;
-				/** Stores the extends of the rectangle, an expression subtree will occupy when
-				 *	printed in 2D, in the vector extends in right postorder (right subtree before
-				 *	left subtree). Returns the extends of the subtree it's called on.
-				 */
-				virtual Extends getPrint2DExtends(const symbol_table_type &symbols, extends_container &extends, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const = 0;
-				// uses the property rev(preorder(t) == postorder(reflect(t)) to cache the node attributes outside the nodes!
-				// Should probably cache the serialized literal nodes as well...
-				// TODO: change top to bottom and have (0,0) be in the bottom-left corner to somewhat simplify code.
-				virtual void print2D(std::vector<NameType> &out, size_t left, size_t top, const symbol_table_type &symbols, bool fullyParenthesized,
-										typename extends_container::const_reverse_iterator &currentExtends, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const = 0;
-				virtual std::unique_ptr<AbstractNode> deepCopy() const = 0;
-				virtual ~AbstractNode() = default;
-			}; // end struct AbstractNode
-
+				extends_container extends;
+				NameType literals;
+			}; // end struct Layout
 
-			struct LiteralNode : public AbstractNode
+			/** A contiguous character grid. Each row ends with a new line character,
+			 *	so the whole grid can be output with a single write.
+			 */
+			struct Canvas
 			{
 				// Fields
-				UIntType value;
+				NameType cells;
+				size_t stride; // == width + 1
 
-				// Constructors / Destructor
-				explicit LiteralNode(const UIntType &value)
-					:value(value)
+				// Constructors
+				Canvas(size_t width, size_t height)
+					:cells((width+1)*height,' '),stride(width+1)
 				{
-					// empty body
-				} // end LiteralNode constructor
-
-				virtual ~LiteralNode() = default;
+					for(size_t row = 0 ; row < height ; ++row)
+						cells[row*stride + width] = '\n';
+				} // end Canvas constructor
 
 				// Methods
-				virtual void print1D(std::ostream &out, const symbol_table_type &symbols, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				typename NameType::iterator row(size_t row)
 				{
-					if(fullyParenthesized) out << '(';
-					out << value;
-					if(fullyParenthesized) out << ')';
-				} // end method print1D
+					return cells.begin() + row*stride;
+				} // end method row
 
-				virtual Extends getPrint2DExtends(const symbol_table_type &symbols, extends_container &extends, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				typename NameType::value_type &operator()(size_t row, size_t column)
 				{
-					std::ostringstream sstrout;
-					Extends result;
+					return cells[row*stride + column];
+				} // end method operator()
+			}; // end struct Canvas
+			static constexpr  char quotientSymbol = '_'; // should consider using a nicer (Unicode) character...
+				// '_' is too low and '-' creates ambiguities with minus which must be resolved with extra parenthesis...
 
-					sstrout << value;
-					result = Extends(sstrout.str().size()+(fullyParenthesized<<1),0,0);
+			struct Node;
+			/** Subtrees are immutable once constructed, so they can be shared among any
+			 *	number of Expression objects and copying an Expression is O(1).
+			 */
+			using node_pointer = std::shared_ptr<const Node>;
 
-					extends.push_back(result);
-					return result;
-				} // end method getPrint2DExtends
+			/*	Traversals don't recurse, so that expressions of any depth can be handled.
+			 *	Instead, visitors push the work that remains to be done for the children
+			 *	of a node to an explicit stack, as one of the following tasks, and return.
+			 */
+			struct Print1DTask
+			{
+				const Node *node; // nullptr if only symbol should be output
+				char symbol;
+				OpTags::OpTraits parentTraits;
+				OpTags::Child thisChild;
+			}; // end struct Print1DTask
 
-				virtual void print2D(std::vector<NameType> &out, size_t left, size_t top, const symbol_table_type &symbols, bool fullyParenthesized,
-										typename extends_container::const_reverse_iterator &currentExtends, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
-				{
-					std::ostringstream sstrout;
-					sstrout << value;
-					NameType strout = sstrout.str();
+			struct MeasureTask
+			{
+				const Node *node;
+				OpTags::OpTraits parentTraits;
+				OpTags::Child thisChild;
+				bool childrenMeasured;
+			}; // end struct MeasureTask
 
-					std::copy(strout.begin(),strout.end(),out[top].begin() + (left+fullyParenthesized)); // can handle parenthesis
-					if(fullyParenthesized)
-					{
-						out[top+currentExtends->aboveBaseLine][left] = '(';
-						out[top+currentExtends->aboveBaseLine][left + currentExtends->width-1] = ')';
-					} // end if
+			struct Print2DTask
+			{
+				const Node *node;
+				size_t left;
+				size_t top;
+				typename extends_container::const_reverse_iterator extends;
+				OpTags::OpTraits parentTraits;
+				OpTags::Child thisChild;
+			}; // end struct Print2DTask
+
+			struct FoldTask
+			{
+				const Node *node;
+				bool childrenFolded;
+			}; // end struct FoldTask
 
-					++currentExtends;
-				} // end method print2D
+			/*	The set of node types is closed. Operations on nodes are implemented as
+			 *	visitors over node_variant instead of virtual methods, so that new passes
+			 *	don't need to touch the node types and dispatch can be resolved statically.
+			 */
+			struct LiteralNode
+			{
+				// Fields
+				UIntType value;
 
-				virtual std::unique_ptr<AbstractNode> deepCopy() const
+				// Constructors
+				explicit LiteralNode(const UIntType &value)
+					:value(value)
 				{
-					return std::unique_ptr<AbstractNode>(new LiteralNode(value));
-				} // end method deepCopy
+					// empty body
+				} // end LiteralNode constructor
 			}; // end struct LiteralNode
 
+			/** Literal node for natural numbers too large to fit in UIntType. Kept separate
+			 *	from LiteralNode so that the common case doesn't pay for the extra storage.
+			 */
+			struct BigLiteralNode
+			{
+				// Fields
+				big_uint_type value;
+
+				// Constructors
+				explicit BigLiteralNode(big_uint_type value)
+					:value(std::move(value))
+				{
+					// empty body
+				} // end BigLiteralNode constructor
+			}; // end struct BigLiteralNode
 
-			struct VariableNode : public AbstractNode
+			struct VariableNode
 			{
 				// Fields
 				IDType id;
 
-				// Constructors / Destructor
+				// Constructors
 				explicit VariableNode(IDType id)
 					:id(id)
 				{
 					// empty body
 				} // end VariableNode constructor
+			}; // end struct VariableNode
 
-				virtual ~VariableNode() = default;
+			template<template<class> class Operator>
+			struct UnaryNode
+			{
+				// Fields
+				node_pointer child;
 
-				// Methods
-				virtual void print1D(std::ostream &out, const symbol_table_type &symbols, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				// Constructors
+				explicit UnaryNode(node_pointer child)
+					:child(std::move(child))
 				{
-					if(fullyParenthesized) out << '(';
-					out << symbols.name(id);
-					if(fullyParenthesized) out << ')';
-				} // end method print1D
+					// empty body
+				} // end UnaryNode constructor
+			}; // end struct UnaryNode
+
+			template<template<class> class Operator>
+			struct BinaryNode
+			{
+				// Fields
+				node_pointer leftChild;
+				node_pointer rightChild;
 
-				virtual Extends getPrint2DExtends(const symbol_table_type &symbols, extends_container &extends, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				// Constructors
+				BinaryNode(node_pointer leftChild, node_pointer rightChild)
+					:leftChild(std::move(leftChild)),rightChild(std::move(rightChild))
 				{
-					auto result = Extends(symbols.name(id).size() + (fullyParenthesized<<1) , 0 , 0);
+					// empty body
+				} // end BinaryNode constructor
+			}; // end struct BinaryNode
 
-					extends.push_back(result);
-					return result;
-				} // end method getPrint2DExtends
+			using node_variant = boost::variant<LiteralNode,BigLiteralNode,VariableNode,
+				UnaryNode<OpTags::unary_plus>,UnaryNode<OpTags::negate>,
+				BinaryNode<OpTags::plus>,BinaryNode<OpTags::minus>,BinaryNode<OpTags::multiplies>,BinaryNode<OpTags::divides>,BinaryNode<OpTags::bit_xor>>;
+
+			struct Node
+			{
+				// Fields
+				node_variant value;
 
-				virtual void print2D(std::vector<NameType> &out, size_t left, size_t top, const symbol_table_type &symbols, bool fullyParenthesized,
-										typename extends_container::const_reverse_iterator &currentExtends, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				// Constructors / Destructor
+				template<typename Alternative>
+				explicit Node(Alternative alternative)
+					:value(std::move(alternative))
 				{
-					if(fullyParenthesized)
-					{
-						out[top][left] = '(';
-						out[top][left + currentExtends->width-1] = ')';
-					} // end if
+					// empty body
+				} // end Node constructor
 
-					std::copy(symbols.name(id).begin(),symbols.name(id).end(),out[top].begin() + (left+fullyParenthesized));
+				Node(const Node &) = delete;
 
-					++currentExtends;
-				} // end method print2D
+				/** Destroys the subtree without recursion. Children no one else refers to
+				 *	give up their own children before being destroyed, so each destructor
+				 *	called from here only releases a single node.
+				 */
+				~Node()
+				{
+					std::vector<node_pointer> orphans;
+					boost::apply_visitor(ChildDetacher(orphans),value);
+					while(!orphans.empty())
+					{
+						node_pointer node = std::move(orphans.back());
+						orphans.pop_back();
+						// nodes are created non-const by makeNode, so casting away the const of
+						// the pointer is legal. This one is no longer shared and is about to be destroyed.
+						if(node.use_count() == 1)
+							boost::apply_visitor(ChildDetacher(orphans),const_cast<Node &>(*node).value);
+					} // end while
+				} // end Node destructor
 
-				virtual std::unique_ptr<AbstractNode> deepCopy() const
+				// Methods
+				bool isFraction() const
 				{
-					return std::unique_ptr<AbstractNode>(new VariableNode(id));
-				} // end method deepCopy
-			}; // end struct VariableNode
+					return boost::get<BinaryNode<OpTags::divides>>(&value) != nullptr;
+				} // end method isFraction
+			}; // end struct Node
 
+			template<typename Alternative>
+			static node_pointer makeNode(Alternative alternative)
+			{
+				return std::make_shared<Node>(std::move(alternative)); // not const, see ~Node
+			} // end function makeNode
 
-			template<template<class> class Operator>
-			struct UnaryNode : public AbstractNode
+			static OpTags::OpTraits rootTraits()
+			{
+				return OpTags::OpTraits('+',OpTags::noParenPriority,OpTags::Associativity::RIGHT);
+			} // end function rootTraits
+
+
+			/*****************
+			*    Visitors    *
+			*****************/
+
+			/** Moves the children only referred to by the visited node to orphans.
+			 */
+			struct ChildDetacher : public boost::static_visitor<>
 			{
 				// Fields
-				std::unique_ptr<AbstractNode> child;
+				std::vector<node_pointer> &orphans;
 
-				// Constructors / Destructor
-				explicit UnaryNode(std::unique_ptr<AbstractNode> child)
-					:child(std::move(child))
+				// Constructors
+				explicit ChildDetacher(std::vector<node_pointer> &orphans)
+					:orphans(orphans)
 				{
 					// empty body
-				} // end VariableNode constructor
-
-				virtual ~UnaryNode() = default;
+				} // end ChildDetacher constructor
 
 				// Methods
-				virtual void print1D(std::ostream &out, const symbol_table_type &symbols, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				template<typename Leaf>
+				void operator()(Leaf &) const
 				{
-					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(parentTraits,Operator<UIntType>::traits(),thisChild);
+					// leaves have no children
+				} // end method operator()
 
-					if(needsParenthesis) out << '(';
-					out << Operator<UIntType>::traits().symbol;
-					child->print1D(out,symbols,fullyParenthesized,Operator<UIntType>::traits(),OpTags::Child::RIGHT);
-					if(needsParenthesis) out << ')';
-				} // end method print1D
+				template<template<class> class Operator>
+				void operator()(UnaryNode<Operator> &node) const
+				{
+					detach(node.child);
+				} // end method operator()
 
-				virtual Extends getPrint2DExtends(const symbol_table_type &symbols, extends_container &extends, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				template<template<class> class Operator>
+				void operator()(BinaryNode<Operator> &node) const
 				{
-					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(parentTraits,Operator<UIntType>::traits(),thisChild);
-					Extends result = child->getPrint2DExtends(symbols,extends,fullyParenthesized,Operator<UIntType>::traits(),OpTags::Child::RIGHT);
-					result.width += needsParenthesis ? 1 + 2 : 1;
+					detach(node.leftChild);
+					detach(node.rightChild);
+				} // end method operator()
 
-					extends.push_back(result);
-					return result;
-				} // end method getPrint2DExtends
+				void detach(node_pointer &child) const
+				{
+					if(child.use_count() == 1)
+						orphans.push_back(std::move(child));
+				} // end method detach
+			}; // end struct ChildDetacher
 
-				virtual void print2D(std::vector<NameType> &out, size_t left, size_t top, const symbol_table_type &symbols, bool fullyParenthesized,
-										typename extends_container::const_reverse_iterator &currentExtends, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+			/** Outputs each node visited to out and pushes its children to pending,
+			 *	along with any symbols that should follow them, in reverse order.
+			 */
+			struct Print1DVisitor : public boost::static_visitor<>
+			{
+				// Fields
+				std::ostream &out;
+				const symbol_table_type &symbols;
+				bool fullyParenthesized;
+				std::vector<Print1DTask> pending;
+				Print1DTask current;
+
+				// Constructors
+				Print1DVisitor(std::ostream &out, const symbol_table_type &symbols, bool fullyParenthesized, const Node *root)
+					:out(out),symbols(symbols),fullyParenthesized(fullyParenthesized),current{root,'\0',rootTraits(),OpTags::Child::RIGHT}
 				{
-					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(parentTraits,Operator<UIntType>::traits(),thisChild);
-					if(needsParenthesis)
+					pending.push_back(current);
+				} // end Print1DVisitor constructor
+
+				// Methods
+				void run()
+				{
+					while(!pending.empty())
 					{
-						out[top + currentExtends->aboveBaseLine][left] = '(';
-						out[top + currentExtends->aboveBaseLine][left + currentExtends->width-1] = ')';
-					} // end if
-					out[top + currentExtends->aboveBaseLine][left+needsParenthesis] = Operator<UIntType>::traits().symbol;
+						current = pending.back();
+						pending.pop_back();
+						if(current.node)
+							boost::apply_visitor(*this,current.node->value);
+						else
+							out << current.symbol;
+					} // end while
+				} // end method run
+
+				void operator()(const LiteralNode &node)
+				{
+					if(fullyParenthesized) out << '(';
+					out << node.value;
+					if(fullyParenthesized) out << ')';
+				} // end method operator()
 
-					++currentExtends;
+				void operator()(const BigLiteralNode &node)
+				{
+					if(fullyParenthesized) out << '(';
+					out << node.value;
+					if(fullyParenthesized) out << ')';
+				} // end method operator()
 
-					child->print2D(out,left+1+needsParenthesis,top,symbols,fullyParenthesized,currentExtends,Operator<UIntType>::traits(),OpTags::Child::RIGHT);
-				} // end method print2D
+				void operator()(const VariableNode &node)
+				{
+					if(fullyParenthesized) out << '(';
+					out << symbols.name(node.id);
+					if(fullyParenthesized) out << ')';
+				} // end method operator()
 
-				virtual std::unique_ptr<AbstractNode> deepCopy() const
+				template<template<class> class Operator>
+				void operator()(const UnaryNode<Operator> &node)
 				{
-					return std::unique_ptr<AbstractNode>(new UnaryNode(child->deepCopy()));
-				} // end method deepCopy
-			}; // end struct UnaryNode
+					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(current.parentTraits,Operator<UIntType>::traits(),current.thisChild);
 
+					if(needsParenthesis) out << '(';
+					out << Operator<UIntType>::traits().symbol;
+					if(needsParenthesis) pending.push_back({nullptr,')',current.parentTraits,current.thisChild});
+					pending.push_back({node.child.get(),'\0',Operator<UIntType>::traits(),OpTags::Child::RIGHT});
+				} // end method operator()
 
-			template<template<class> class Operator>
-			struct BinaryNode : public AbstractNode
+				template<template<class> class Operator>
+				void operator()(const BinaryNode<Operator> &node)
+				{
+					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(current.parentTraits,Operator<UIntType>::traits(),current.thisChild);
+
+					if(needsParenthesis) out << '(';
+					if(needsParenthesis) pending.push_back({nullptr,')',current.parentTraits,current.thisChild});
+					pending.push_back({node.rightChild.get(),'\0',Operator<UIntType>::traits(),OpTags::Child::RIGHT});
+					pending.push_back({nullptr,Operator<UIntType>::traits().symbol,current.parentTraits,current.thisChild});
+					pending.push_back({node.leftChild.get(),'\0',Operator<UIntType>::traits(),OpTags::Child::LEFT});
+				} // end method operator()
+			}; // end struct Print1DVisitor
+
+			/** Stores the extends of the rectangle, each expression subtree will occupy when
+			 *	printed in 2D, in layout.extends in right postorder (right subtree before left
+			 *	subtree) and appends serialized literals to layout.literals. Nodes with children
+			 *	are visited twice: once to push themselves and their children to pending and
+			 *	once, with childrenMeasured set, to compute their own extends from those of
+			 *	their children.
+			 */
+			struct MeasureVisitor : public boost::static_visitor<>
 			{
 				// Fields
-				std::unique_ptr<AbstractNode> leftChild;
-				std::unique_ptr<AbstractNode> rightChild;
+				const symbol_table_type &symbols;
+				bool fullyParenthesized;
+				Layout layout;
+				std::vector<MeasureTask> pending;
+				MeasureTask current;
 
 				// Constructors
-				BinaryNode(std::unique_ptr<AbstractNode> leftChild, std::unique_ptr<AbstractNode> rightChild)
-					:leftChild(std::move(leftChild)),rightChild(std::move(rightChild))
+				MeasureVisitor(const symbol_table_type &symbols, bool fullyParenthesized, const Node *root)
+					:symbols(symbols),fullyParenthesized(fullyParenthesized),current{root,rootTraits(),OpTags::Child::RIGHT,false}
 				{
-					// empty body
-				} // end BinaryNode constructor
-
-				virtual ~BinaryNode() = default;
+					pending.push_back(current);
+				} // end MeasureVisitor constructor
 
 				// Methods
-				virtual void print1D(std::ostream &out, const symbol_table_type &symbols, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+				void run()
 				{
-					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(parentTraits,Operator<UIntType>::traits(),thisChild);
+					while(!pending.empty())
+					{
+						current = pending.back();
+						pending.pop_back();
+						boost::apply_visitor(*this,current.node->value);
+					} // end while
+				} // end method run
 
-					if(needsParenthesis) out << '(';
-					leftChild->print1D(out,symbols,fullyParenthesized,Operator<UIntType>::traits(),OpTags::Child::LEFT);
-					out << Operator<UIntType>::traits().symbol;
-					rightChild->print1D(out,symbols,fullyParenthesized,Operator<UIntType>::traits(),OpTags::Child::RIGHT);
-					if(needsParenthesis) out << ')';
-				} // end method print1D
+				void operator()(const LiteralNode &node)
+				{
+					size_t textOffset = layout.literals.size();
+					appendDecimal(layout.literals,node.value);
+					layout.extends.push_back(Extends(layout.literals.size()-textOffset+(fullyParenthesized<<1),0,0,1,textOffset));
+				} // end method operator()
+
+				void operator()(const BigLiteralNode &node)
+				{
+					size_t textOffset = layout.literals.size();
+					layout.literals += node.value.str();
+					layout.extends.push_back(Extends(layout.literals.size()-textOffset+(fullyParenthesized<<1),0,0,1,textOffset));
+				} // end method operator()
+
+				void operator()(const VariableNode &node)
+				{
+					layout.extends.push_back(Extends(symbols.name(node.id).size() + (fullyParenthesized<<1) , 0 , 0));
+				} // end method operator()
+
+				template<template<class> class Operator>
+				void operator()(const UnaryNode<Operator> &node)
+				{
+					if(!current.childrenMeasured)
+					{
+						pending.push_back({current.node,current.parentTraits,current.thisChild,true});
+						pending.push_back({node.child.get(),Operator<UIntType>::traits(),OpTags::Child::RIGHT,false});
+						return;
+					} // end if
+
+					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(current.parentTraits,Operator<UIntType>::traits(),current.thisChild);
+					Extends result = layout.extends.back();
+					result.width += needsParenthesis ? 1 + 2 : 1;
+					result.size += 1;
+					result.textOffset = 0;
 
-				virtual Extends getPrint2DExtends(const symbol_table_type &symbols, extends_container &extends, bool fullyParenthesized, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+					layout.extends.push_back(result);
+				} // end method operator()
+
+				template<template<class> class Operator>
+				void operator()(const BinaryNode<Operator> &node)
 				{
-					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(parentTraits,Operator<UIntType>::traits(),thisChild);
+					if(!current.childrenMeasured)
+					{
+						auto traits = Operator<UIntType>::traits();
+						if(traits.symbol == '/' || traits.symbol == '^')
+							traits.priority = OpTags::noParenPriority;	// numerator and denominator don't need parenthesis
+
+						pending.push_back({current.node,current.parentTraits,current.thisChild,true});
+						if(traits.symbol == '^')
+							pending.push_back({node.leftChild.get(),Operator<UIntType>::traits(),OpTags::Child::LEFT,false}); // restore priority for left child.
+						else
+							pending.push_back({node.leftChild.get(),traits,OpTags::Child::LEFT,false});
+						pending.push_back({node.rightChild.get(),traits,OpTags::Child::RIGHT,false}); // must be the right first!
+						return;
+					} // end if
 
-					auto traits = Operator<UIntType>::traits();
-					if(traits.symbol == '/' || traits.symbol == '^')
-						traits.priority = OpTags::noParenPriority;	// numerator and denominator don't need parenthesis
+					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(current.parentTraits,Operator<UIntType>::traits(),current.thisChild);
 
-					Extends rightExtends = rightChild->getPrint2DExtends(symbols,extends,fullyParenthesized,traits,OpTags::Child::RIGHT); // must be the right first!
-					if(traits.symbol == '^')
-						traits.priority = Operator<UIntType>::traits().priority; // restore priority for left child.
-					Extends leftExtends = leftChild->getPrint2DExtends(symbols,extends,fullyParenthesized,traits,OpTags::Child::LEFT);
-					Extends result;
+					Extends leftExtends = layout.extends.back();
+					Extends rightExtends = layout.extends[layout.extends.size()-1-leftExtends.size];
+					Extends result(0,0,0,1 + leftExtends.size + rightExtends.size);
 
 					if(Operator<UIntType>::traits().symbol == '/')
 					{
 						// size of fraction bar disambiguates instead of parenthesis!
-						result.width = std::max(rightExtends.width+((typeid(*rightChild) == typeid(BinaryNode<OpTags::divides>) && !fullyParenthesized)<<1) ,
-												leftExtends.width+((typeid(*leftChild) == typeid(BinaryNode<OpTags::divides>) && !fullyParenthesized)<<1)) + (fullyParenthesized<<1);
+						result.width = std::max(rightExtends.width+((node.rightChild->isFraction() && !fullyParenthesized)<<1) ,
+												leftExtends.width+((node.leftChild->isFraction() && !fullyParenthesized)<<1)) + (fullyParenthesized<<1);
 						result.aboveBaseLine = leftExtends.aboveBaseLine + leftExtends.belowBaseLine + 1;
 						result.belowBaseLine = rightExtends.aboveBaseLine + rightExtends.belowBaseLine + 1;
 					}
@@ -475,102 +702,270 @@ namespace Symbolic
 						result.belowBaseLine = std::max(rightExtends.belowBaseLine,leftExtends.belowBaseLine);
 					} // end else
 
-					extends.push_back(result);
-					return result;
-				} // end method getPrint2DExtends
+					layout.extends.push_back(result);
+				} // end method operator()
+			}; // end struct MeasureVisitor
+
+			/** Draws each node visited on out, at the position given by its task, and pushes
+			 *	its children to pending. Uses the property rev(preorder(t)) == postorder(reflect(t))
+			 *	to find the extends of each node in the ones computed by MeasureVisitor.
+			 */
+			// TODO: change top to bottom and have (0,0) be in the bottom-left corner to somewhat simplify code.
+			struct Print2DVisitor : public boost::static_visitor<>
+			{
+				// Fields
+				Canvas &out;
+				const symbol_table_type &symbols;
+				const NameType &literals;
+				bool fullyParenthesized;
+				std::vector<Print2DTask> pending;
+				Print2DTask current;
+
+				// Constructors
+				Print2DVisitor(Canvas &out, const symbol_table_type &symbols, const Layout &layout, bool fullyParenthesized, const Node *root)
+					:out(out),symbols(symbols),literals(layout.literals),fullyParenthesized(fullyParenthesized),
+					current{root,0,0,layout.extends.crbegin(),rootTraits(),OpTags::Child::RIGHT}
+				{
+					pending.push_back(current);
+				} // end Print2DVisitor constructor
+
+				// Methods
+				void run()
+				{
+					while(!pending.empty())
+					{
+						current = pending.back();
+						pending.pop_back();
+						boost::apply_visitor(*this,current.node->value);
+					} // end while
+				} // end method run
+
+				void operator()(const LiteralNode &)
+				{
+					printLiteral();
+				} // end method operator()
+
+				void operator()(const BigLiteralNode &)
+				{
+					printLiteral();
+				} // end method operator()
+
+				void printLiteral()
+				{
+					auto thisExtends = current.extends;
+					size_t left = current.left, top = current.top;
+
+					std::copy_n(literals.begin() + thisExtends->textOffset,thisExtends->width-(fullyParenthesized<<1),
+								out.row(top) + (left+fullyParenthesized)); // can handle parenthesis
+					if(fullyParenthesized)
+					{
+						out(top,left) = '(';
+						out(top,left + thisExtends->width-1) = ')';
+					} // end if
+				} // end method printLiteral
+
+				void operator()(const VariableNode &node)
+				{
+					auto thisExtends = current.extends;
+					size_t left = current.left, top = current.top;
 
-				virtual void print2D(std::vector<NameType> &out, size_t left, size_t top, const symbol_table_type &symbols, bool fullyParenthesized,
-										typename extends_container::const_reverse_iterator &currentExtends, OpTags::OpTraits parentTraits, OpTags::Child thisChild) const
+					if(fullyParenthesized)
+					{
+						out(top,left) = '(';
+						out(top,left + thisExtends->width-1) = ')';
+					} // end if
+
+					std::copy(symbols.name(node.id).begin(),symbols.name(node.id).end(),out.row(top) + (left+fullyParenthesized));
+				} // end method operator()
+
+				template<template<class> class Operator>
+				void operator()(const UnaryNode<Operator> &node)
+				{
+					auto thisExtends = current.extends;
+					size_t left = current.left, top = current.top;
+					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(current.parentTraits,Operator<UIntType>::traits(),current.thisChild);
+
+					if(needsParenthesis)
+					{
+						out(top + thisExtends->aboveBaseLine,left) = '(';
+						out(top + thisExtends->aboveBaseLine,left + thisExtends->width-1) = ')';
+					} // end if
+					out(top + thisExtends->aboveBaseLine,left+needsParenthesis) = Operator<UIntType>::traits().symbol;
+
+					pending.push_back({node.child.get(),left+1+needsParenthesis,top,thisExtends+1,Operator<UIntType>::traits(),OpTags::Child::RIGHT});
+				} // end method operator()
+
+				template<template<class> class Operator>
+				void operator()(const BinaryNode<Operator> &node)
 				{
-					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(parentTraits,Operator<UIntType>::traits(),thisChild);
+					auto thisExtends = current.extends;
+					size_t left = current.left, top = current.top;
+					bool needsParenthesis = fullyParenthesized || OpTags::needsParenthesis(current.parentTraits,Operator<UIntType>::traits(),current.thisChild);
 
-					auto &thisExtends = *currentExtends;
-					++currentExtends;
+					auto leftExtends = thisExtends + 1;
+					auto rightExtends = leftExtends + leftExtends->size; // skip the left subtree
 
 					if(needsParenthesis)
 					{
-						out[top + thisExtends.aboveBaseLine][left] = '(';
-						out[top + thisExtends.aboveBaseLine][left + thisExtends.width-1] = ')';
+						out(top + thisExtends->aboveBaseLine,left) = '(';
+						out(top + thisExtends->aboveBaseLine,left + thisExtends->width-1) = ')';
 					} // end if
 
 					if(Operator<UIntType>::traits().symbol == '/')
 					{
 						auto traits = Operator<UIntType>::traits();
 						traits.priority = OpTags::noParenPriority;
-						std::fill_n(out[top+thisExtends.aboveBaseLine].begin()+(left+fullyParenthesized),thisExtends.width-(fullyParenthesized<<1),quotientSymbol);
-						leftChild->print2D(out,left + ((thisExtends.width-currentExtends->width+1) >> 1),top,
-											symbols,fullyParenthesized,currentExtends,traits,OpTags::Child::LEFT); // numerator does not need parenthesis...
-						rightChild->print2D(out,left + ((thisExtends.width-currentExtends->width+1) >> 1),top+thisExtends.aboveBaseLine+1,
-											symbols,fullyParenthesized,currentExtends,traits,OpTags::Child::RIGHT); // ...neither denominator (unless fully parenthesized)
+						std::fill_n(out.row(top+thisExtends->aboveBaseLine)+(left+fullyParenthesized),thisExtends->width-(fullyParenthesized<<1),quotientSymbol);
+						pending.push_back({node.leftChild.get(),left + ((thisExtends->width-leftExtends->width+1) >> 1),top,
+											leftExtends,traits,OpTags::Child::LEFT}); // numerator does not need parenthesis...
+						pending.push_back({node.rightChild.get(),left + ((thisExtends->width-rightExtends->width+1) >> 1),top+thisExtends->aboveBaseLine+1,
+											rightExtends,traits,OpTags::Child::RIGHT}); // ...neither denominator (unless fully parenthesized)
 					}
 					else if(Operator<UIntType>::traits().symbol == '^')
 					{
-						leftChild->print2D(out,left+needsParenthesis,top + (thisExtends.aboveBaseLine-currentExtends->aboveBaseLine),
-											symbols,fullyParenthesized,currentExtends,Operator<UIntType>::traits(),OpTags::Child::LEFT);
-						rightChild->print2D(out,left+thisExtends.width-needsParenthesis - currentExtends->width,top,
-											symbols,fullyParenthesized,currentExtends,Operator<UIntType>::traits().setPriority(OpTags::noParenPriority),OpTags::Child::RIGHT);
+						pending.push_back({node.leftChild.get(),left+needsParenthesis,top + (thisExtends->aboveBaseLine-leftExtends->aboveBaseLine),
+											leftExtends,Operator<UIntType>::traits(),OpTags::Child::LEFT});
+						pending.push_back({node.rightChild.get(),left+thisExtends->width-needsParenthesis - rightExtends->width,top,
+											rightExtends,Operator<UIntType>::traits().setPriority(OpTags::noParenPriority),OpTags::Child::RIGHT});
 					}
 					else
 					{
 						if(Operator<UIntType>::traits().symbol == '*')
-							out[top + thisExtends.aboveBaseLine][left+needsParenthesis+currentExtends->width] = Operator<UIntType>::traits().symbol;
+							out(top + thisExtends->aboveBaseLine,left+needsParenthesis+leftExtends->width) = Operator<UIntType>::traits().symbol;
 						else
 						{
-							out[top + thisExtends.aboveBaseLine][left+needsParenthesis+currentExtends->width] = ' ';
-							out[top + thisExtends.aboveBaseLine][left+needsParenthesis+1+currentExtends->width] = Operator<UIntType>::traits().symbol;
-							out[top + thisExtends.aboveBaseLine][left+needsParenthesis+2+currentExtends->width] = ' ';
+							out(top + thisExtends->aboveBaseLine,left+needsParenthesis+leftExtends->width) = ' ';
+							out(top + thisExtends->aboveBaseLine,left+needsParenthesis+1+leftExtends->width) = Operator<UIntType>::traits().symbol;
+							out(top + thisExtends->aboveBaseLine,left+needsParenthesis+2+leftExtends->width) = ' ';
 						} // end else
-						leftChild->print2D(out,left+needsParenthesis,top + (thisExtends.aboveBaseLine-currentExtends->aboveBaseLine),
-											symbols,fullyParenthesized,currentExtends,Operator<UIntType>::traits(),OpTags::Child::LEFT);
-						rightChild->print2D(out,left+thisExtends.width-needsParenthesis - currentExtends->width,
-											top + (thisExtends.aboveBaseLine-currentExtends->aboveBaseLine),
-											symbols,fullyParenthesized,currentExtends,Operator<UIntType>::traits(),OpTags::Child::RIGHT);
+						pending.push_back({node.leftChild.get(),left+needsParenthesis,top + (thisExtends->aboveBaseLine-leftExtends->aboveBaseLine),
+											leftExtends,Operator<UIntType>::traits(),OpTags::Child::LEFT});
+						pending.push_back({node.rightChild.get(),left+thisExtends->width-needsParenthesis - rightExtends->width,
+											top + (thisExtends->aboveBaseLine-rightExtends->aboveBaseLine),
+											rightExtends,Operator<UIntType>::traits(),OpTags::Child::RIGHT});
 					} // end else
-				} // end method print2D
-
-				virtual std::unique_ptr<AbstractNode> deepCopy() const
-				{
-					return std::unique_ptr<AbstractNode>(new BinaryNode(leftChild->deepCopy(),rightChild->deepCopy()));
-				} // end method deepCopy
-			}; // end struct BinaryNode
+				} // end method operator()
+			}; // end struct Print2DVisitor
 
+			/** Folds an expression tree bottom-up with the operations of algebra. Results of
+			 *	children are kept on a stack of their own, left child below right child.
+			 */
+			template<typename Algebra>
+			struct FoldVisitor : public boost::static_visitor<>
+			{
+				// Member Types
+				using value_type = typename std::decay_t<Algebra>::result_type;
 
-			/***************
-			*    Fields    *
-			***************/
+				// Fields
+				Algebra &algebra;
+				std::vector<FoldTask> pending;
+				std::vector<value_type> values;
+				FoldTask current;
 
-			std::shared_ptr<symbol_table_type> symbols; // should never be a null shared pointer, due to getSymbols method
-			std::unique_ptr<AbstractNode> expressionTree;
+				// Constructors
+				FoldVisitor(Algebra &algebra, const Node *root)
+					:algebra(algebra),current{root,false}
+				{
+					pending.push_back(current);
+				} // end FoldVisitor constructor
 
+				// Methods
+				value_type run()
+				{
+					while(!pending.empty())
+					{
+						current = pending.back();
+						pending.pop_back();
+						boost::apply_visitor(*this,current.node->value);
+					} // end while
 
-			/**********************************
-			*    Constructors / Destructor    *
-			**********************************/
-		public:
-			/** Construct an empty Expression
-			 */
-			explicit Expression(std::shared_ptr<symbol_table_type> symbolTable = std::make_shared<symbol_table_type>())
-				:symbols(std::move(symbolTable))
-			{
-				// empty body
-			} // end Expression default constructor
+					return std::move(values.back());
+				} // end method run
 
-			Expression(const Expression &other)
-				:symbols(other.symbols),expressionTree(other.expressionTree->deepCopy())
-			{
-				// empty body
-			} // end Expression copy constructor
+				void operator()(const LiteralNode &node)
+				{
+					values.push_back(algebra.literal(node.value));
+				} // end method operator()
 
-			Expression(Expression &&other)
-				:symbols(std::move(other.symbols)),expressionTree(std::move(other.expressionTree))
+				void operator()(const BigLiteralNode &node)
+				{
+					values.push_back(algebra.literal(node.value));
+				} // end method operator()
+
+				void operator()(const VariableNode &node)
+				{
+					values.push_back(algebra.variable(node.id));
+				} // end method operator()
+
+				template<template<class> class Operator>
+				void operator()(const UnaryNode<Operator> &node)
+				{
+					if(!current.childrenFolded)
+					{
+						pending.push_back({current.node,true});
+						pending.push_back({node.child.get(),false});
+						return;
+					} // end if
+
+					values.back() = algebra.template unary<Operator>(std::move(values.back()));
+				} // end method operator()
+
+				template<template<class> class Operator>
+				void operator()(const BinaryNode<Operator> &node)
+				{
+					if(!current.childrenFolded)
+					{
+						pending.push_back({current.node,true});
+						pending.push_back({node.rightChild.get(),false});
+						pending.push_back({node.leftChild.get(),false});
+						return;
+					} // end if
+
+					value_type right = std::move(values.back());
+					values.pop_back();
+					values.back() = algebra.template binary<Operator>(std::move(values.back()),std::move(right));
+				} // end method operator()
+			}; // end struct FoldVisitor
+
+
+			/***************
+			*    Fields    *
+			***************/
+
+			std::shared_ptr<symbol_table_type> symbols; // should never be a null shared pointer, due to getSymbols method
+			node_pointer expressionTree;
+
+
+			/**********************************
+			*    Constructors / Destructor    *
+			**********************************/
+		public:
+			/** Construct an empty Expression
+			 */
+			explicit Expression(std::shared_ptr<symbol_table_type> symbolTable = std::make_shared<symbol_table_type>())
+				:symbols(std::move(symbolTable))
 			{
 				// empty body
-			} // end Expression move constructor
+			} // end Expression default constructor
+
+			/** Copies share the expression tree with the original, which is never mutated.
+			 */
+			Expression(const Expression &other) = default;
+			Expression(Expression &&other) = default;
 
 			/** Construct an expression containing a single literal value
 			 */
 			Expression(const UIntType &literalValue, std::shared_ptr<symbol_table_type> symbolTable = std::shared_ptr<symbol_table_type>(new symbol_table_type()))
-				:symbols(std::move(symbolTable)),expressionTree(new LiteralNode(literalValue))
+				:symbols(std::move(symbolTable)),expressionTree(makeNode(LiteralNode(literalValue)))
+			{
+				// empty body
+			} // end Expression constructor
+
+			/** Construct an expression containing a single literal value of arbitrary size.
+			 *	Values that fit in UIntType are stored as such.
+			 */
+			Expression(const big_uint_type &literalValue, std::shared_ptr<symbol_table_type> symbolTable = std::shared_ptr<symbol_table_type>(new symbol_table_type()))
+				:symbols(std::move(symbolTable)),expressionTree(makeLiteral(literalValue))
 			{
 				// empty body
 			} // end Expression constructor
@@ -581,33 +976,26 @@ namespace Symbolic
 			Expression(const NameType &variableName, std::shared_ptr<symbol_table_type> symbolTable = std::shared_ptr<symbol_table_type>(new symbol_table_type()))
 				:symbols(std::move(symbolTable))
 			{
-				expressionTree.reset(new VariableNode(symbols->declare(variableName)));
+				expressionTree = makeNode(VariableNode(symbols->declare(variableName)));
 			} // end Expression constructor
 
 			/** Construct an expression object from a sequence of characters.
 			 *	The constructor parses the sequence as if it was a string and
 			 *	creates an expression object representing the string.
-			 *
-			 *	Spirit does not support unique_ptrs so this may leak in case exceptions are thrown...
+			 *	The last argument selects the parser to use. Both text parsers produce identical
+			 *	trees for valid input and skip invalid characters, mentioning them in the message
+			 *	of any later parse error. Parsers::StrictPratt throws on them instead.
+			 *	Parsers::Binary reads the output of serialize, declaring the names stored with it
+			 *	in symbolTable. Corrupt data throws std::runtime_error, but the names are declared
+			 *	as soon as all of them are read, so errors in the expression following them leave
+			 *	them in symbolTable.
 			 */
-			template<typename ForwardIterator>
-			Expression(ForwardIterator begin, ForwardIterator end, std::shared_ptr<symbol_table_type> symbolTable = std::shared_ptr<symbol_table_type>(new symbol_table_type()))
+			template<typename ForwardIterator, typename ParserTag = Parsers::Pratt>
+			Expression(ForwardIterator begin, ForwardIterator end, std::shared_ptr<symbol_table_type> symbolTable = std::shared_ptr<symbol_table_type>(new symbol_table_type()),
+					ParserTag parser = ParserTag())
 				:symbols(std::move(symbolTable))
 			{
-				using token_type = lex::lexertl::token<ForwardIterator,boost::mpl::vector<NameType>,boost::mpl::false_>;
-				using lexer_type = lex::lexertl::actor_lexer<token_type>;
-				using iterator_type = typename lexer_type::iterator_type;
-
-				std::stringstream sout;
-				Grammar<lexer_type> scanner(sout);
-				Syntax<iterator_type> parser(scanner,sout);
-				AbstractNode *parseTree = nullptr;
-
-				bool success = lex::tokenize_and_parse(begin,end,scanner,parser(symbols.get()),parseTree);
-				expressionTree.reset(parseTree);
-
-				if(!success || begin != end)
-					throw std::runtime_error(sout.str().empty() ? "Parse error reading mathematical expression!" : sout.str());
+				parse(begin,end,parser);
 			} // end Expression constructor
 
 			~Expression() = default;
@@ -616,7 +1004,6 @@ namespace Symbolic
 			/****************
 			*    Methods    *
 			****************/
-
 			const symbol_table_type &getSymbols() const
 			{
 				return *symbols;
@@ -632,27 +1019,78 @@ namespace Symbolic
 
 			void print1D(std::ostream &out, bool fullyParenthesized = false) const
 			{
-				if(expressionTree) expressionTree->print1D(out,*symbols,fullyParenthesized,OpTags::OpTraits('+',OpTags::noParenPriority,OpTags::Associativity::RIGHT),OpTags::Child::RIGHT);
+				if(expressionTree) Print1DVisitor(out,*symbols,fullyParenthesized,expressionTree.get()).run();
 			} // end method print1D
 
 			void print2D(std::ostream &out, bool fullyParenthesized = false) const
 			{
-				if(expressionTree)
-				{
-					extends_container extends;
-					Extends rootExtends = expressionTree->getPrint2DExtends(*symbols,extends,fullyParenthesized,OpTags::OpTraits('+',OpTags::noParenPriority,OpTags::Associativity::RIGHT),OpTags::Child::RIGHT);
+				if(!expressionTree) return;
 
-					std::vector<NameType> temporaryStorage(rootExtends.aboveBaseLine+rootExtends.belowBaseLine+1);
-					for(NameType &row : temporaryStorage)
-						row.resize(rootExtends.width,' ');
+				MeasureVisitor measurer(*symbols,fullyParenthesized,expressionTree.get());
+				measurer.run();
 
-					auto iterator = extends.crbegin();
-					expressionTree->print2D(temporaryStorage,0,0,*symbols,fullyParenthesized,iterator,OpTags::OpTraits('+',OpTags::noParenPriority,OpTags::Associativity::RIGHT),OpTags::Child::RIGHT);
+				const Extends &rootExtends = measurer.layout.extends.back();
+				Canvas canvas(rootExtends.width,rootExtends.aboveBaseLine+rootExtends.belowBaseLine+1);
+				Print2DVisitor(canvas,*symbols,measurer.layout,fullyParenthesized,expressionTree.get()).run();
 
-					std::copy(temporaryStorage.begin(),temporaryStorage.end(),std::ostream_iterator<NameType>(out,"\n"));
-				} // end if
+				out.write(canvas.cells.data(),canvas.cells.size());
 			} // end method print2D
 
+			/** Folds the expression bottom-up, without recursion, by calling on algebra:
+			 *		literal(const uint_type &) and literal(const big_uint_type &) for literals,
+			 *		variable(id_type) for variables,
+			 *		unary<Operator>(result_type) for unary and
+			 *		binary<Operator>(result_type, result_type) for binary operators,
+			 *	where Operator is one of the OpTags operators and result_type a member type
+			 *	of Algebra. Returns the result for the root.
+			 */
+			template<typename Algebra>
+			typename std::decay_t<Algebra>::result_type fold(Algebra &&algebra) const
+			{
+				if(!expressionTree)
+					throw std::logic_error("Empty Expression objects cannot be folded!");
+				return FoldVisitor<std::remove_reference_t<Algebra>>(algebra,expressionTree.get()).run();
+			} // end method fold
+
+			/** Returns an equivalent expression, computed in a single bottom-up pass, where
+			 *	rational constants are folded exactly, identity elements and the operands of
+			 *	products with a zero factor are dropped and chains of additions/subtractions
+			 *	and multiplications/divisions are flattened, so that all their constants are
+			 *	combined. Divisions by zero and large powers of constants are left as is, and
+			 *	so are the products and powers that would otherwise drop them.
+			 */
+			Expression simplified() const
+			{
+				Expression result(symbols);
+				if(expressionTree)
+					result.expressionTree = Simplifier::build(fold(Simplifier()));
+				return result;
+			} // end method simplified
+
+			/** Writes the expression, along with the names of the symbols it references, in a compact binary
+			 *	format. Use Parsers::Binary to construct an Expression from the result.
+			 */
+			void serialize(std::ostream &out) const
+			{
+				Serializer serializer(symbols->size());
+				if(expressionTree)
+					fold(serializer);
+
+				std::string header(serializationMagic);
+				header.push_back(static_cast<char>(serializationVersion));
+				appendVarint(header,serializer.referencedSymbols.size());
+				for(auto id : serializer.referencedSymbols)
+				{
+					const auto &name = symbols->name(id);
+					appendVarint(header,name.size());
+					header.append(name.begin(),name.end());
+				} // end foreach
+				appendVarint(header,serializer.nNodes);
+
+				out.write(header.data(),header.size());
+				out.write(serializer.buffer.data(),serializer.buffer.size());
+			} // end method serialize
+
 			/** Construct an expression object form a smaller one and a unary operator
 			 */
 			template<template<class> class Operator>
@@ -660,7 +1098,7 @@ namespace Symbolic
 			{
 				if(subExpression.empty())
 					throw std::logic_error("Empty Expression objects cannot be used to construct larger Expression objects!");
-				subExpression.expressionTree.reset(new UnaryNode<Operator>(std::move(subExpression.expressionTree)));
+				subExpression.expressionTree = makeNode(UnaryNode<Operator>(std::move(subExpression.expressionTree)));
 				return subExpression;
 			} // end static method unaryCombine
 
@@ -675,7 +1113,7 @@ namespace Symbolic
 					leftSubExpression.symbols = std::move(rightSubExpression.symbols);
 				else if(leftSubExpression.symbols != rightSubExpression.symbols && !rightSubExpression.symbols->empty())
 					throw std::logic_error("Combining sub-expressions with different symbol tables (or namespaces) is not supported!");
-				leftSubExpression.expressionTree.reset(new BinaryNode<Operator>(std::move(leftSubExpression.expressionTree),std::move(rightSubExpression.expressionTree)));
+				leftSubExpression.expressionTree = makeNode(BinaryNode<Operator>(std::move(leftSubExpression.expressionTree),std::move(rightSubExpression.expressionTree)));
 				return leftSubExpression;
 			} // end static method binaryCombine
 
@@ -696,6 +1134,40 @@ namespace Symbolic
 			*    Parser Support    *
 			***********************/
 		private:
+			template<typename ForwardIterator>
+			void parse(ForwardIterator begin, ForwardIterator end, Parsers::Pratt)
+			{
+				expressionTree = PrattParser<ForwardIterator>(begin,end,*symbols).parse();
+			} // end method parse
+
+			template<typename ForwardIterator>
+			void parse(ForwardIterator begin, ForwardIterator end, Parsers::StrictPratt)
+			{
+				expressionTree = PrattParser<ForwardIterator>(begin,end,*symbols,true).parse();
+			} // end method parse
+
+			template<typename InputIterator>
+			void parse(InputIterator begin, InputIterator end, Parsers::Binary)
+			{
+				expressionTree = Deserializer<InputIterator>(begin,end,*symbols).parse();
+			} // end method parse
+
+			template<typename ForwardIterator>
+			void parse(ForwardIterator begin, ForwardIterator end, Parsers::Spirit)
+			{
+				using token_type = lex::lexertl::token<ForwardIterator,boost::mpl::vector<NameType>,boost::mpl::false_>;
+				using lexer_type = lex::lexertl::actor_lexer<token_type>;
+				using iterator_type = typename lexer_type::iterator_type;
+
+				std::stringstream sout;
+				Grammar<lexer_type> scanner(sout);
+				Syntax<iterator_type> parser(scanner,sout);
+				bool success = lex::tokenize_and_parse(begin,end,scanner,parser(symbols.get()),expressionTree);
+
+				if(!success || begin != end)
+					throw std::runtime_error(sout.str().empty() ? "Parse error reading mathematical expression!" : sout.str());
+			} // end method parse
+
 			template<typename Lexer>
 			struct Grammar : public lex::lexer<Lexer>
 			{
@@ -725,13 +1197,13 @@ namespace Symbolic
 				} // end Grammar constructor
 			}; // end struct Grammar
 
-			using attribute_signature = AbstractNode *(symbol_table_type *);
+			using attribute_signature = node_pointer(symbol_table_type *);
 
 			template<typename ForwardIterator>
 			struct Syntax : public qi::grammar<ForwardIterator,attribute_signature>
 			{
 				// Operator parsers
-				struct AdditiveOperator : public qi::symbols<char,AbstractNode *(*)(AbstractNode *,AbstractNode *)>
+				struct AdditiveOperator : public qi::symbols<char,node_pointer(*)(node_pointer,node_pointer)>
 				{
 					AdditiveOperator()
 					{
@@ -740,7 +1212,7 @@ namespace Symbolic
 					} // end AdditiveOperator constructor
 				} additiveOperator; // end struct AdditiveOperator
 
-				struct MultiplicativeOperator : public qi::symbols<char,AbstractNode *(*)(AbstractNode *,AbstractNode *)>
+				struct MultiplicativeOperator : public qi::symbols<char,node_pointer(*)(node_pointer,node_pointer)>
 				{
 					MultiplicativeOperator()
 					{
@@ -749,7 +1221,7 @@ namespace Symbolic
 					} // end MultiplicativeOperator constructor
 				} multiplicativeOperator; // end struct MultiplicativeOperator
 
-				struct ExponentiationOperator : public qi::symbols<char,AbstractNode *(*)(AbstractNode *,AbstractNode *)>
+				struct ExponentiationOperator : public qi::symbols<char,node_pointer(*)(node_pointer,node_pointer)>
 				{
 					ExponentiationOperator()
 					{
@@ -757,7 +1229,7 @@ namespace Symbolic
 					} // end ExponentiationOperator constructor
 				} exponentiationOperator; // end struct ExponentiationOperator
 
-				struct PrefixOperator : public qi::symbols<char,AbstractNode *(*)(AbstractNode *)>
+				struct PrefixOperator : public qi::symbols<char,node_pointer(*)(node_pointer)>
 				{
 					PrefixOperator()
 					{
@@ -820,59 +1292,888 @@ namespace Symbolic
 			private:
 				// Boost::Spirit and Boost::Phoenix workarounds:
 				template<template<class> class Operator>
-				static AbstractNode *unaryCombine(AbstractNode *subExpression)
+				static node_pointer unaryCombine(node_pointer subExpression)
 				{
-					return new UnaryNode<Operator>(std::unique_ptr<AbstractNode>(subExpression));
+					return makeNode(UnaryNode<Operator>(std::move(subExpression)));
 				} // end function unaryCombine
 
 				template<template<class> class Operator>
-				static AbstractNode *binaryCombine(AbstractNode *leftSubExpression, AbstractNode *rightSubExpression)
+				static node_pointer binaryCombine(node_pointer leftSubExpression, node_pointer rightSubExpression)
 				{
-					return new BinaryNode<Operator>(std::unique_ptr<AbstractNode>(leftSubExpression),std::unique_ptr<AbstractNode>(rightSubExpression));
+					return makeNode(BinaryNode<Operator>(std::move(leftSubExpression),std::move(rightSubExpression)));
 				} // end function binaryCombine
 
-				static AbstractNode *createVariable(const NameType &name, symbol_table_type *symbolTable)
+				static node_pointer createVariable(const NameType &name, symbol_table_type *symbolTable)
 				{
-					return new VariableNode(symbolTable->declare(name));
+					return makeNode(VariableNode(symbolTable->declare(name)));
 				} // end function createVariable
 
-				/**	s must be a string of digits [0-9] containing zero or one '.'.
+				static node_pointer stringToRational(const NameType &s)
+				{
+					return decimalToRational(s.begin(),s.end());
+				} // end function stringToRational
+
+			}; // end struct Syntax
+
+			/**	[begin,end) must be a sequence of digits [0-9] containing zero or one '.'.
+			 *	Literals with more digits than UIntType can always hold are accumulated
+			 *	in big_uint_type, so they never wrap around.
+			 */
+			template<typename ForwardIterator>
+			static node_pointer decimalToRational(ForwardIterator begin, ForwardIterator end)
+			{
+				if(std::count_if(begin,end,[](char c){return c != '.';}) <= std::numeric_limits<UIntType>::digits10)
+					return decimalToRationalUsing<UIntType>(begin,end);
+				else
+					return decimalToRationalUsing<big_uint_type>(begin,end);
+			} // end function decimalToRational
+
+			template<typename IntType, typename ForwardIterator>
+			static node_pointer decimalToRationalUsing(ForwardIterator begin, ForwardIterator end)
+			{
+				IntType numerator = 0, denominator = 1;
+
+				while(begin != end && *begin != '.')
+				{
+					numerator *= 10;
+					numerator += *begin - '0';
+					++begin;
+				} // end while
+				if(begin != end)
+					++begin;
+				while(begin != end)
+				{
+					numerator *= 10;
+					numerator += *begin - '0';
+					denominator *= 10;
+					++begin;
+				} // end while
+
+				if(denominator != 1)
+					return makeNode(BinaryNode<OpTags::divides>(makeLiteral(numerator),makeLiteral(denominator)));
+				else
+					return makeLiteral(numerator);
+			} // end function decimalToRationalUsing
+
+			static node_pointer makeLiteral(const UIntType &value)
+			{
+				return makeNode(LiteralNode(value));
+			} // end function makeLiteral
+
+			static node_pointer makeLiteral(const big_uint_type &value)
+			{
+				if(value <= std::numeric_limits<UIntType>::max())
+					return makeNode(LiteralNode(value.template convert_to<UIntType>()));
+				else
+					return makeNode(BigLiteralNode(value));
+			} // end function makeLiteral
+
+			/** Appends the decimal representation of value to out, without going through
+			 *	a stream. Used to serialize literals once, while measuring for 2D printing.
+			 */
+			static void appendDecimal(NameType &out, UIntType value)
+			{
+				typename NameType::value_type digits[std::numeric_limits<UIntType>::digits10+1];
+				auto first = std::end(digits);
+				do
+				{
+					*--first = '0' + value%10;
+					value /= 10;
+				}while(value);
+				out.append(first,std::end(digits));
+			} // end function appendDecimal
+
+			/** A hand-written operator precedence (Pratt) parser accepting the same language
+			 *	as Syntax. Tokens are represented as pairs of iterators into the input, so
+			 *	lexing never allocates and nodes are owned by smart pointers at all times.
+			 *	Invalid characters are skipped like the Spirit parser does, unless strict is set,
+			 *	but unlike it trailing input is always an error.
+			 */
+			template<typename ForwardIterator>
+			class PrattParser
+			{
+				// Member Types
+				enum class TokenKind {END, IDENTIFIER, RATIONAL_LITERAL, LEFT_PARENTHESIS, RIGHT_PARENTHESIS,
+										PLUS, MINUS, TIMES, DIVIDE, CARET, INVALID};
+
+				struct Token
+				{
+					TokenKind kind;
+					ForwardIterator begin;
+					ForwardIterator end;
+				}; // end struct Token
+
+				// Fields
+				ForwardIterator inputBegin;
+				ForwardIterator inputEnd;
+				ForwardIterator next; // first character after the lookahead token
+				Token lookahead;
+				symbol_table_type &symbols;
+				bool strict;
+				std::string diagnostics; // one line per skipped invalid character
+
+			public:
+				// Constructors
+				/** A PrattParser object should not outlive the symbol table
+				 *	given as argument to its constructor.
+				 */
+				PrattParser(ForwardIterator begin, ForwardIterator end, symbol_table_type &symbols, bool strict = false)
+					:inputBegin(begin),inputEnd(end),next(begin),symbols(symbols),strict(strict)
+				{
+					advance();
+				} // end PrattParser constructor
+
+				// Methods
+				/** Returns a null pointer for input consisting only of white space.
 				 */
-				static AbstractNode *stringToRational(const NameType &s)
+				node_pointer parse()
+				{
+					if(lookahead.kind == TokenKind::END)
+						return nullptr;
+					auto result = parseExpression(OpTags::noParenPriority,"expression");
+					if(lookahead.kind != TokenKind::END)
+						error("binary operator");
+					return result;
+				} // end method parse
+
+			private:
+				static bool isDigit(char c)
+				{
+					return '0' <= c && c <= '9';
+				} // end function isDigit
+
+				static bool isIdentifierStart(char c)
+				{
+					return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_';
+				} // end function isIdentifierStart
+
+				static bool isWhiteSpace(char c)
+				{
+					return c == ' ' || c == '\t' || c == '\v' || c == '\f' || c == '\n' || c == '\r';
+				} // end function isWhiteSpace
+
+				void advance()
+				{
+					for(lex(); lookahead.kind == TokenKind::INVALID && !strict; lex())
+						diagnostics.append("Ignoring invalid character '").append(1,*lookahead.begin).append("' in input!\n");
+				} // end method advance
+
+				void lex()
 				{
-					UIntType numerator = 0, denominator = 1;
-					auto inBegin = s.begin();
-					auto inEnd = s.end();
+					while(next != inputEnd && isWhiteSpace(*next))
+						++next;
 
-					while(inBegin != inEnd && *inBegin != '.')
+					lookahead.begin = next;
+					if(next == inputEnd)
+						lookahead.kind = TokenKind::END;
+					else if(isIdentifierStart(*next))
 					{
-						numerator *= 10;
-						numerator += *inBegin - '0';
-						++inBegin;
-					} // end while
-					if(inBegin != inEnd)
-						++inBegin;
-					while(inBegin != inEnd)
-					{
-						numerator *= 10;
-						numerator += *inBegin - '0';
-						denominator *= 10;
-						++inBegin;
+						lookahead.kind = TokenKind::IDENTIFIER;
+						do ++next; while(next != inputEnd && (isIdentifierStart(*next) || isDigit(*next)));
+					}
+					else if(isDigit(*next))
+					{
+						lookahead.kind = TokenKind::RATIONAL_LITERAL;
+						do ++next; while(next != inputEnd && isDigit(*next));
+						if(next != inputEnd && *next == '.')
+						{
+							auto fraction = std::next(next);
+							if(fraction != inputEnd && isDigit(*fraction)) // "[0-9]+(\\.[0-9]+)?"
+							{
+								next = fraction;
+								do ++next; while(next != inputEnd && isDigit(*next));
+							} // end if
+						} // end if
+					}
+					else
+					{
+						switch(*next)
+						{
+						case '(': lookahead.kind = TokenKind::LEFT_PARENTHESIS; break;
+						case ')': lookahead.kind = TokenKind::RIGHT_PARENTHESIS; break;
+						case '+': lookahead.kind = TokenKind::PLUS; break;
+						case '-': lookahead.kind = TokenKind::MINUS; break;
+						case '*': lookahead.kind = TokenKind::TIMES; break;
+						case '/': lookahead.kind = TokenKind::DIVIDE; break;
+						case '^': lookahead.kind = TokenKind::CARET; break;
+						default: lookahead.kind = TokenKind::INVALID; break;
+						} // end switch
+						++next;
+					} // end else
+					lookahead.end = next;
+				} // end method lex
+
+				[[noreturn]] void error(const char *expected) const
+				{
+					std::ostringstream sout;
+					sout << diagnostics << "Parse error: \"" << std::string(inputBegin,inputEnd) << "\"!\n"
+						 << "Here:         " << std::string(std::distance(inputBegin,lookahead.begin),'-') << "^\n";
+					if(lookahead.kind == TokenKind::INVALID)
+						sout << "Invalid character '" << *lookahead.begin << "' in input!\n";
+					else
+						sout << "Expected a " << expected << ".\n";
+					throw std::runtime_error(sout.str());
+				} // end method error
+
+				/** Returns whether the lookahead token is a binary operator
+				 *	and if so stores its traits in traits.
+				 */
+				bool binaryOperator(OpTags::OpTraits &traits) const
+				{
+					switch(lookahead.kind)
+					{
+					case TokenKind::PLUS: traits = OpTags::plus<UIntType>::traits(); return true;
+					case TokenKind::MINUS: traits = OpTags::minus<UIntType>::traits(); return true;
+					case TokenKind::TIMES: traits = OpTags::multiplies<UIntType>::traits(); return true;
+					case TokenKind::DIVIDE: traits = OpTags::divides<UIntType>::traits(); return true;
+					case TokenKind::CARET: traits = OpTags::bit_xor<UIntType>::traits(); return true;
+					default: return false;
+					} // end switch
+				} // end method binaryOperator
+
+				template<template<class> class Operator>
+				static node_pointer combine(node_pointer left, node_pointer right)
+				{
+					return makeNode(BinaryNode<Operator>(std::move(left),std::move(right)));
+				} // end function combine
+
+				/** Parses an expression containing only binary operators of priority
+				 *	minPriority or higher, unless enclosed in parentheses.
+				 *	expected names the non-terminal for error messages.
+				 */
+				node_pointer parseExpression(OpTags::priority_type minPriority, const char *expected)
+				{
+					auto left = parsePrefix(minPriority,expected);
+					OpTags::OpTraits traits('+',OpTags::noParenPriority,OpTags::Associativity::LEFT);
+
+					while(binaryOperator(traits) && traits.priority >= minPriority)
+					{
+						TokenKind kind = lookahead.kind;
+						advance();
+
+						auto right = parseExpression(traits.associativity == OpTags::Associativity::LEFT ? traits.priority+1 : traits.priority,
+							traits.priority == OpTags::additivePriority ? "term" : traits.priority == OpTags::multiplicativePriority ? "factor" : "prefix-expression");
+
+						switch(kind)
+						{
+						case TokenKind::PLUS: left = combine<OpTags::plus>(std::move(left),std::move(right)); break;
+						case TokenKind::MINUS: left = combine<OpTags::minus>(std::move(left),std::move(right)); break;
+						case TokenKind::TIMES: left = combine<OpTags::multiplies>(std::move(left),std::move(right)); break;
+						case TokenKind::DIVIDE: left = combine<OpTags::divides>(std::move(left),std::move(right)); break;
+						default: left = combine<OpTags::bit_xor>(std::move(left),std::move(right)); break;
+						} // end switch
 					} // end while
 
-					if(denominator != 1)
-						return binaryCombine<OpTags::divides>(new LiteralNode(numerator),new LiteralNode(denominator));
+					return left;
+				} // end method parseExpression
+
+				/** Parses a primary expression or, if minPriority allows it,
+				 *	a prefix operator applied to a factor.
+				 */
+				node_pointer parsePrefix(OpTags::priority_type minPriority, const char *expected)
+				{
+					node_pointer result;
+
+					switch(lookahead.kind)
+					{
+					case TokenKind::IDENTIFIER:
+						result = makeNode(VariableNode(symbols.declare(lookahead.begin,lookahead.end)));
+						advance();
+						return result;
+					case TokenKind::RATIONAL_LITERAL:
+						result = decimalToRational(lookahead.begin,lookahead.end);
+						advance();
+						return result;
+					case TokenKind::LEFT_PARENTHESIS:
+						advance();
+						result = parseExpression(OpTags::noParenPriority,"expression");
+						if(lookahead.kind != TokenKind::RIGHT_PARENTHESIS)
+							error("')'");
+						advance();
+						return result;
+					case TokenKind::PLUS:
+					case TokenKind::MINUS:
+						if(minPriority <= OpTags::unaryPriority)
+						{
+							TokenKind kind = lookahead.kind;
+							advance();
+							result = parseExpression(OpTags::unaryPriority,"factor");
+							if(kind == TokenKind::PLUS)
+								return makeNode(UnaryNode<OpTags::unary_plus>(std::move(result)));
+							else
+								return makeNode(UnaryNode<OpTags::negate>(std::move(result)));
+						} // end if
+						// fall through
+					default:
+						error(expected);
+					} // end switch
+				} // end method parsePrefix
+			}; // end class PrattParser
+
+
+			/*******************************
+			*    Simplification Support    *
+			*******************************/
+		private:
+			using rational_type = boost::multiprecision::cpp_rational;
+
+			/** A simplified subtree. Sums and products are kept flattened while they can
+			 *	still be merged into an enclosing chain, with their constants combined.
+			 */
+			struct Simplified
+			{
+				// Member Types
+				enum class Kind {CONSTANT, SUM, PRODUCT, OTHER};
+
+				// Fields
+				Kind kind;
+				rational_type constant; // the value (CONSTANT), constant term (SUM) or coefficient (PRODUCT).
+				std::vector<std::pair<bool,node_pointer>> operands; // terms (SUM) or factors (PRODUCT). true if subtracted/divided.
+				node_pointer node; // OTHER only
+				bool undefined = false; // contains a division by zero or a power of zero that might be one.
+			}; // end struct Simplified
+
+			/** The algebra folded over an expression by simplified().
+			 */
+			struct Simplifier
+			{
+				// Member Types
+				using result_type = Simplified;
+				using Kind = typename Simplified::Kind;
+
+				// Folding Methods
+				Simplified literal(const UIntType &value) const
+				{
+					return constant(rational_type(value));
+				} // end method literal
+
+				Simplified literal(const big_uint_type &value) const
+				{
+					return constant(rational_type(value));
+				} // end method literal
+
+				Simplified variable(IDType id) const
+				{
+					return other(makeNode(VariableNode(id)));
+				} // end method variable
+
+				template<template<class> class Operator>
+				Simplified unary(Simplified child) const
+				{
+					return apply(Operator<UIntType>(),std::move(child));
+				} // end method unary
+
+				template<template<class> class Operator>
+				Simplified binary(Simplified left, Simplified right) const
+				{
+					return apply(Operator<UIntType>(),std::move(left),std::move(right));
+				} // end method binary
+
+				// Rules
+				static Simplified apply(OpTags::unary_plus<UIntType>, Simplified child)
+				{
+					return child;
+				} // end function apply
+
+				static Simplified apply(OpTags::negate<UIntType>, Simplified child)
+				{
+					if(child.kind != Kind::SUM)
+						child = toProduct(std::move(child));
+					child.constant = -child.constant;
+					if(child.kind == Kind::SUM)
+						for(auto &term : child.operands)
+							term.first = !term.first;
+					return normalize(std::move(child));
+				} // end function apply
+
+				static Simplified apply(OpTags::plus<UIntType>, Simplified left, Simplified right)
+				{
+					return merge(toSum(std::move(left)),toSum(std::move(right)),false);
+				} // end function apply
+
+				static Simplified apply(OpTags::minus<UIntType>, Simplified left, Simplified right)
+				{
+					return merge(toSum(std::move(left)),toSum(std::move(right)),true);
+				} // end function apply
+
+				static Simplified apply(OpTags::multiplies<UIntType>, Simplified left, Simplified right)
+				{
+					return merge(toProduct(std::move(left)),toProduct(std::move(right)),false);
+				} // end function apply
+
+				static Simplified apply(OpTags::divides<UIntType>, Simplified left, Simplified right)
+				{
+					if((right.kind == Kind::CONSTANT || right.kind == Kind::PRODUCT) && right.constant == 0) // leave division by zero for the user to see
+						return other(makeNode(BinaryNode<OpTags::divides>(build(std::move(left)),build(std::move(right)))),true);
+					return merge(toProduct(std::move(left)),toProduct(std::move(right)),true);
+				} // end function apply
+
+				static Simplified apply(OpTags::bit_xor<UIntType>, Simplified left, Simplified right)
+				{
+					if(right.kind == Kind::CONSTANT)
+					{
+						if(right.constant == 1)
+							return left;
+						if(right.constant == 0 && !left.undefined)
+							return constant(1);
+						if(left.kind == Kind::CONSTANT && denominator(right.constant) == 1 && abs(right.constant) <= maxFoldedExponent
+							&& (left.constant != 0 || right.constant > 0))
+						{
+							unsigned exponent = abs(numerator(right.constant)).template convert_to<unsigned>();
+							rational_type result(pow(numerator(left.constant),exponent),pow(denominator(left.constant),exponent));
+							return constant(right.constant > 0 ? result : rational_type(1/result));
+						} // end if
+					} // end if
+					if(left.kind == Kind::CONSTANT && left.constant == 1 && !right.undefined)
+						return constant(1);
+
+					bool undefined = left.undefined || right.undefined || (left.kind == Kind::CONSTANT && left.constant == 0);
+					return other(makeNode(BinaryNode<OpTags::bit_xor>(build(std::move(left)),build(std::move(right)))),undefined);
+				} // end function apply
+
+				// Helpers
+				static constexpr unsigned maxFoldedExponent = 64; // avoids blowing up the size of constants
+
+				static Simplified constant(rational_type value)
+				{
+					return Simplified{Kind::CONSTANT,std::move(value),{},nullptr};
+				} // end function constant
+
+				static Simplified other(node_pointer node, bool undefined = false)
+				{
+					return Simplified{Kind::OTHER,0,{},std::move(node),undefined};
+				} // end function other
+
+				static Simplified toSum(Simplified operand)
+				{
+					bool undefined = operand.undefined;
+
+					switch(operand.kind)
+					{
+					case Kind::SUM:
+						return operand;
+					case Kind::CONSTANT:
+						return Simplified{Kind::SUM,std::move(operand.constant),{},nullptr};
+					case Kind::PRODUCT:
+						if(operand.constant < 0) // a negative coefficient becomes a subtraction
+						{
+							operand.constant = -operand.constant;
+							return Simplified{Kind::SUM,0,{{true,build(std::move(operand))}},nullptr,undefined};
+						} // end if
+						// fall through
+					default:
+						return Simplified{Kind::SUM,0,{{false,build(std::move(operand))}},nullptr,undefined};
+					} // end switch
+				} // end function toSum
+
+				static Simplified toProduct(Simplified operand)
+				{
+					bool undefined = operand.undefined;
+
+					switch(operand.kind)
+					{
+					case Kind::PRODUCT:
+						return operand;
+					case Kind::CONSTANT:
+						return Simplified{Kind::PRODUCT,std::move(operand.constant),{},nullptr};
+					default:
+						return Simplified{Kind::PRODUCT,1,{{false,build(std::move(operand))}},nullptr,undefined};
+					} // end switch
+				} // end function toProduct
+
+				/** Appends the operands of right to those of left, which must be of the same kind,
+				 *	subtracting (SUM) or dividing (PRODUCT) by them if invertRight is set.
+				 */
+				static Simplified merge(Simplified left, Simplified right, bool invertRight)
+				{
+					if(left.kind == Kind::SUM)
+						if(invertRight)
+							left.constant -= right.constant;
+						else
+							left.constant += right.constant;
 					else
-						return new LiteralNode(numerator);
-				} // end function sequenceToRational
+						if(invertRight)
+							left.constant /= right.constant;
+						else
+							left.constant *= right.constant;
 
-			}; // end struct Syntax
+					left.undefined = left.undefined || right.undefined;
+					left.operands.reserve(left.operands.size() + right.operands.size());
+					for(auto &operand : right.operands)
+						left.operands.emplace_back(operand.first != invertRight,std::move(operand.second));
+
+					return normalize(std::move(left));
+				} // end function merge
+
+				static Simplified normalize(Simplified operand)
+				{
+					if((operand.kind == Kind::SUM && operand.operands.empty())
+						|| (operand.kind == Kind::PRODUCT && (operand.operands.empty() || (operand.constant == 0 && !operand.undefined)))) // 0 annihilates finite products
+						return constant(std::move(operand.constant));
+					return operand;
+				} // end function normalize
+
+				static node_pointer constantNode(const rational_type &value)
+				{
+					node_pointer result = makeLiteral(big_uint_type(abs(numerator(value))));
+					if(denominator(value) != 1)
+						result = makeNode(BinaryNode<OpTags::divides>(std::move(result),makeLiteral(big_uint_type(denominator(value)))));
+					if(value < 0)
+						result = makeNode(UnaryNode<OpTags::negate>(std::move(result)));
+					return result;
+				} // end function constantNode
+
+				/** Converts a simplified subtree back to a tree. Sums are built as left-leaning
+				 *	chains with the constant term last and products with the coefficient's
+				 *	numerator first and its denominator last.
+				 */
+				static node_pointer build(Simplified operand)
+				{
+					node_pointer result;
+
+					switch(operand.kind)
+					{
+					case Kind::CONSTANT:
+						return constantNode(operand.constant);
+					case Kind::OTHER:
+						return std::move(operand.node);
+					case Kind::SUM:
+						for(auto &term : operand.operands)
+							if(!result)
+								result = term.first ? makeNode(UnaryNode<OpTags::negate>(std::move(term.second))) : std::move(term.second);
+							else if(term.first)
+								result = makeNode(BinaryNode<OpTags::minus>(std::move(result),std::move(term.second)));
+							else
+								result = makeNode(BinaryNode<OpTags::plus>(std::move(result),std::move(term.second)));
+
+						if(operand.constant > 0)
+							result = makeNode(BinaryNode<OpTags::plus>(std::move(result),constantNode(operand.constant)));
+						else if(operand.constant < 0)
+							result = makeNode(BinaryNode<OpTags::minus>(std::move(result),constantNode(-operand.constant)));
+						return result;
+					default: // PRODUCT
+					{
+						rational_type magnitude = abs(operand.constant);
+
+						if(numerator(magnitude) != 1)
+							result = makeLiteral(big_uint_type(numerator(magnitude)));
+						for(auto &factor : operand.operands)
+							if(!factor.first)
+								result = result ? makeNode(BinaryNode<OpTags::multiplies>(std::move(result),std::move(factor.second))) : std::move(factor.second);
+						if(!result)
+							result = makeLiteral(UIntType(1));
+						for(auto &factor : operand.operands)
+							if(factor.first)
+								result = makeNode(BinaryNode<OpTags::divides>(std::move(result),std::move(factor.second)));
+						if(denominator(magnitude) != 1)
+							result = makeNode(BinaryNode<OpTags::divides>(std::move(result),makeLiteral(big_uint_type(denominator(magnitude)))));
+
+						if(operand.constant < 0)
+							result = makeNode(UnaryNode<OpTags::negate>(std::move(result)));
+						return result;
+					} // end case
+					} // end switch
+				} // end function build
+			}; // end struct Simplifier
+
+
+			/******************************
+			*    Serialization Support    *
+			******************************/
+		private:
+			/*	Format of serialized expressions:
+			 *		magic bytes "LAEX", a version byte,
+			 *		the number of symbols referenced followed by their names in order of first reference,
+			 *			each as a length and bytes,
+			 *		the number of nodes in the tree,
+			 *		the nodes of the tree in postorder, each as an opcode byte followed by its operand, if any,
+			 *			with variables referring to symbols by their position in the list above.
+			 *	Numbers are written as base-128 varints, least significant group first. Big literals
+			 *	are written as the number of bytes of their magnitude followed by those bytes.
+			 */
+			static constexpr char serializationMagic[] = "LAEX";
+			static constexpr unsigned char serializationVersion = 1;
+
+			enum class Opcode : unsigned char {LITERAL, BIG_LITERAL, VARIABLE, UNARY_PLUS, NEGATE, PLUS, MINUS, MULTIPLIES, DIVIDES, POWER, END_OF_OPCODES};
+
+			template<typename Integer>
+			static void appendVarint(std::string &buffer, Integer value)
+			{
+				while(value >= 0x80)
+				{
+					buffer.push_back(static_cast<char>((value & 0x7f) | 0x80));
+					value >>= 7;
+				} // end while
+				buffer.push_back(static_cast<char>(value));
+			} // end function appendVarint
+
+			/** The algebra folded over an expression by serialize(). Since fold visits
+			 *	nodes in postorder, each node can be appended as soon as it's visited.
+			 */
+			struct Serializer
+			{
+				// Member Types
+				struct result_type{};
+
+				// Fields
+				std::string buffer;
+				size_t nNodes = 0;
+				std::vector<IDType> referencedSymbols;
+				std::vector<size_t> positions; // of each symbol in referencedSymbols, if referenced
+
+				// Constructors
+				explicit Serializer(size_t nSymbols)
+					:positions(nSymbols,std::numeric_limits<size_t>::max())
+				{
+					// empty body
+				} // end Serializer constructor
+
+				// Folding Methods
+				result_type literal(const UIntType &value)
+				{
+					++nNodes;
+					buffer.push_back(static_cast<char>(Opcode::LITERAL));
+					appendVarint(buffer,value);
+					return result_type();
+				} // end method literal
+
+				result_type literal(const big_uint_type &value)
+				{
+					++nNodes;
+					std::string magnitude;
+					boost::multiprecision::export_bits(value,std::back_inserter(magnitude),8,false);
+					buffer.push_back(static_cast<char>(Opcode::BIG_LITERAL));
+					appendVarint(buffer,magnitude.size());
+					buffer += magnitude;
+					return result_type();
+				} // end method literal
+
+				result_type variable(IDType id)
+				{
+					++nNodes;
+					if(positions[id] == std::numeric_limits<size_t>::max())
+					{
+						positions[id] = referencedSymbols.size();
+						referencedSymbols.push_back(id);
+					} // end if
+					buffer.push_back(static_cast<char>(Opcode::VARIABLE));
+					appendVarint(buffer,positions[id]);
+					return result_type();
+				} // end method variable
+
+				template<template<class> class Operator>
+				result_type unary(result_type)
+				{
+					++nNodes;
+					buffer.push_back(static_cast<char>(opcode(Operator<UIntType>())));
+					return result_type();
+				} // end method unary
+
+				template<template<class> class Operator>
+				result_type binary(result_type, result_type)
+				{
+					++nNodes;
+					buffer.push_back(static_cast<char>(opcode(Operator<UIntType>())));
+					return result_type();
+				} // end method binary
+
+				// Opcodes
+				static Opcode opcode(OpTags::unary_plus<UIntType>) {return Opcode::UNARY_PLUS;}
+				static Opcode opcode(OpTags::negate<UIntType>) {return Opcode::NEGATE;}
+				static Opcode opcode(OpTags::plus<UIntType>) {return Opcode::PLUS;}
+				static Opcode opcode(OpTags::minus<UIntType>) {return Opcode::MINUS;}
+				static Opcode opcode(OpTags::multiplies<UIntType>) {return Opcode::MULTIPLIES;}
+				static Opcode opcode(OpTags::divides<UIntType>) {return Opcode::DIVIDES;}
+				static Opcode opcode(OpTags::bit_xor<UIntType>) {return Opcode::POWER;}
+			}; // end struct Serializer
+
+			/** Reconstructs an expression written by serialize() in a single pass, using the
+			 *	nodes read so far as an explicit stack. Stored names are declared in symbols
+			 *	and stored IDs are mapped to the IDs they get there.
+			 */
+			template<typename InputIterator>
+			class Deserializer
+			{
+				// Fields
+				InputIterator current;
+				InputIterator end;
+				symbol_table_type &symbols;
+
+			public:
+				// Constructors
+				Deserializer(InputIterator begin, InputIterator end, symbol_table_type &symbols)
+					:current(begin),end(end),symbols(symbols)
+				{
+					// empty body
+				} // end Deserializer constructor
+
+				// Methods
+				node_pointer parse()
+				{
+					for(const char *magic = serializationMagic ; *magic ; ++magic)
+						if(readByte() != static_cast<unsigned char>(*magic))
+							error("not a serialized expression");
+					if(readByte() != serializationVersion)
+						error("unsupported version");
+
+					// read all names before declaring any, so that a corrupt header leaves symbols untouched
+					size_t nNames = readLength(); // each name takes at least a byte
+					std::vector<NameType> names;
+					names.reserve(std::min(nNames,size_t(maxReserved)));
+					while(names.size() < nNames)
+					{
+						names.emplace_back();
+						readBytes(names.back());
+					} // end while
+					std::vector<IDType> ids;
+					ids.reserve(names.size());
+					for(const auto &name : names)
+						ids.push_back(symbols.declare(name));
+
+					size_t nNodes = readVarint<size_t>();
+					std::vector<node_pointer> nodes;
+					nodes.reserve(std::min(nNodes,size_t(maxReserved))); // don't trust nNodes with the memory
+					for(size_t i = 0 ; i < nNodes ; ++i)
+					{
+						auto opcode = static_cast<Opcode>(readByte());
+						switch(opcode)
+						{
+						case Opcode::LITERAL:
+							nodes.push_back(makeLiteral(readVarint<UIntType>()));
+							break;
+						case Opcode::BIG_LITERAL:
+						{
+							std::string magnitude;
+							readBytes(magnitude);
+							big_uint_type value;
+							boost::multiprecision::import_bits(value,magnitude.begin(),magnitude.end(),8,false);
+							nodes.push_back(makeLiteral(value));
+							break;
+						}
+						case Opcode::VARIABLE:
+						{
+							size_t id = readVarint<size_t>();
+							if(id >= ids.size())
+								error("undeclared symbol");
+							nodes.push_back(makeNode(VariableNode(ids[id])));
+							break;
+						}
+						case Opcode::UNARY_PLUS: unaryCombine<OpTags::unary_plus>(nodes); break;
+						case Opcode::NEGATE: unaryCombine<OpTags::negate>(nodes); break;
+						case Opcode::PLUS: binaryCombine<OpTags::plus>(nodes); break;
+						case Opcode::MINUS: binaryCombine<OpTags::minus>(nodes); break;
+						case Opcode::MULTIPLIES: binaryCombine<OpTags::multiplies>(nodes); break;
+						case Opcode::DIVIDES: binaryCombine<OpTags::divides>(nodes); break;
+						case Opcode::POWER: binaryCombine<OpTags::bit_xor>(nodes); break;
+						default:
+							error("invalid opcode");
+						} // end switch
+					} // end while
+
+					if(nodes.size() > 1)
+						error("incomplete expression");
+					if(current != end)
+						error("trailing data");
+					return nodes.empty() ? nullptr : std::move(nodes.back());
+				} // end method parse
+
+			private:
+				static constexpr size_t maxReserved = 1024; // elements reserved for a count that wasn't checked against the input
+
+				unsigned char readByte()
+				{
+					if(current == end)
+						error("unexpected end of input");
+					unsigned char result = static_cast<unsigned char>(*current);
+					++current;
+					return result;
+				} // end method readByte
+
+				/** Reads a count of items taking at least a byte each, rejecting counts larger
+				 *	than the rest of the input when its size is known.
+				 */
+				size_t readLength()
+				{
+					size_t length = readVarint<size_t>();
+					if(!available(length,typename std::iterator_traits<InputIterator>::iterator_category()))
+						error("unexpected end of input");
+					return length;
+				} // end method readLength
+
+				bool available(size_t length, std::random_access_iterator_tag) const
+				{
+					return length <= static_cast<size_t>(end - current);
+				} // end method available
+
+				bool available(size_t, std::input_iterator_tag) const
+				{
+					return true; // readByte checks each byte instead
+				} // end method available
+
+				/** Reads a length followed by that many bytes into out.
+				 */
+				template<typename Container>
+				void readBytes(Container &out)
+				{
+					size_t length = readLength();
+					out.clear();
+					out.reserve(std::min(length,size_t(maxReserved)));
+					while(length--)
+						out.push_back(static_cast<typename Container::value_type>(readByte()));
+				} // end method readBytes
+
+				template<typename Integer>
+				Integer readVarint()
+				{
+					Integer result = 0;
+					unsigned char byte;
+					int shift = 0;
+					do
+					{
+						byte = readByte();
+						if(shift >= std::numeric_limits<Integer>::digits || Integer(Integer(byte & 0x7f) << shift) >> shift != Integer(byte & 0x7f))
+							error("number too large");
+						result |= Integer(Integer(byte & 0x7f) << shift);
+						shift += 7;
+					}while(byte & 0x80);
+					return result;
+				} // end method readVarint
+
+				template<template<class> class Operator>
+				void unaryCombine(std::vector<node_pointer> &nodes) const
+				{
+					if(nodes.empty())
+						error("missing operand");
+					nodes.back() = makeNode(UnaryNode<Operator>(std::move(nodes.back())));
+				} // end method unaryCombine
+
+				template<template<class> class Operator>
+				void binaryCombine(std::vector<node_pointer> &nodes) const
+				{
+					if(nodes.size() < 2)
+						error("missing operand");
+					node_pointer right = std::move(nodes.back());
+					nodes.pop_back();
+					nodes.back() = makeNode(BinaryNode<Operator>(std::move(nodes.back()),std::move(right)));
+				} // end method binaryCombine
+
+				[[noreturn]] static void error(const char *what)
+				{
+					throw std::runtime_error(std::string("Error reading serialized expression: ") + what + "!");
+				} // end function error
+			}; // end class Deserializer
 
 		}; // end class Expression
 
 		// out-of-class initializations
-		template<typename UIntType, typename NameType, typename IDType>
-		constexpr char Expression<UIntType,NameType,IDType>::quotientSymbol;
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType>
+		constexpr char Expression<UIntType,NameType,IDType,SymbolTableType>::quotientSymbol;
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType>
+		constexpr unsigned Expression<UIntType,NameType,IDType,SymbolTableType>::Simplifier::maxFoldedExponent;
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType>
+		constexpr char Expression<UIntType,NameType,IDType,SymbolTableType>::serializationMagic[];
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType>
+		constexpr unsigned char Expression<UIntType,NameType,IDType,SymbolTableType>::serializationVersion;
 
 		class Relation;
 		class RelationSystem;
@@ -881,7 +2182,568 @@ namespace Symbolic
 
 	namespace CanonicalForms
 	{
+		/** A multivariate polynomial with exact rational coefficients, kept in a canonical form so
+		 *	that equal polynomials have equal representations: the variables that appear are kept
+		 *	sorted by ID and the monomials, which have nonzero coefficients and are all distinct,
+		 *	are kept in descending graded lexicographic order.
+		 *	Monomials are stored as exponent vectors in a single flat array, each prefixed by its
+		 *	total degree so that comparing two prefixed vectors lexicographically compares the
+		 *	monomials in graded order. Equality and hashing work directly on the arrays, without
+		 *	allocating, and addition is a single merge of the monomial sequences.
+		 */
+		template<typename RationalType = boost::multiprecision::cpp_rational, typename IDType = size_t, typename ExponentType = unsigned>
+		class Polynomial
+		{
+			/**********************
+			*    Concept Check    *
+			**********************/
 
+			static_assert(std::is_unsigned<ExponentType>::value, "ExponentType must be an unsigned integral type!");
+
+			/*********************
+			*    Member Types    *
+			*********************/
+		public:
+			using rational_type = RationalType;
+			using id_type = IDType;
+			using exponent_type = ExponentType;
+
+			/***************
+			*    Fields    *
+			***************/
+		private:
+			std::vector<IDType> variables; // sorted, each appearing in at least one monomial
+			std::vector<ExponentType> exponents; // 1+variables.size() per monomial: the total degree, then one exponent per variable
+			std::vector<RationalType> coefficients; // nonzero, one per monomial
+
+			/*******************************************
+			*    Constructors / Destructor / Factory   *
+			*******************************************/
+		public:
+			/** Construct the zero polynomial.
+			 */
+			Polynomial() = default;
+
+			/** Construct a constant polynomial.
+			 */
+			Polynomial(const RationalType &constant)
+			{
+				if(constant != 0)
+				{
+					exponents.push_back(0);
+					coefficients.push_back(constant);
+				} // end if
+			} // end Polynomial conversion constructor
+
+			/** Returns the polynomial consisting of the variable with the given id.
+			 */
+			static Polynomial variable(IDType id)
+			{
+				Polynomial result;
+				result.variables.push_back(id);
+				result.exponents = {1,1};
+				result.coefficients.push_back(RationalType(1));
+				return result;
+			} // end static method variable
+
+			/****************
+			*    Methods    *
+			****************/
+		public:
+			/** Returns the number of monomials.
+			 */
+			size_t size() const
+			{
+				return coefficients.size();
+			} // end method size
+
+			bool isZero() const
+			{
+				return coefficients.empty();
+			} // end method isZero
+
+			bool isConstant() const
+			{
+				return variables.empty();
+			} // end method isConstant
+
+			ExponentType degree() const
+			{
+				return isZero() ? 0 : exponents[0];
+			} // end method degree
+
+			const std::vector<IDType> &getVariables() const
+			{
+				return variables;
+			} // end method getVariables
+
+			const RationalType &coefficient(size_t monomial) const
+			{
+				return coefficients.at(monomial);
+			} // end method coefficient
+
+			/** Returns the exponent of getVariables()[variable] in the given monomial.
+			 */
+			ExponentType exponent(size_t monomial, size_t variable) const
+			{
+				if(monomial >= size() || variable >= variables.size())
+					throw std::out_of_range("No such monomial or variable!");
+				return exponents[monomial*stride() + 1 + variable];
+			} // end method exponent
+
+			/** Raises the polynomial to a natural power by repeated squaring.
+			 */
+			Polynomial power(unsigned long long int exponent) const
+			{
+				Polynomial result(RationalType(1));
+				Polynomial base(*this);
+				for( ; exponent ; exponent >>= 1)
+				{
+					if(exponent & 1)
+						result *= base;
+					if(exponent > 1)
+						base *= base;
+				} // end for
+				return result;
+			} // end method power
+
+			/** Combines the hashes of the variables, exponents and coefficients. Does not allocate.
+			 */
+			size_t hash() const
+			{
+				size_t seed = variables.size();
+				for(auto id : variables)
+					boost::hash_combine(seed,id);
+				for(auto exponent : exponents)
+					boost::hash_combine(seed,exponent);
+				for(const auto &coefficient : coefficients)
+					boost::hash_combine(seed,hashValue(coefficient));
+				return seed;
+			} // end method hash
+
+			/** Prints the polynomial in the syntax accepted by the expression parsers,
+			 *	using the names of variables in symbols.
+			 */
+			template<typename SymbolTableType>
+			void print(std::ostream &out, const SymbolTableType &symbols) const
+			{
+				if(isZero())
+					out << '0';
+				for(size_t i = 0 ; i < size() ; ++i)
+				{
+					const ExponentType *monomial = exponents.data() + i*stride();
+					bool negative = coefficients[i] < 0;
+					RationalType magnitude = negative ? RationalType(-coefficients[i]) : coefficients[i];
+					if(negative)
+						out << '-';
+					else if(i)
+						out << '+';
+
+					bool first = true;
+					if(magnitude != 1 || monomial[0] == 0)
+					{
+						out << magnitude;
+						first = false;
+					} // end if
+					for(size_t v = 0 ; v < variables.size() ; ++v)
+						if(monomial[1+v])
+						{
+							if(!first)
+								out << '*';
+							out << symbols.name(variables[v]);
+							if(monomial[1+v] > 1)
+								out << '^' << monomial[1+v];
+							first = false;
+						} // end if
+				} // end for
+			} // end method print
+
+			/******************
+			*    Operators    *
+			******************/
+		public:
+			Polynomial operator+() const
+			{
+				return *this;
+			} // end method operator+
+
+			Polynomial operator-() const
+			{
+				Polynomial result(*this);
+				for(auto &coefficient : result.coefficients)
+					coefficient = -coefficient;
+				return result;
+			} // end method operator-
+
+			Polynomial &operator+=(const Polynomial &other)
+			{
+				return *this = merge(*this,other,false);
+			} // end method operator+=
+
+			Polynomial &operator-=(const Polynomial &other)
+			{
+				return *this = merge(*this,other,true);
+			} // end method operator-=
+
+			Polynomial &operator*=(const Polynomial &other)
+			{
+				return *this = multiply(*this,other);
+			} // end method operator*=
+
+			bool operator==(const Polynomial &other) const
+			{
+				return variables == other.variables && exponents == other.exponents && coefficients == other.coefficients;
+			} // end method operator==
+
+			bool operator!=(const Polynomial &other) const
+			{
+				return !(*this == other);
+			} // end method operator!=
+
+			/*************************
+			*    Support Functions   *
+			*************************/
+		private:
+			size_t stride() const
+			{
+				return 1 + variables.size();
+			} // end method stride
+
+			template<typename IntType>
+			static size_t hashValue(const boost::rational<IntType> &value)
+			{
+				size_t seed = 0;
+				boost::hash_combine(seed,value.numerator());
+				boost::hash_combine(seed,value.denominator());
+				return seed;
+			} // end function hashValue
+
+			// for boost::multiprecision rationals
+			template<typename Number>
+			static size_t hashValue(const Number &value)
+			{
+				return boost::hash<Number>()(value);
+			} // end function hashValue
+
+			/** Returns whether monomial a comes before monomial b in descending graded lexicographic order.
+			 */
+			static bool precedes(const ExponentType *a, const ExponentType *b, size_t stride)
+			{
+				return std::lexicographical_compare(b,b+stride,a,a+stride);
+			} // end function precedes
+
+			/** Returns the exponents of the polynomial rewritten in terms of a superset of its variables.
+			 */
+			std::vector<ExponentType> embed(const std::vector<IDType> &superset) const
+			{
+				std::vector<size_t> positions; // of each variable in superset
+				positions.reserve(variables.size());
+				for(size_t v = 0, s = 0 ; v < variables.size() ; ++v, ++s)
+				{
+					while(superset[s] != variables[v])
+						++s;
+					positions.push_back(1+s);
+				} // end for
+
+				std::vector<ExponentType> result(size()*(1+superset.size()),0);
+				for(size_t i = 0 ; i < size() ; ++i)
+				{
+					const ExponentType *from = exponents.data() + i*stride();
+					ExponentType *to = result.data() + i*(1+superset.size());
+					to[0] = from[0];
+					for(size_t v = 0 ; v < variables.size() ; ++v)
+						to[positions[v]] = from[1+v];
+				} // end for
+				return result;
+			} // end method embed
+
+			/** Rewrites the two polynomials in terms of the union of their variables, storing the
+			 *	union in variables and pointing a and b to the rewritten exponents. Avoids copying the
+			 *	exponents of a polynomial whose variables are already the union.
+			 */
+			static void unify(const Polynomial &left, const Polynomial &right, std::vector<IDType> &variables,
+				std::vector<ExponentType> storage[2], const ExponentType *&a, const ExponentType *&b)
+			{
+				std::set_union(left.variables.begin(),left.variables.end(),right.variables.begin(),right.variables.end(),std::back_inserter(variables));
+				a = left.exponents.data();
+				b = right.exponents.data();
+				if(left.variables.size() != variables.size())
+					a = (storage[0] = left.embed(variables)).data();
+				if(right.variables.size() != variables.size())
+					b = (storage[1] = right.embed(variables)).data();
+			} // end function unify
+
+			/** Removes variables that no longer appear in any monomial, e.g. after cancellation.
+			 */
+			void trim()
+			{
+				std::vector<bool> used(variables.size(),false);
+				for(size_t i = 0 ; i < size() ; ++i)
+					for(size_t v = 0 ; v < variables.size() ; ++v)
+						if(exponents[i*stride() + 1 + v])
+							used[v] = true;
+				if(std::find(used.begin(),used.end(),false) == used.end())
+					return;
+
+				size_t oldStride = stride();
+				size_t out = 0;
+				for(size_t i = 0 ; i < size() ; ++i)
+				{
+					exponents[out++] = exponents[i*oldStride];
+					for(size_t v = 0 ; v < used.size() ; ++v)
+						if(used[v])
+							exponents[out++] = exponents[i*oldStride + 1 + v];
+				} // end for
+				exponents.resize(out);
+
+				size_t kept = 0;
+				for(size_t v = 0 ; v < used.size() ; ++v)
+					if(used[v])
+						variables[kept++] = variables[v];
+				variables.resize(kept);
+			} // end method trim
+
+			/** Adds or subtracts two polynomials by merging their monomial sequences.
+			 */
+			static Polynomial merge(const Polynomial &left, const Polynomial &right, bool subtract)
+			{
+				Polynomial result;
+				std::vector<ExponentType> storage[2];
+				const ExponentType *a, *b;
+				unify(left,right,result.variables,storage,a,b);
+				const size_t stride = result.stride();
+				result.exponents.reserve((left.size() + right.size())*stride);
+				result.coefficients.reserve(left.size() + right.size());
+
+				auto append = [&result,stride](const ExponentType *monomial, RationalType coefficient){
+					result.exponents.insert(result.exponents.end(),monomial,monomial+stride);
+					result.coefficients.push_back(std::move(coefficient));
+				};
+				size_t i = 0, j = 0;
+				while(i < left.size() || j < right.size())
+				{
+					if(j == right.size() || (i < left.size() && precedes(a+i*stride,b+j*stride,stride)))
+					{
+						append(a+i*stride,left.coefficients[i]);
+						++i;
+					}
+					else if(i == left.size() || precedes(b+j*stride,a+i*stride,stride))
+					{
+						append(b+j*stride,subtract ? RationalType(-right.coefficients[j]) : right.coefficients[j]);
+						++j;
+					}
+					else
+					{
+						RationalType sum = subtract ? RationalType(left.coefficients[i] - right.coefficients[j])
+													: RationalType(left.coefficients[i] + right.coefficients[j]);
+						if(sum != 0)
+							append(a+i*stride,std::move(sum));
+						++i;
+						++j;
+					} // end else
+				} // end while
+
+				result.trim();
+				return result;
+			} // end function merge
+
+			/** Multiplies every monomial of one polynomial with every monomial of the other,
+			 *	then sorts the products and adds up those with equal exponents.
+			 */
+			static Polynomial multiply(const Polynomial &left, const Polynomial &right)
+			{
+				if(left.isConstant() || right.isConstant()) // just scale the coefficients
+				{
+					if(left.isZero() || right.isZero())
+						return Polynomial();
+					Polynomial result(left.isConstant() ? right : left);
+					const RationalType factor = left.isConstant() ? left.coefficients[0] : right.coefficients[0];
+					for(auto &coefficient : result.coefficients)
+						coefficient *= factor;
+					return result;
+				} // end if
+
+				Polynomial products;
+				std::vector<ExponentType> storage[2];
+				const ExponentType *a, *b;
+				unify(left,right,products.variables,storage,a,b);
+				const size_t stride = products.stride();
+				products.exponents.resize(left.size()*right.size()*stride);
+				products.coefficients.reserve(left.size()*right.size());
+
+				ExponentType *product = products.exponents.data();
+				for(size_t i = 0 ; i < left.size() ; ++i)
+					for(size_t j = 0 ; j < right.size() ; ++j, product += stride)
+					{
+						for(size_t e = 0 ; e < stride ; ++e)
+						{
+							product[e] = a[i*stride+e] + b[j*stride+e];
+							if(product[e] < a[i*stride+e])
+								throw std::overflow_error("Exponent too large for ExponentType!");
+						} // end for
+						products.coefficients.push_back(left.coefficients[i]*right.coefficients[j]);
+					} // end for
+
+				std::vector<size_t> order(products.size());
+				std::iota(order.begin(),order.end(),0);
+				std::sort(order.begin(),order.end(),[&products,stride](size_t x, size_t y){
+					return precedes(products.exponents.data()+x*stride,products.exponents.data()+y*stride,stride);
+				});
+
+				Polynomial result;
+				result.variables = std::move(products.variables);
+				for(size_t k = 0 ; k < order.size() ; )
+				{
+					const ExponentType *monomial = products.exponents.data() + order[k]*stride;
+					RationalType sum = std::move(products.coefficients[order[k]]);
+					for(++k ; k < order.size() && std::equal(monomial,monomial+stride,products.exponents.data()+order[k]*stride) ; ++k)
+						sum += products.coefficients[order[k]];
+					if(sum != 0)
+					{
+						result.exponents.insert(result.exponents.end(),monomial,monomial+stride);
+						result.coefficients.push_back(std::move(sum));
+					} // end if
+				} // end for
+
+				result.trim();
+				return result;
+			} // end function multiply
+		}; // end class Polynomial
+
+		template<typename RationalType, typename IDType, typename ExponentType>
+		inline Polynomial<RationalType,IDType,ExponentType> operator+(Polynomial<RationalType,IDType,ExponentType> left, const Polynomial<RationalType,IDType,ExponentType> &right)
+		{
+			return left += right;
+		} // end function operator+
+
+		template<typename RationalType, typename IDType, typename ExponentType>
+		inline Polynomial<RationalType,IDType,ExponentType> operator-(Polynomial<RationalType,IDType,ExponentType> left, const Polynomial<RationalType,IDType,ExponentType> &right)
+		{
+			return left -= right;
+		} // end function operator-
+
+		template<typename RationalType, typename IDType, typename ExponentType>
+		inline Polynomial<RationalType,IDType,ExponentType> operator*(Polynomial<RationalType,IDType,ExponentType> left, const Polynomial<RationalType,IDType,ExponentType> &right)
+		{
+			return left *= right;
+		} // end function operator*
+
+		/** An algebra for FreeForms::Expression::fold that brings an expression to polynomial
+		 *	canonical form. Divisors must be constant and exponents natural constants, unless the
+		 *	base is a constant too. Other expressions throw std::domain_error.
+		 */
+		template<typename PolynomialType>
+		struct PolynomialBuilder
+		{
+			// Member Types
+			using result_type = PolynomialType;
+			using rational_type = typename PolynomialType::rational_type;
+
+			// Folding Methods
+			template<typename Integer>
+			result_type literal(const Integer &value) const
+			{
+				return result_type(toRational(value,std::is_constructible<rational_type,const Integer &>()));
+			} // end method literal
+
+			template<typename IDType>
+			result_type variable(IDType id) const
+			{
+				return result_type::variable(id);
+			} // end method variable
+
+			template<template<class> class Operator>
+			result_type unary(result_type child) const
+			{
+				return Operator<result_type>()(child);
+			} // end method unary
+
+			template<template<class> class Operator>
+			result_type binary(result_type left, result_type right) const
+			{
+				return apply(Operator<result_type>(),left,right);
+			} // end method binary
+
+		private:
+			template<typename Operator>
+			static result_type apply(Operator op, const result_type &left, const result_type &right)
+			{
+				return op(left,right);
+			} // end function apply
+
+			static result_type apply(FreeForms::OpTags::divides<result_type>, const result_type &left, const result_type &right)
+			{
+				if(!right.isConstant())
+					throw std::domain_error("Only divisions by constants have a polynomial canonical form!");
+				if(right.isZero())
+					throw std::domain_error("Division by zero!");
+				return left * result_type(rational_type(rational_type(1)/right.coefficient(0)));
+			} // end function apply
+
+			static result_type apply(FreeForms::OpTags::bit_xor<result_type>, const result_type &base, const result_type &exponent)
+			{
+				rational_type value = exponent.isZero() ? rational_type(0) : exponent.coefficient(0);
+				if(!exponent.isConstant() || !isInteger(value))
+					throw std::domain_error("Only integer constant exponents have a polynomial canonical form!");
+				if(value < 0)
+				{
+					if(!base.isConstant())
+						throw std::domain_error("Negative powers of variables have no polynomial canonical form!");
+					if(base.isZero())
+						throw std::domain_error("Division by zero!");
+					return result_type(rational_type(rational_type(1)/base.coefficient(0))).power(toNatural(rational_type(-value)));
+				} // end if
+				return base.power(toNatural(value));
+			} // end function apply
+
+			template<typename Integer>
+			static rational_type toRational(const Integer &value, std::true_type)
+			{
+				return rational_type(value);
+			} // end function toRational
+
+			template<typename Integer>
+			static rational_type toRational(const Integer &, std::false_type)
+			{
+				throw std::overflow_error("Literal too large for the rational type of the polynomial!");
+			} // end function toRational
+
+			template<typename IntType>
+			static bool isInteger(const boost::rational<IntType> &value)
+			{
+				return value.denominator() == 1;
+			} // end function isInteger
+
+			template<typename IntType>
+			static unsigned long long int toNatural(const boost::rational<IntType> &value)
+			{
+				return boost::numeric_cast<unsigned long long int>(value.numerator());
+			} // end function toNatural
+
+			// for boost::multiprecision rationals
+			template<typename Number>
+			static bool isInteger(const Number &value)
+			{
+				return denominator(value) == 1;
+			} // end function isInteger
+
+			template<typename Number>
+			static unsigned long long int toNatural(const Number &value)
+			{
+				if(numerator(value) > std::numeric_limits<unsigned long long int>::max())
+					throw std::overflow_error("Exponent too large for polynomial canonical form!");
+				return static_cast<unsigned long long int>(numerator(value));
+			} // end function toNatural
+		}; // end struct PolynomialBuilder
+
+		/** Convenience function returning the polynomial canonical form of an expression.
+		 */
+		template<typename RationalType = boost::multiprecision::cpp_rational, typename ExponentType = unsigned,
+			typename UIntType, typename NameType, typename IDType, typename SymbolTableType>
+		Polynomial<RationalType,IDType,ExponentType> toPolynomial(const FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType> &expression)
+		{
+			return expression.fold(PolynomialBuilder<Polynomial<RationalType,IDType,ExponentType>>());
+		} // end function toPolynomial
 
 	} // end namespace CanonicalForms
 
@@ -929,10 +2791,10 @@ namespace Symbolic
 
 
 #define UNARY_EXPRESSION(op,tag) \
-		template<typename UIntType, typename NameType, typename IDType> \
-		inline FreeForms::Expression<UIntType,NameType,IDType> operator op (FreeForms::Expression<UIntType,NameType,IDType> subExpression) \
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType> \
+		inline FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType> operator op (FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType> subExpression) \
 		{\
-			return FreeForms::Expression<UIntType,NameType,IDType>::template unaryCombine<tag>(std::move(subExpression));\
+			return FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType>::template unaryCombine<tag>(std::move(subExpression));\
 		} // end function operator op
 
 		UNARY_EXPRESSION(+,FreeForms::OpTags::unary_plus);
@@ -940,24 +2802,24 @@ namespace Symbolic
 #undef UNARY_EXPRESSION
 
 #define BINARY_EXPRESSION(op,tag) \
-		template<typename UIntType, typename NameType, typename IDType> \
-		inline decltype(auto) operator op(FreeForms::Expression<UIntType,NameType,IDType> leftSubExpression, FreeForms::Expression<UIntType,NameType,IDType> rightSubExpression) \
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType> \
+		inline decltype(auto) operator op(FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType> leftSubExpression, FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType> rightSubExpression) \
 		{\
-			return FreeForms::Expression<UIntType,NameType,IDType>::template \
+			return FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType>::template \
 				binaryCombine<tag>(std::move(leftSubExpression),std::move(rightSubExpression));\
 		} /* end function operator op*/\
 		\
-		template<typename UIntType, typename NameType, typename IDType, typename OtherOpType> \
-		inline decltype(auto) operator op(FreeForms::Expression<UIntType,NameType,IDType> leftSubExpression, OtherOpType &&rightSubExpression) \
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType, typename OtherOpType> \
+		inline decltype(auto) operator op(FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType> leftSubExpression, OtherOpType &&rightSubExpression) \
 		{\
-			return FreeForms::Expression<UIntType,NameType,IDType>::template \
+			return FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType>::template \
 				binaryCombine<tag>(std::move(leftSubExpression),decltype(leftSubExpression)(std::forward<OtherOpType>(rightSubExpression)));\
 		} /* end function operator op*/\
 		\
-		template<typename UIntType, typename NameType, typename IDType, typename OtherOpType> \
-		inline decltype(auto) operator op(OtherOpType &&leftSubExpression, FreeForms::Expression<UIntType,NameType,IDType> rightSubExpression) \
+		template<typename UIntType, typename NameType, typename IDType, typename SymbolTableType, typename OtherOpType> \
+		inline decltype(auto) operator op(OtherOpType &&leftSubExpression, FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType> rightSubExpression) \
 		{\
-			return FreeForms::Expression<UIntType,NameType,IDType>::template \
+			return FreeForms::Expression<UIntType,NameType,IDType,SymbolTableType>::template \
 				binaryCombine<tag>(decltype(rightSubExpression)(std::forward<OtherOpType>(leftSubExpression)),std::move(rightSubExpression));\
 		} /* end function operator op*/
 
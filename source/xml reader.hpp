@@ -0,0 +1,388 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef XML_READER_H
+#define XML_READER_H
+
+#include <string>
+#include <vector>
+#include <locale>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <typeinfo>
+#include <algorithm>
+
+#include <boost/optional.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/stream_translator.hpp>
+#include <boost/property_tree/detail/rapidxml.hpp>
+#include <boost/property_tree/detail/xml_parser_error.hpp>
+
+namespace XML
+{
+	class Document;
+	class ElementIterator;
+
+	/** A read-only view of a node of a parsed XML Document that can be queried like the
+	 *	boost::property_tree::ptree boost::property_tree::read_xml would produce from the same
+	 *	text, without building that tree: attributes appear as children of an "<xmlattr>"
+	 *	child, comments as "<xmlcomment>" children, and the data of an element is the
+	 *	concatenation of its text. Lookups and conversions throw the same exceptions with the
+	 *	same messages as the corresponding ptree methods.
+	 */
+	class Element
+	{
+		/*********************
+		*    Member Types    *
+		*********************/
+	public:
+		using node_type = boost::property_tree::detail::rapidxml::xml_node<char>;
+		using attribute_type = boost::property_tree::detail::rapidxml::xml_attribute<char>;
+		using const_iterator = ElementIterator;
+
+	private:
+		enum class Kind {NONE, NODE, ATTRIBUTES, ATTRIBUTE};
+
+		/***************
+		*    Fields    *
+		***************/
+
+		const Document *iDocument;
+		Kind iKind;
+		node_type *iNode; // the element, comment or document for NODE, the owner of the attributes for ATTRIBUTES
+		attribute_type *iAttribute;
+
+		/*********************
+		*    Constructors    *
+		*********************/
+
+		Element(const Document *document = nullptr, Kind kind = Kind::NONE, node_type *node = nullptr, attribute_type *attribute = nullptr)
+			:iDocument(document),iKind(kind),iNode(node),iAttribute(attribute)
+		{
+			// empty body
+		} // end Element constructor
+
+		friend class Document;
+		friend class ElementIterator;
+
+		/*************************
+		*    Accessor Methods    *
+		*************************/
+	public:
+		std::string name() const
+		{
+			switch(iKind)
+			{
+			case Kind::NODE:
+				return iNode->type() == boost::property_tree::detail::rapidxml::node_comment ? "<xmlcomment>" : std::string(iNode->name(),iNode->name_size());
+			case Kind::ATTRIBUTES:
+				return "<xmlattr>";
+			case Kind::ATTRIBUTE:
+				return std::string(iAttribute->name(),iAttribute->name_size());
+			default:
+				return "";
+			} // end switch
+		} // end method name
+
+		std::string data() const
+		{
+			using namespace boost::property_tree::detail::rapidxml;
+
+			if(iKind == Kind::ATTRIBUTE)
+				return std::string(iAttribute->value(),iAttribute->value_size());
+			if(iKind != Kind::NODE)
+				return "";
+			if(iNode->type() == node_comment)
+				return std::string(iNode->value(),iNode->value_size());
+
+			std::string result;
+			for(node_type *child = iNode->first_node() ; child ; child = child->next_sibling())
+				if(child->type() == node_data || child->type() == node_cdata)
+					result.append(child->value(),child->value_size());
+			return result;
+		} // end method data
+
+		/****************
+		*    Methods    *
+		****************/
+
+		const_iterator begin() const;
+		const_iterator end() const;
+
+		/** Returns the child at path, whose parts are separated by '.', or nothing if there is no
+		 *	such child. Like in a ptree, only the first child with each name is considered.
+		 */
+		boost::optional<Element> get_child_optional(const std::string &path) const
+		{
+			Element current = *this;
+			for(size_t start = 0 ; ; )
+			{
+				size_t stop = std::min(path.find('.',start),path.size());
+				Element child = current.firstChild();
+				while(child.iKind != Kind::NONE && !child.named(path.data()+start,stop-start))
+					child = child.nextSibling();
+				if(child.iKind == Kind::NONE)
+					return boost::none;
+				current = child;
+				if(stop == path.size())
+					return current;
+				start = stop+1;
+			} // end for
+		} // end method get_child_optional
+
+		Element get_child(const std::string &path) const
+		{
+			if(auto child = get_child_optional(path))
+				return *child;
+			throw boost::property_tree::ptree_bad_path("No such node",boost::property_tree::ptree::path_type(path));
+		} // end method get_child
+
+		template<typename Type>
+		Type get_value() const;
+
+		template<typename Type>
+		Type get(const std::string &path) const
+		{
+			return get_child(path).get_value<Type>();
+		} // end method get
+
+	private:
+		bool named(const char *name, size_t size) const
+		{
+			switch(iKind)
+			{
+			case Kind::NODE:
+				if(iNode->type() == boost::property_tree::detail::rapidxml::node_comment)
+					return size == 12 && std::memcmp(name,"<xmlcomment>",size) == 0;
+				return size == iNode->name_size() && std::memcmp(name,iNode->name(),size) == 0;
+			case Kind::ATTRIBUTES:
+				return size == 9 && std::memcmp(name,"<xmlattr>",size) == 0;
+			case Kind::ATTRIBUTE:
+				return size == iAttribute->name_size() && std::memcmp(name,iAttribute->name(),size) == 0;
+			default:
+				return false;
+			} // end switch
+		} // end method named
+
+		// Returns the first element or comment among node and its following siblings.
+		Element nodeFrom(node_type *node) const
+		{
+			using namespace boost::property_tree::detail::rapidxml;
+
+			while(node && node->type() != node_element && node->type() != node_comment)
+				node = node->next_sibling();
+			return node ? Element(iDocument,Kind::NODE,node) : Element();
+		} // end method nodeFrom
+
+		Element firstChild() const
+		{
+			switch(iKind)
+			{
+			case Kind::NODE:
+				if(iNode->type() == boost::property_tree::detail::rapidxml::node_comment)
+					return Element();
+				if(iNode->first_attribute())
+					return Element(iDocument,Kind::ATTRIBUTES,iNode);
+				return nodeFrom(iNode->first_node());
+			case Kind::ATTRIBUTES:
+				return Element(iDocument,Kind::ATTRIBUTE,iNode,iNode->first_attribute());
+			default:
+				return Element();
+			} // end switch
+		} // end method firstChild
+
+		Element nextSibling() const
+		{
+			switch(iKind)
+			{
+			case Kind::NODE:
+				return nodeFrom(iNode->next_sibling());
+			case Kind::ATTRIBUTES:
+				return nodeFrom(iNode->first_node());
+			case Kind::ATTRIBUTE:
+				return iAttribute->next_attribute() ? Element(iDocument,Kind::ATTRIBUTE,iNode,iAttribute->next_attribute()) : Element();
+			default:
+				return Element();
+			} // end switch
+		} // end method nextSibling
+	}; // end class Element
+
+	/** Iterates over the children of an Element in document order.
+	 */
+	class ElementIterator
+	{
+		/***************
+		*    Fields    *
+		***************/
+
+		Element iCurrent;
+
+		/*********************
+		*    Constructors    *
+		*********************/
+	public:
+		explicit ElementIterator(Element current = Element())
+			:iCurrent(current)
+		{
+			// empty body
+		} // end ElementIterator constructor
+
+		/****************
+		*    Methods    *
+		****************/
+
+		const Element &operator*() const
+		{
+			return iCurrent;
+		} // end method operator*
+
+		const Element *operator->() const
+		{
+			return &iCurrent;
+		} // end method operator->
+
+		ElementIterator &operator++()
+		{
+			iCurrent = iCurrent.nextSibling();
+			return *this;
+		} // end method operator++
+
+		ElementIterator operator++(int)
+		{
+			auto old = *this;
+			++*this;
+			return old;
+		} // end method operator++
+
+		bool operator==(const ElementIterator &other) const
+		{
+			return iCurrent.iNode == other.iCurrent.iNode && iCurrent.iAttribute == other.iCurrent.iAttribute
+				&& iCurrent.iKind == other.iCurrent.iKind;
+		} // end method operator==
+
+		bool operator!=(const ElementIterator &other) const
+		{
+			return !(*this == other);
+		} // end method operator!=
+	}; // end class ElementIterator
+
+	inline Element::const_iterator Element::begin() const
+	{
+		return const_iterator(firstChild());
+	} // end method begin
+
+	inline Element::const_iterator Element::end() const
+	{
+		return const_iterator(Element());
+	} // end method end
+
+	/** An XML file parsed in place, the way boost::property_tree::read_xml parses it: it is
+	 *	read in a single buffer and parsed without copying names or text, and parse errors are
+	 *	reported with the same boost::property_tree::xml_parser_error.
+	 *	The Elements of a Document refer to it and should not outlive it.
+	 */
+	class Document
+	{
+		/***************
+		*    Fields    *
+		***************/
+
+		std::vector<char> iText;
+		boost::property_tree::detail::rapidxml::xml_document<char> iDocument;
+		mutable std::istringstream iStream; // reused for conversions
+
+		/*********************
+		*    Constructors    *
+		*********************/
+	public:
+		explicit Document(const std::string &fileName)
+		{
+			using namespace boost::property_tree::detail::rapidxml;
+			using boost::property_tree::xml_parser::xml_parser_error;
+
+			std::ifstream file(fileName.c_str());
+			if(!file)
+				throw xml_parser_error("cannot open file",fileName,0);
+			file.imbue(std::locale());
+			file.unsetf(std::ios::skipws);
+			iText.assign(std::istreambuf_iterator<char>(file.rdbuf()),std::istreambuf_iterator<char>());
+			if(!file.good())
+				throw xml_parser_error("read error",fileName,0);
+			iText.push_back(0);
+
+			try
+			{
+				iDocument.parse<parse_comment_nodes>(iText.data());
+			}
+			catch(parse_error &error)
+			{
+				long line = static_cast<long>(std::count(iText.data(),error.where<char>(),'\n') + 1);
+				throw xml_parser_error(error.what(),fileName,line);
+			} // end catch
+		} // end Document constructor
+
+		Document(const Document &) = delete;
+		Document &operator=(const Document &) = delete;
+
+		/****************
+		*    Methods    *
+		****************/
+
+		/** Returns the element corresponding to the root of the property tree.
+		 */
+		Element root() const
+		{
+			return Element(this,Element::Kind::NODE,const_cast<Element::node_type *>(static_cast<const Element::node_type *>(&iDocument)));
+		} // end method root
+
+		/** Converts data like boost::property_tree::stream_translator does, but reusing a single
+		 *	stream.
+		 */
+		template<typename Type>
+		Type convert(const std::string &data) const
+		{
+			iStream.clear();
+			iStream.flags(std::ios_base::skipws | std::ios_base::dec);
+			iStream.str(data);
+
+			Type value;
+			boost::property_tree::customize_stream<char,std::char_traits<char>,Type>::extract(iStream,value);
+			if(iStream.fail() || iStream.bad() || iStream.get() != std::char_traits<char>::eof())
+				throw boost::property_tree::ptree_bad_data(std::string("conversion of data to type \"") + typeid(Type).name() + "\" failed",data);
+			return value;
+		} // end method convert
+	}; // end class Document
+
+	template<>
+	inline std::string Document::convert<std::string>(const std::string &data) const
+	{
+		return data;
+	} // end method convert
+
+	template<typename Type>
+	Type Element::get_value() const
+	{
+		return iDocument->convert<Type>(data());
+	} // end method get_value
+
+} // end namespace XML
+
+#endif // XML_READER_H
@@ -0,0 +1,142 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch evaluation.hpp"
+
+#include <cmath>
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <memory>
+#include <stdexcept>
+
+#include "linear system solving.hpp"
+#include "eigen-rational interface code.hpp"
+
+#include <boost/rational.hpp>
+
+using Rational = boost::rational<long long int>;
+
+#define BOOST_TEST_MODULE Batch Evaluation
+#include <boost/test/included/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Batch_Evaluation)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	using BatchEvaluation::Program;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	auto parse = [&st](const string &input){return Expression<>(input.begin(),input.end(),st);};
+	Expression<> layout = parse("(screenWidth - 2*margin)/pixelWidth + 0.5");
+	Expression<> powers = parse("x^2 - x^(-1) + 2^3*x^0 - x^y");
+	Expression<> mixed = parse("1 - x*(3 - y) + (x - y)/(2 + y) + -x");
+	Expression<> constant = parse("2^(-1)*(3 + 1)");
+
+	// columns in a different order than symbol IDs
+	vector<size_t> columns(st->size());
+	columns[st->id("screenWidth")] = 2;
+	columns[st->id("margin")] = 0;
+	columns[st->id("pixelWidth")] = 1;
+	columns[st->id("x")] = 0;
+	columns[st->id("y")] = 1;
+
+	// sizes around the number of lanes exercise the partial last block
+	for(size_t n : {0,1,7,8,9,16,17,100})
+	{
+		vector<vector<double>> bindings(3,vector<double>(n));
+		for(size_t i = 0 ; i < n ; ++i)
+		{
+			bindings[0][i] = 1 + 0.25*i;
+			bindings[1][i] = 0.5 + (i % 5);
+			bindings[2][i] = 1000 + 3*i;
+		} // end for
+
+		auto layoutValues = Program<double,8>(layout,columns).evaluate(bindings);
+		auto powerValues = Program<double,8>(powers,columns).evaluate(bindings);
+		auto mixedValues = Program<>(mixed,columns).evaluate(bindings);
+		auto constantValues = Program<>(constant,columns).evaluate(bindings);
+		BOOST_REQUIRE_EQUAL(layoutValues.size(), n);
+		BOOST_REQUIRE_EQUAL(powerValues.size(), n);
+		BOOST_REQUIRE_EQUAL(mixedValues.size(), n);
+		BOOST_REQUIRE_EQUAL(constantValues.size(), n);
+
+		for(size_t i = 0 ; i < n ; ++i)
+		{
+			double x = bindings[0][i], y = bindings[1][i], z = bindings[2][i];
+			BOOST_CHECK_CLOSE(layoutValues[i], (z - 2*x)/y + 0.5, 1e-12);
+			BOOST_CHECK_CLOSE(powerValues[i], x*x - 1/x + 8 - std::pow(x,y), 1e-12);
+			BOOST_CHECK_CLOSE(mixedValues[i], 1 - x*(3 - y) + (x - y)/(2 + y) - x, 1e-12);
+			BOOST_CHECK_EQUAL(constantValues[i], 2.0);
+		} // end for
+	} // end for
+
+	// floats and raw arrays
+	vector<float> xs = {1,2,3}, ys = {4,5,6}, results(3);
+	Program<float,16>(parse("x*y + x^3"),columns).evaluate({xs.data(),ys.data()},3,results.data());
+	BOOST_CHECK_EQUAL(results[0], 5.0f);
+	BOOST_CHECK_EQUAL(results[1], 18.0f);
+	BOOST_CHECK_EQUAL(results[2], 45.0f);
+
+	// constants are folded away
+	BOOST_CHECK_EQUAL(Program<>(constant,columns).size(), 1u);
+	BOOST_CHECK_EQUAL(Program<>(parse("x + 2*3"),columns).size(), 3u);
+	BOOST_CHECK_EQUAL(Program<>(layout,columns).columns(), 3u);
+
+	BOOST_CHECK_THROW(Program<>(parse("unknown"),columns), std::out_of_range);
+	BOOST_CHECK_THROW(Program<>(Expression<>(st),columns), std::invalid_argument);
+	BOOST_CHECK_THROW(Program<>(layout,columns).evaluate(vector<vector<double>>(2,vector<double>(4))), std::invalid_argument);
+	BOOST_CHECK_THROW(Program<>(layout,columns).evaluate({{1,2},{1,2},{1}}), std::invalid_argument);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Affine_Solution_Batch_Evaluation)
+{
+	using namespace Eigen;
+	using BatchEvaluation::evaluate;
+
+	// x0 + 2c0 - c1 = 1/2, x1 - c0 = 0
+	Matrix<Rational,Dynamic,Dynamic> system(2,5);
+	system << 1,0,2,-1,Rational(1,2),
+			  0,1,-1,0,0;
+	auto solution = LinearSystem::semiSymbolicSolve(system,2);
+
+	for(size_t n : {0,1,15,16,17,50})
+	{
+		vector<vector<double>> parameters(2,vector<double>(n));
+		for(size_t k = 0 ; k < n ; ++k)
+		{
+			parameters[0][k] = 0.5*k;
+			parameters[1][k] = 3.0 - k;
+		} // end for
+
+		auto values = evaluate(std::get<0>(solution),std::get<1>(solution),parameters);
+		BOOST_REQUIRE_EQUAL(values.size(), 2u);
+		BOOST_REQUIRE_EQUAL(values[0].size(), n);
+		for(size_t k = 0 ; k < n ; ++k)
+		{
+			BOOST_CHECK_EQUAL(values[0][k], 0.5 - 2*parameters[0][k] + parameters[1][k]);
+			BOOST_CHECK_EQUAL(values[1][k], parameters[0][k]);
+		} // end for
+	} // end for
+
+	BOOST_CHECK_THROW(evaluate(std::get<0>(solution),std::get<1>(solution),vector<vector<double>>(1)), std::invalid_argument);
+	BOOST_CHECK_THROW(evaluate(std::get<0>(solution),std::get<1>(solution),vector<vector<double>>{{1},{}}), std::invalid_argument);
+} // end test case
@@ -0,0 +1,220 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gui model/journal.hpp"
+#include "gui model/model.hpp"
+#include "slot map.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include "eigen-rational interface code.hpp"
+
+#define BOOST_TEST_MODULE Journal
+#include <boost/test/included/unit_test.hpp>
+
+namespace
+{
+	using geometry::RectangleSide;
+	using GUIModel::Controls::Model;
+
+	// the state undo and redo should restore exactly, including handles and order.
+	struct State
+	{
+		vector<Model<int>::control_key_type> controlKeys;
+		vector<string> names;
+		vector<int> sides;
+		vector<Model<int>::constraint_key_type> constraintKeys;
+		vector<string> texts;
+		vector<int> constraintSides;
+
+		explicit State(const Model<int> &model)
+		{
+			for(auto control = model.controls.begin() ; control != model.controls.end() ; ++control)
+			{
+				controlKeys.push_back(model.controls.key(control));
+				names.push_back(control->name());
+				sides.insert(sides.end(),std::begin(control->sides()),std::end(control->sides()));
+			} // end for
+			for(auto constraint = model.constraints.begin() ; constraint != model.constraints.end() ; ++constraint)
+			{
+				constraintKeys.push_back(model.constraints.key(constraint));
+				texts.push_back(constraint->text());
+				constraintSides.insert(constraintSides.end(),std::begin(constraint->sides()),std::end(constraint->sides()));
+				for(const auto &endPoint : constraint->endPoints())
+					constraintSides.push_back(model.controls.position(endPoint.control));
+			} // end for
+		} // end State constructor
+
+		bool operator==(const State &other) const
+		{
+			return controlKeys == other.controlKeys && names == other.names && sides == other.sides
+				&& constraintKeys == other.constraintKeys && texts == other.texts && constraintSides == other.constraintSides;
+		} // end method operator==
+	}; // end struct State
+} // end unnamed namespace
+
+BOOST_AUTO_TEST_CASE(Test_Journal_Interaction)
+{
+	Model<int> model;
+	model.resize(0,0,400,300); // screen control becomes (10,10,390,265)
+	const State initial(model);
+
+	// creating and sizing a control is a single entry. (the event handlers' steps that need
+	// carets are emulated)
+	const auto control = model.controls.emplace_back(10,"control0",1,100,100,100,100);
+	model.indexControl(control);
+	(model.focusedControl = model.selectedControl = model.controls.find(control))->select().focus();
+	model.selectedPart = model.selectedControl->partUnderPoint(100,100);
+	model.journal.beginTextEdit(model);
+	model.journal.beginDrag(model,true);
+	model.lastX = 100;
+	model.lastY = 100;
+	model.mouseMove(120,110);
+	model.mouseMove(150,140);
+	BOOST_CHECK_EQUAL(model.journal.undoSize(), 0);
+	model.journal.endDrag(model);
+	model.selectedPart = nullptr;
+	BOOST_CHECK_EQUAL(model.controls[control].right(), 150);
+	BOOST_CHECK_EQUAL(model.journal.undoSize(), 1);
+
+	// typing is recorded when the control loses focus
+	model.controls[control].name() += "xy";
+	BOOST_CHECK_EQUAL(model.journal.undoSize(), 1);
+	model.unfocusAll();
+	BOOST_CHECK_EQUAL(model.journal.undoSize(), 2);
+	const State created(model);
+
+	// dragging the control's corner
+	model.selectedPart = model.controls[control].partUnderPoint(149,139);
+	model.journal.beginDrag(model);
+	model.lastX = 149;
+	model.lastY = 139;
+	model.mouseMove(170,180);
+	model.journal.endDrag(model);
+	model.deselectAll();
+	BOOST_CHECK_EQUAL(model.journal.undoSize(), 3);
+	const State dragged(model);
+	BOOST_CHECK(!(dragged == created));
+
+	BOOST_CHECK(model.undo());
+	BOOST_CHECK(State(model) == created);
+	BOOST_CHECK(model.undo());
+	BOOST_CHECK_EQUAL(model.controls[control].name(), "control0");
+	BOOST_CHECK(model.undo());
+	BOOST_CHECK(State(model) == initial);
+	BOOST_CHECK(!model.undo());
+	BOOST_CHECK(!model.controlGrid.contains(control.slot));
+
+	model.keyboardAscii(25,true,0,0); // Ctrl+Y
+	model.keyboardAscii(25,true,0,0);
+	model.keyboardAscii(25,true,0,0);
+	BOOST_CHECK(State(model) == dragged);
+	BOOST_CHECK(!model.redo());
+	model.mouseMove(165,175);
+	BOOST_CHECK(model.highlightedControl == model.controls.find(control));
+
+	model.keyboardAscii(26,true,0,0); // Ctrl+Z
+	BOOST_CHECK(State(model) == created);
+	BOOST_CHECK(model.journal.canRedo());
+
+	// a new edit discards the redo history
+	model.selectedControl = model.controls.find(control);
+	model.journal.beginDrag(model);
+	model.controls[control].left() -= 5;
+	model.journal.endDrag(model);
+	BOOST_CHECK(!model.journal.canRedo());
+	BOOST_CHECK_EQUAL(model.journal.undoSize(), 3);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Journal_Erasure)
+{
+	Model<int> model;
+	const auto control0 = model.controls.key(model.controls.begin());
+	const auto control1 = model.controls.emplace_back(10,"control1",1,20,20,80,80);
+	const auto control2 = model.controls.emplace_back(10,"control2",1,100,20,150,80);
+	model.controls.emplace_back(10,"control3",1,100,100,150,180);
+	const auto constraint0 = model.constraints.emplace_back(&model.controls,control1,RectangleSide::RIGHT,control2,RectangleSide::LEFT,85,90,"a",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::TOP,control1,RectangleSide::TOP,160,165,"b",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::LEFT,control2,RectangleSide::LEFT,10,15,"c",10);
+	const State initial(model);
+
+	// erasing a control erases its constraints in the same entry
+	model.eraseControl(model.controls.find(control1));
+	BOOST_CHECK_EQUAL(model.journal.undoSize(), 1);
+	BOOST_CHECK_EQUAL(model.constraints.size(), 1);
+	model.eraseConstraint(model.constraints.begin());
+	const State erased(model);
+
+	BOOST_CHECK(model.undo());
+	BOOST_CHECK(model.undo());
+	BOOST_CHECK(State(model) == initial);
+	BOOST_CHECK_EQUAL(model.attachedConstraints[control1.slot].size(), 2);
+	BOOST_CHECK_EQUAL(model.constraints[constraint0].endPoints()[0].referredControl().name(), "control1");
+	BOOST_CHECK_EQUAL(model.constraintGrid.size(), 3);
+
+	BOOST_CHECK(model.redo());
+	BOOST_CHECK(model.redo());
+	BOOST_CHECK(State(model) == erased);
+
+	// recycled slots don't revive erased handles
+	const auto control4 = model.controls.emplace_back(10,"control4",1,0,0,5,5);
+	BOOST_CHECK(control4 != control1);
+	BOOST_CHECK(!model.controls.contains(control1));
+
+	model.clear();
+	BOOST_CHECK(!model.journal.canUndo());
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Journal_Memory_Budget)
+{
+	using Key = Containers::SlotHandle<uint32_t>;
+	using Journal = GUIModel::Controls::Journal<int,string,Key,Key>;
+
+	Journal journal(4096);
+	BOOST_CHECK_EQUAL(journal.memoryBudget(), 4096);
+	BOOST_CHECK(!journal.canUndo());
+
+	for(int i = 0 ; i < 100 ; ++i)
+		journal.record(Journal::ControlNameChange{Key{0,0},0,string(),string(50,'x')});
+	BOOST_CHECK(journal.canUndo());
+	BOOST_CHECK_LE(journal.memoryUsage(), 4096);
+	BOOST_CHECK_LT(journal.undoSize(), 100);
+	const auto kept = journal.undoSize();
+
+	// a group is a single entry
+	journal.openGroup();
+	journal.record(Journal::ControlSideChange{Key{0,0},RectangleSide::LEFT,0,1});
+	journal.record(Journal::ControlSideChange{Key{0,0},RectangleSide::TOP,0,1});
+	journal.closeGroup();
+	BOOST_CHECK_LE(journal.undoSize(), kept);
+
+	journal.setMemoryBudget(0);
+	BOOST_CHECK(!journal.canUndo());
+	BOOST_CHECK_EQUAL(journal.memoryUsage(), 0);
+
+	journal.setMemoryBudget(1024);
+	journal.record(Journal::ControlSideChange{Key{0,0},RectangleSide::LEFT,0,1});
+	BOOST_CHECK_EQUAL(journal.undoSize(), 1);
+	journal.clear();
+	BOOST_CHECK(!journal.canUndo());
+	BOOST_CHECK_EQUAL(journal.memoryUsage(), 0);
+} // end test case
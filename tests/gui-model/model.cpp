@@ -18,9 +18,21 @@
 
 #include "gui model/model.hpp"
 
+#include <string>
+using std::string;
+
 #include <vector>
 using std::vector;
 
+#include <memory>
+#include <sstream>
+#include <fstream>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+
+#include "eigen-rational interface code.hpp"
+
 #include <boost/rational.hpp>
 
 #define BOOST_TEST_MODULE Model
@@ -35,61 +47,416 @@ BOOST_AUTO_TEST_CASE(Test_Constraint_Parser)
 	Model<int> model;
 
 	// TODO: revert to test only relative frame.
-	model.controls.emplace_back(10,"screen",1,0,0,100,100);
+	const auto control0 = model.controls.key(model.controls.begin());
+	const auto control1 = model.controls.emplace_back(10,"screen",1,0,0,100,100);
 	model.controls.emplace_back(10,"control1",1,20,20,80,80);
 	model.controls.emplace_back(10,"control2",1,0,0,50,50);
 
-	model.constraints.emplace_back(&model.controls,0,RectangleSide::LEFT,1,RectangleSide::LEFT,0,0,"2.3a + 2mm",10);
-	model.constraints.emplace_back(&model.controls,0,RectangleSide::RIGHT,1,RectangleSide::RIGHT,0,0,"2/3a + 3.55b + 2px + mm",10);
-	model.constraints.emplace_back(&model.controls,1,RectangleSide::LEFT,1,RectangleSide::RIGHT,0,0,"20.1px",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::LEFT,control1,RectangleSide::LEFT,0,0,"2.3a + 2mm",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::RIGHT,control1,RectangleSide::RIGHT,0,0,"2/3a + 3.55b + 2px + mm",10);
+	model.constraints.emplace_back(&model.controls,control1,RectangleSide::LEFT,control1,RectangleSide::RIGHT,0,0,"20.1px",10);
 
-	model.constraints.emplace_back(&model.controls,0,RectangleSide::BOTTOM,1,RectangleSide::BOTTOM,0,0,"0.03mm",10);
-	model.constraints.emplace_back(&model.controls,0,RectangleSide::TOP,1,RectangleSide::TOP,0,0,"1/2b",10);
-	model.constraints.emplace_back(&model.controls,1,RectangleSide::BOTTOM,1,RectangleSide::TOP,0,0,"c",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::BOTTOM,control1,RectangleSide::BOTTOM,0,0,"0.03mm",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::TOP,control1,RectangleSide::TOP,0,0,"1/2b",10);
+	model.constraints.emplace_back(&model.controls,control1,RectangleSide::BOTTOM,control1,RectangleSide::TOP,0,0,"c",10);
 
 	auto symbols = std::make_shared<Symbolic::Common::SymbolTable<>>();
-	vector<decltype(model.constraints.front().parse<Rational>(symbols))> results;
+	const vector<size_t> columns = {0,1,2,3}; // a, b, px, c
+	LinearSystem::SparseRows<Rational> rows;
 	for(auto constraint : model.constraints)
-		results.push_back(constraint.parse<Rational>(symbols));
+	{
+		rows.append(4,-LinearSystem::lower(constraint.expression<size_t,string>(symbols),columns,rows)); // move to rhs
+		rows.endRow();
+	} // end foreach
 
-	BOOST_CHECK_EQUAL(symbols->size(), 3);
+	BOOST_CHECK_EQUAL(symbols->size(), 4);
 	BOOST_CHECK(symbols->declared("a"));
 	BOOST_CHECK(symbols->declared("b"));
 	BOOST_CHECK(symbols->declared("c"));
 	BOOST_CHECK(!symbols->declared("d"));
 	BOOST_CHECK(!symbols->declared("mm"));
-	BOOST_CHECK(!symbols->declared("px"));
+	BOOST_CHECK(symbols->declared("px"));
 	BOOST_CHECK_EQUAL(symbols->id("a"), 0);
 	BOOST_CHECK_EQUAL(symbols->id("b"), 1);
-	BOOST_CHECK_EQUAL(symbols->id("c"), 2);
-
-	BOOST_CHECK_EQUAL(results.size(), 6);
-	BOOST_CHECK_EQUAL(results[0].varCoeff.size(), 1);
-	BOOST_CHECK_EQUAL(results[0].varCoeff[0], Rational(23,10));
-	BOOST_CHECK_EQUAL(results[0].rhsConstant, -2);
-	BOOST_CHECK_EQUAL(results[0].pxSizeCoeff, 0);
-
-	BOOST_CHECK_EQUAL(results[1].varCoeff.size(), 2);
-	BOOST_CHECK_EQUAL(results[1].varCoeff[0], Rational(2,3));
-	BOOST_CHECK_EQUAL(results[1].varCoeff[1], Rational(355,100));
-	BOOST_CHECK_EQUAL(results[1].rhsConstant, -1);
-	BOOST_CHECK_EQUAL(results[1].pxSizeCoeff, 2);
-
-	BOOST_CHECK_EQUAL(results[2].varCoeff.size(), 0);
-	BOOST_CHECK_EQUAL(results[2].rhsConstant, 0);
-	BOOST_CHECK_EQUAL(results[2].pxSizeCoeff, Rational(201,10));
-
-	BOOST_CHECK_EQUAL(results[3].varCoeff.size(), 0);
-	BOOST_CHECK_EQUAL(results[3].rhsConstant, -Rational(3,100));
-	BOOST_CHECK_EQUAL(results[3].pxSizeCoeff, 0);
-
-	BOOST_CHECK_EQUAL(results[4].varCoeff.size(), 1);
-	BOOST_CHECK_EQUAL(results[4].varCoeff[1], Rational(1,2));
-	BOOST_CHECK_EQUAL(results[4].rhsConstant, 0);
-	BOOST_CHECK_EQUAL(results[4].pxSizeCoeff, 0);
-
-	BOOST_CHECK_EQUAL(results[5].varCoeff.size(), 1);
-	BOOST_CHECK_EQUAL(results[5].varCoeff[2], 1);
-	BOOST_CHECK_EQUAL(results[5].rhsConstant, 0);
-	BOOST_CHECK_EQUAL(results[5].pxSizeCoeff, 0);
+	BOOST_CHECK_EQUAL(symbols->id("px"), 2);
+	BOOST_CHECK_EQUAL(symbols->id("c"), 3);
+
+	Eigen::Matrix<Rational,Eigen::Dynamic,Eigen::Dynamic> expected(6,5);
+	expected << Rational(23,10),0,0,0,-2,
+				Rational(2,3),Rational(355,100),2,0,-1,
+				0,0,Rational(201,10),0,0,
+				0,0,0,0,-Rational(3,100),
+				0,Rational(1,2),0,0,0,
+				0,0,0,1,0;
+	BOOST_CHECK_EQUAL(rows.toDense(5), expected);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Constraint_Expression)
+{
+	using geometry::RectangleSide;
+	using GUIModel::Controls::Model;
+
+	Model<int> model;
+	const auto control0 = model.controls.key(model.controls.begin());
+	model.controls.emplace_back(10,"screen",1,0,0,100,100);
+
+	const string texts[][2] = {
+		{"2.3a + 2mm", "23/10*a+2"},
+		{"2/3a + 3.55b + 2px + mm", "2/3*a+355/100*b+2*px+1"},
+		{"20.1px", "201/10*px"},
+		{" -a + -1/2 mm", "-a+-(1/2)"},
+		{"_x1", "_x1"},
+	}; // end texts initializer
+	auto symbols = std::make_shared<Symbolic::Common::SymbolTable<>>();
+	for(const auto &text : texts)
+	{
+		model.constraints.emplace_back(&model.controls,control0,RectangleSide::LEFT,control0,RectangleSide::RIGHT,0,0,text[0],10);
+		std::ostringstream out;
+		model.constraints.back().expression<size_t,string>(symbols).print1D(out);
+		BOOST_CHECK_EQUAL(out.str(), text[1]);
+	} // end foreach
+	BOOST_CHECK(!symbols->declared("mm"));
+
+	for(const string text : {"", "a +", "a b", "2", "1/a", "1.5.2a", "a - b", "99999999999999999999a"})
+	{
+		model.constraints.emplace_back(&model.controls,control0,RectangleSide::LEFT,control0,RectangleSide::RIGHT,0,0,text,10);
+		BOOST_CHECK_THROW(model.constraints.back().expression<size_t>(symbols), std::runtime_error);
+	} // end foreach
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_System_Matrix)
+{
+	using geometry::RectangleSide;
+	using Rational = boost::rational<long long>;
+	using GUIModel::Controls::Model;
+
+	Model<int> model;
+
+	const auto control0 = model.controls.key(model.controls.begin());
+	const auto control1 = model.controls.emplace_back(10,"screen",1,0,0,100,100);
+	const auto control2 = model.controls.emplace_back(10,"control1",1,20,20,80,80);
+	model.controls.emplace_back(10,"control2",1,0,0,50,50);
+
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::LEFT,control1,RectangleSide::LEFT,0,0,"2.3a + 2mm",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::RIGHT,control1,RectangleSide::RIGHT,0,0,"2/3a + 3.55b + 2px + mm",10);
+	model.constraints.emplace_back(&model.controls,control1,RectangleSide::LEFT,control1,RectangleSide::RIGHT,0,0,"20.1px",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::BOTTOM,control1,RectangleSide::BOTTOM,0,0,"0.03mm",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::TOP,control1,RectangleSide::TOP,0,0,"1/2b",10);
+	model.constraints.emplace_back(&model.controls,control1,RectangleSide::BOTTOM,control1,RectangleSide::TOP,0,0,"c",10);
+	model.constraints.emplace_back(&model.controls,control2,RectangleSide::TOP,control0,RectangleSide::TOP,0,0,"-2a + -1/2mm",10);
+
+	// control sides, then a, b, c, then screen width and height and pixel width and height, then rhs
+	Eigen::Matrix<Rational,Eigen::Dynamic,Eigen::Dynamic> expected(7,20);
+	expected << -1,0,0,0,0,0,0,0,0,0,0,0,Rational(23,10),0,0,0,0,0,0,-2,
+				0,0,-1,0,0,0,0,0,0,0,0,0,Rational(2,3),Rational(71,20),0,1,0,2,0,-1,
+				1,0,-1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,Rational(201,10),0,0,
+				0,-1,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,-Rational(3,100),
+				0,0,0,-1,0,0,0,0,0,0,0,0,0,Rational(1,2),0,0,1,0,0,0,
+				0,1,0,-1,0,0,0,0,0,0,0,0,0,0,1,0,0,0,0,0,
+				0,0,0,0,0,0,0,-1,0,0,0,0,-2,0,0,0,1,0,0,Rational(1,2);
+	BOOST_CHECK_EQUAL(model.generateSystemMatrix<Rational>(), expected);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Hit_Testing)
+{
+	using geometry::RectangleSide;
+	using GUIModel::Controls::Model;
+
+	Model<int> model;
+	model.resize(0,0,400,300); // screen control becomes (10,10,390,265)
+
+	const auto control0 = model.controls.key(model.controls.begin());
+	const auto control1 = model.controls.emplace_back(10,"control1",1,50,50,150,150);
+	const auto control2 = model.controls.emplace_back(10,"control2",1,200,100,100,200); // unordered sides
+	const auto control3 = model.controls.emplace_back(10,"control3",1,300,40,380,60);
+	model.constraints.emplace_back(&model.controls,control1,RectangleSide::LEFT,control2,RectangleSide::RIGHT,160,170,"a",10);
+	const auto constraint1 = model.constraints.emplace_back(&model.controls,control1,RectangleSide::BOTTOM,control3,RectangleSide::TOP,330,340,"b",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::LEFT,control3,RectangleSide::LEFT,45,55,"c",10);
+
+	// the index should reproduce the front-most item found by scanning constraints front to back,
+	// then controls back to front.
+	auto checkAgainstLinearScan = [&model]()
+	{
+		for(int x = 0 ; x <= 400 ; x += 3)
+			for(int y = 0 ; y <= 255 ; y += 3)
+			{
+				model.mouseMove(x,y);
+
+				auto constraint = std::find_if(model.constraints.begin(),model.constraints.end(),[x,y](const auto &c){return c.contains(x,y);});
+				BOOST_REQUIRE(model.highlightedConstraint == constraint);
+				if(constraint == model.constraints.end())
+				{
+					auto control = std::find_if(model.controls.rbegin(),model.controls.rend(),[x,y](const auto &c){return c.contains(x,y);});
+					BOOST_REQUIRE(model.highlightedControl == (control == model.controls.rend() ? model.controls.end() : --control.base()));
+				}
+				else
+					BOOST_REQUIRE(model.highlightedControl == model.controls.end());
+			} // end for
+	};
+
+	checkAgainstLinearScan();
+	model.mouseMove(120,120);
+	BOOST_CHECK(model.highlightedControl == model.controls.find(control2));
+	model.mouseMove(60,60);
+	BOOST_CHECK(model.highlightedControl == model.controls.find(control1));
+	model.mouseMove(340,50);
+	BOOST_CHECK(model.highlightedConstraint == model.constraints.find(constraint1));
+
+	// direct geometry changes require reindexing
+	model.controls[control1].left() += 150;
+	model.controls[control1].right() += 150;
+	model.reindexControl(control1);
+	model.updateAttachedConstraints(control1);
+	checkAgainstLinearScan();
+
+	model.eraseControl(model.controls.find(control2));
+	BOOST_CHECK_EQUAL(model.constraints.size(), 2);
+	checkAgainstLinearScan();
+
+	model.eraseConstraint(model.constraints.begin());
+	checkAgainstLinearScan();
+
+	// recycled slots are still stacked in insertion order
+	const auto control4 = model.controls.emplace_back(10,"control4",1,40,40,160,160);
+	model.clearControlIterators();
+	checkAgainstLinearScan();
+	model.mouseMove(60,60);
+	BOOST_CHECK(model.highlightedControl == model.controls.find(control4));
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Attached_Constraints)
+{
+	using geometry::RectangleSide;
+	using GUIModel::Controls::Model;
+
+	Model<int> model;
+	const auto control0 = model.controls.key(model.controls.begin());
+	const auto control1 = model.controls.emplace_back(10,"control1",1,20,20,80,80);
+	const auto control2 = model.controls.emplace_back(10,"control2",1,100,20,150,80);
+	const auto constraint0 = model.constraints.emplace_back(&model.controls,control1,RectangleSide::RIGHT,control2,RectangleSide::LEFT,85,90,"a",10);
+	const auto constraint1 = model.constraints.emplace_back(&model.controls,control1,RectangleSide::LEFT,control1,RectangleSide::RIGHT,10,15,"b",10);
+	const auto constraint2 = model.constraints.emplace_back(&model.controls,control0,RectangleSide::TOP,control2,RectangleSide::TOP,160,165,"c",10);
+	model.syncIndices();
+
+	using Keys = vector<Model<int>::constraint_key_type>;
+	BOOST_REQUIRE_EQUAL(model.attachedConstraints.size(), 3);
+	BOOST_CHECK(model.attachedConstraints[control0.slot] == Keys({constraint2}));
+	BOOST_CHECK(model.attachedConstraints[control1.slot] == Keys({constraint0,constraint1})); // constraint1 is listed once
+	BOOST_CHECK(model.attachedConstraints[control2.slot] == Keys({constraint0,constraint2}));
+
+	// only the attached constraints are updated
+	model.controls[control2].left() = 110;
+	model.controls[control2].top() = 90;
+	auto expected = model.constraints;
+	for(auto &constraint : expected)
+		constraint.updateSides();
+	auto unaffected = Model<int>::bounds(model.constraints[constraint1]);
+
+	model.updateAttachedConstraints(control2);
+	for(auto key : {constraint0,constraint1,constraint2})
+	{
+		auto actual = Model<int>::bounds(model.constraints[key]);
+		auto wanted = Model<int>::bounds(expected[key]);
+		BOOST_CHECK_EQUAL(actual.left(), wanted.left());
+		BOOST_CHECK_EQUAL(actual.bottom(), wanted.bottom());
+		BOOST_CHECK_EQUAL(actual.right(), wanted.right());
+		BOOST_CHECK_EQUAL(actual.top(), wanted.top());
+	} // end foreach
+	BOOST_CHECK_EQUAL(Model<int>::bounds(model.constraints[constraint1]).left(), unaffected.left());
+
+	model.clearControlIterators();
+	model.clearConstraintIterators();
+	model.eraseConstraint(model.constraints.find(constraint0));
+	BOOST_CHECK(model.attachedConstraints[control0.slot] == Keys({constraint2}));
+	BOOST_CHECK(model.attachedConstraints[control1.slot] == Keys({constraint1}));
+	BOOST_CHECK(model.attachedConstraints[control2.slot] == Keys({constraint2}));
+
+	// erasing a control erases its constraints without renumbering the others
+	model.eraseControl(model.controls.find(control1));
+	BOOST_CHECK(!model.controls.contains(control1));
+	BOOST_CHECK(!model.constraints.contains(constraint1));
+	BOOST_CHECK(model.constraints.contains(constraint2));
+	BOOST_CHECK(model.attachedConstraints[control1.slot].empty());
+	BOOST_CHECK(model.constraints[constraint2].endPoints()[1].control == control2);
+	BOOST_CHECK_EQUAL(model.controls.position(control2), 1);
+
+	model.clear();
+	BOOST_CHECK(model.attachedConstraints.empty());
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Save_Load)
+{
+	using geometry::RectangleSide;
+	using GUIModel::Controls::Model;
+
+	Model<int> model;
+	const auto control0 = model.controls.key(model.controls.begin());
+	const auto control1 = model.controls.emplace_back(10,"control1",1,20,20,80,80);
+	const auto control2 = model.controls.emplace_back(10,"control2",1,100,20,150,80);
+	const auto control3 = model.controls.emplace_back(10,"control3",1,100,100,150,180);
+	model.constraints.emplace_back(&model.controls,control2,RectangleSide::TOP,control3,RectangleSide::BOTTOM,120,130,"a",10);
+	model.constraints.emplace_back(&model.controls,control3,RectangleSide::LEFT,control1,RectangleSide::RIGHT,140,150,"b",10);
+	model.constraints.emplace_back(&model.controls,control0,RectangleSide::LEFT,control3,RectangleSide::RIGHT,160,170,"c",10);
+
+	// handles are saved as ordinal numbers of the remaining controls
+	model.eraseControl(model.controls.find(control2));
+	const string fileName = "model test.las";
+	model.save(fileName);
+
+	Model<int> loaded;
+	loaded.load(fileName);
+	std::remove(fileName.c_str());
+
+	BOOST_REQUIRE_EQUAL(loaded.controls.size(), 3);
+	BOOST_REQUIRE_EQUAL(loaded.constraints.size(), 2);
+	vector<string> names;
+	for(const auto &control : loaded.controls)
+		names.push_back(control.name());
+	BOOST_CHECK(names == vector<string>({"Screen","control1","control3"}));
+
+	auto constraint = loaded.constraints.begin();
+	BOOST_CHECK_EQUAL(constraint->text(), "b");
+	BOOST_CHECK_EQUAL(loaded.controls.position(constraint->endPoints()[0].control), 2);
+	BOOST_CHECK_EQUAL(loaded.controls.position(constraint->endPoints()[1].control), 1);
+	++constraint;
+	BOOST_CHECK_EQUAL(constraint->text(), "c");
+	BOOST_CHECK_EQUAL(loaded.controls.position(constraint->endPoints()[0].control), 0);
+	BOOST_CHECK_EQUAL(loaded.controls.position(constraint->endPoints()[1].control), 2);
+	BOOST_CHECK_EQUAL(constraint->endPoints()[1].referredControl().name(), "control3");
+	BOOST_CHECK_EQUAL(loaded.attachedConstraints[constraint->endPoints()[1].control.slot].size(), 2);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Invalidation)
+{
+	using GUIModel::Controls::Model;
+
+	Model<int> model;
+	BOOST_CHECK(model.invalidated());
+	model.resize(0,0,400,300); // screen control becomes (10,10,390,265)
+	const auto control1 = model.controls.emplace_back(10,"control1",1,50,50,150,150);
+	model.indexControl(control1);
+	model.validate();
+	BOOST_CHECK(!model.invalidated());
+
+	// moves that don't change what is highlighted don't need a redisplay
+	model.mouseMove(100,100);
+	BOOST_CHECK(model.invalidated());
+	model.validate();
+	model.mouseMove(101,102);
+	model.mouseMove(120,110);
+	BOOST_CHECK(!model.invalidated());
+	model.mouseMove(200,200);
+	BOOST_CHECK(model.invalidated());
+	model.validate();
+	model.mouseMove(210,200);
+	BOOST_CHECK(!model.invalidated());
+
+	// dragging does
+	model.selectedControl = model.controls.find(control1);
+	model.selectedPart = model.selectedControl->partUnderPoint(100,100);
+	model.lastX = 100;
+	model.lastY = 100;
+	model.mouseMove(100,100); // dehighlights
+	model.validate();
+	model.mouseMove(100,100);
+	BOOST_CHECK(!model.invalidated());
+	model.mouseMove(105,100);
+	BOOST_CHECK(model.invalidated());
+	model.validate();
+
+	model.keyboardAscii('a',true,0,0);
+	BOOST_CHECK(model.invalidated());
+	model.validate();
+	model.keyboardAscii('a',false,0,0);
+	model.keyboardNonAscii(graphene::Frames::Interface::NonAsciiKey::LEFT,false,0,0);
+	BOOST_CHECK(!model.invalidated()); // key releases change nothing
+
+	// releasing control only matters when it drops constraint end points
+	model.keyboardNonAscii(graphene::Frames::Interface::NonAsciiKey::L_CTRL,true,0,0);
+	model.validate();
+	model.keyboardNonAscii(graphene::Frames::Interface::NonAsciiKey::L_CTRL,false,0,0);
+	BOOST_CHECK(!model.invalidated());
+	model.keyboardNonAscii(graphene::Frames::Interface::NonAsciiKey::L_CTRL,true,0,0);
+	model.endPoint1 = model.selectedControl->partUnderPoint(100,100);
+	model.validate();
+	model.keyboardNonAscii(graphene::Frames::Interface::NonAsciiKey::L_CTRL,false,0,0);
+	BOOST_CHECK(model.invalidated());
+	BOOST_CHECK(!model.endPoint1);
+	model.validate();
+	model.resize(0,0,500,300);
+	BOOST_CHECK(model.invalidated());
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Load_Like_Property_Tree)
+{
+	using GUIModel::Controls::Model;
+
+	// the previous implementation of load, which went through a property tree
+	auto loadThroughTree = [](Model<int> &model, const string &fileName)
+	{
+		model.clear();
+		Model<int>::property_tree_type tree, emptyTree;
+		boost::property_tree::read_xml(fileName,tree);
+		for(const auto &control : tree.get_child("gui-model.controls"))
+			model.controls.emplace_back(control.second);
+		for(const auto &constraint : tree.get_child("gui-model.constraints",emptyTree))
+			model.constraints.emplace_back(constraint.second,&model.controls);
+		model.rebuildIndices();
+	};
+	auto message = [](const std::function<void()> &f) -> string
+	{
+		try { f(); } catch(std::exception &e) { return e.what(); }
+		return "";
+	};
+
+	const string control = "<control><sides><left>1</left><bottom>2</bottom><right>30</right><top>40</top></sides>"
+		"<borderSize>2</borderSize><name> a name </name><nameHeight>10</nameHeight></control>";
+	const string constraint = "<constraint><first-end-point><control>0</control><side>LEFT</side></first-end-point>"
+		"<second-end-point><control>1</control><side>RIGHT</side></second-end-point><first-local-side>5</first-local-side>"
+		"<second-local-side>12</second-local-side><text>2mm</text><text-height>7</text-height></constraint>";
+	auto replace = [](string text, const string &from, const string &to)
+	{
+		return text.replace(text.find(from),from.size(),to);
+	};
+	const vector<string> documents = {
+		"<gui-model><controls>" + control + control + "</controls><constraints>" + constraint + constraint + "</constraints></gui-model>",
+		"<!-- comment --><gui-model><controls>" + control + "<!-- comment -->" + control + "</controls></gui-model>",
+		"<gui-model><controls attribute='1'>" + control + "</controls></gui-model>",
+		"<gui-model><controls>" + replace(control,"30","3O") + "</controls></gui-model>",
+		"<gui-model><controls>" + replace(control,"<top>40</top>","") + "</controls></gui-model>",
+		"<gui-model><controls>" + control + "</controls><constraints>" + replace(constraint,"RIGHT","MIDDLE") + "</constraints></gui-model>",
+		"<gui-model><controls>" + control + "</controls><constraints>" + constraint + "</constraints></gui-model>",
+		"<gui-model><controls>" + control + "</controls><constraints>" + replace(constraint,"<control>1","<control>-1") + "</constraints></gui-model>",
+		"<gui-model><constraints/></gui-model>",
+		"<gui-model><controls>" + control,
+	};
+
+	const string fileName = "model load test.las";
+	for(const auto &document : documents)
+	{
+		std::ofstream(fileName) << document;
+		Model<int> expected, actual;
+		string expectedMessage = message([&]{loadThroughTree(expected,fileName);});
+		BOOST_CHECK_EQUAL(message([&]{actual.load(fileName);}), expectedMessage);
+		if(!expectedMessage.empty())
+			continue;
+
+		BOOST_REQUIRE_EQUAL(actual.controls.size(), expected.controls.size());
+		for(auto a = actual.controls.begin(), e = expected.controls.begin() ; a != actual.controls.end() ; ++a, ++e)
+		{
+			BOOST_CHECK_EQUAL(a->name(), e->name());
+			BOOST_CHECK(std::equal(std::begin(a->sides()),std::end(a->sides()),std::begin(e->sides())));
+			BOOST_CHECK_EQUAL(a->borderSize(), e->borderSize());
+			BOOST_CHECK_EQUAL(a->nameHeight(), e->nameHeight());
+		} // end for
+		BOOST_REQUIRE_EQUAL(actual.constraints.size(), expected.constraints.size());
+		for(auto a = actual.constraints.begin(), e = expected.constraints.begin() ; a != actual.constraints.end() ; ++a, ++e)
+		{
+			BOOST_CHECK_EQUAL(a->text(), e->text());
+			BOOST_CHECK(std::equal(std::begin(a->sides()),std::end(a->sides()),std::begin(e->sides())));
+			for(size_t i = 0 ; i < 2 ; ++i)
+				BOOST_CHECK(a->endPoints()[i].control == e->endPoints()[i].control && a->endPoints()[i].side == e->endPoints()[i].side);
+		} // end for
+	} // end foreach
+	std::remove(fileName.c_str());
 } // end test case
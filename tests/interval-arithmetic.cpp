@@ -0,0 +1,142 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "interval arithmetic.hpp"
+
+#include <map>
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <memory>
+#include <stdexcept>
+
+#include "linear system solving.hpp"
+#include "eigen-rational interface code.hpp"
+
+#include <boost/rational.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
+
+using Rational = boost::rational<long long int>;
+using BigRational = boost::multiprecision::cpp_rational;
+
+#define BOOST_TEST_MODULE Interval Arithmetic
+#include <boost/test/included/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(Test_Interval_Operations)
+{
+	using IntervalArithmetic::Interval;
+	using I = Interval<Rational>;
+
+	I a(Rational(-2),Rational(3));
+	I b(Rational(1,2),Rational(4));
+
+	BOOST_CHECK_EQUAL(a + b, I(Rational(-3,2),Rational(7)));
+	BOOST_CHECK_EQUAL(a - b, I(Rational(-6),Rational(5,2)));
+	BOOST_CHECK_EQUAL(-a, I(Rational(-3),Rational(2)));
+	BOOST_CHECK_EQUAL(a * b, I(Rational(-8),Rational(12)));
+	BOOST_CHECK_EQUAL(a * I(Rational(-2)), I(Rational(-6),Rational(4)));
+	BOOST_CHECK_EQUAL(a / b, I(Rational(-4),Rational(6)));
+	BOOST_CHECK_EQUAL(b.reciprocal(), I(Rational(1,4),Rational(2)));
+	BOOST_CHECK_THROW(a.reciprocal(), std::domain_error);
+	BOOST_CHECK_THROW(b / a, std::domain_error);
+	BOOST_CHECK_THROW(I(Rational(1),Rational(0)), std::invalid_argument);
+
+	// powers are tighter than repeated multiplication
+	BOOST_CHECK_EQUAL(a.power(2), I(Rational(0),Rational(9)));
+	BOOST_CHECK_EQUAL(a * a, I(Rational(-6),Rational(9)));
+	BOOST_CHECK_EQUAL(a.power(3), I(Rational(-8),Rational(27)));
+	BOOST_CHECK_EQUAL((-b).power(2), I(Rational(1,4),Rational(16)));
+	BOOST_CHECK_EQUAL(b.power(-2), I(Rational(1,16),Rational(4)));
+	BOOST_CHECK_EQUAL(a.power(0), I(Rational(1)));
+
+	BOOST_CHECK(a.contains(Rational(0)));
+	BOOST_CHECK(!b.contains(Rational(0)));
+	BOOST_CHECK(I(Rational(5)).isPoint());
+	BOOST_CHECK_EQUAL(a.width(), Rational(5));
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Evaluation)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	using IntervalArithmetic::Interval;
+	using IntervalArithmetic::evaluate;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	auto parse = [&st](const string &input){return Expression<>(input.begin(),input.end(),st);};
+	Expression<> pixels = parse("screenWidth/pixelWidth");
+	Expression<> square = parse("x^2 - 2.5");
+	Expression<> inverse = parse("1/x^(-1) + 2^3");
+	Expression<> big = parse("100000000000000000000*x");
+
+	// exact bounds with a map of big rationals
+	using B = Interval<BigRational>;
+	std::map<size_t,B> ranges;
+	ranges[st->id("screenWidth")] = B(300,3000);
+	ranges[st->id("pixelWidth")] = B(BigRational(1,10),BigRational(3,10));
+	ranges[st->id("x")] = B(-1,2);
+
+	BOOST_CHECK_EQUAL(evaluate<BigRational>(pixels,ranges), B(1000,30000));
+	BOOST_CHECK_EQUAL(evaluate<BigRational>(square,ranges), B(BigRational(-5,2),BigRational(3,2)));
+	BOOST_CHECK_EQUAL(evaluate<BigRational>(big,ranges), B(BigRational("-100000000000000000000"),BigRational("200000000000000000000")));
+	BOOST_CHECK_THROW(evaluate<BigRational>(inverse,ranges), std::domain_error); // 1/x with 0 in range
+
+	ranges[st->id("x")] = B(1,2);
+	BOOST_CHECK_EQUAL(evaluate<BigRational>(inverse,ranges), B(9,10));
+
+	// and with a vector of fixed-size rationals indexed by ID
+	using I = Interval<Rational>;
+	vector<I> fixedRanges(st->size());
+	fixedRanges[st->id("screenWidth")] = I(Rational(300),Rational(3000));
+	fixedRanges[st->id("pixelWidth")] = I(Rational(1,10),Rational(3,10));
+	fixedRanges[st->id("x")] = I(Rational(-1),Rational(2));
+
+	BOOST_CHECK_EQUAL(evaluate<Rational>(pixels,fixedRanges), I(Rational(1000),Rational(30000)));
+	BOOST_CHECK_EQUAL(evaluate<Rational>(square,fixedRanges), I(Rational(-5,2),Rational(3,2)));
+	BOOST_CHECK_THROW(evaluate<Rational>(big,fixedRanges), std::overflow_error);
+
+	// unsupported exponents and unknown variables
+	BOOST_CHECK_THROW(evaluate<BigRational>(parse("2^x"),ranges), std::domain_error);
+	BOOST_CHECK_THROW(evaluate<BigRational>(parse("2^0.5"),ranges), std::domain_error);
+	BOOST_CHECK_THROW(evaluate<BigRational>(parse("y"),ranges), std::out_of_range);
+	BOOST_CHECK_THROW(evaluate<BigRational>(Expression<>(st),ranges), std::logic_error);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Affine_Solution_Evaluation)
+{
+	using namespace Eigen;
+	using IntervalArithmetic::Interval;
+	using IntervalArithmetic::evaluate;
+	using I = Interval<Rational>;
+
+	// x0 + 2c0 - c1 = 1, x1 - c0 = 0
+	Matrix<Rational,Dynamic,Dynamic> system(2,5);
+	system << 1,0,2,-1,1,
+			  0,1,-1,0,0;
+	auto solution = LinearSystem::semiSymbolicSolve(system,2);
+
+	auto ranges = evaluate(std::get<0>(solution),std::get<1>(solution),{I(Rational(1),Rational(3)),I(Rational(-1,2),Rational(1,2))});
+	BOOST_REQUIRE_EQUAL(ranges.size(), 2u);
+	BOOST_CHECK_EQUAL(ranges[0], I(Rational(-11,2),Rational(-1,2)));
+	BOOST_CHECK_EQUAL(ranges[1], I(Rational(1),Rational(3)));
+
+	BOOST_CHECK_THROW(evaluate(std::get<0>(solution),std::get<1>(solution),{I(Rational(1))}), std::invalid_argument);
+} // end test case
@@ -0,0 +1,97 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "linear lowering.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <memory>
+#include <stdexcept>
+
+#include "eigen-rational interface code.hpp"
+
+#include <boost/rational.hpp>
+#include <boost/multiprecision/cpp_int.hpp>
+
+using Rational = boost::rational<long long int>;
+using BigRational = boost::multiprecision::cpp_rational;
+
+#define BOOST_TEST_MODULE Linear Lowering
+#include <boost/test/included/unit_test.hpp>
+
+BOOST_AUTO_TEST_CASE(Test_Linear_Lowering)
+{
+	using namespace LinearSystem;
+	using namespace Eigen;
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	auto parse = [&st](const string &input){return Expression<>(input.begin(),input.end(),st);};
+	Expression<> inputs[] = {
+		parse("2*a - 3*(b - 1/2*c) + 5"),
+		parse("(a + b)/4 - (a - b)*2^(-1) + 2^3"),
+		parse("-(a*3) + +b + 0.5*-c + a*(2-2)"),
+		parse("c^1 + 10"),
+	}; // end inputs initializer
+	vector<size_t> columns = {2,0,1}; // a, b, c -> columns
+
+	SparseRows<Rational> rows;
+	for(const auto &input : inputs)
+	{
+		rows.append(3,-lower(input,columns,rows)); // move the constant term to the right hand side
+		rows.endRow();
+	} // end foreach
+
+	Matrix<Rational,Dynamic,Dynamic> expected(4,4);
+	expected << -3,Rational(3,2),2,-5,
+				Rational(3,4),0,Rational(-1,4),-8,
+				1,Rational(-1,2),-3,0,
+				0,1,0,-10;
+	BOOST_CHECK_EQUAL(rows.toDense(4), expected);
+
+	// with big rationals and big literals
+	SparseRows<BigRational> bigRows;
+	BOOST_CHECK_EQUAL(lower(parse("100000000000000000000*a - 1/3"),columns,bigRows), BigRational(-1,3));
+	bigRows.endRow();
+	BOOST_CHECK_EQUAL(bigRows.row(0).first->second, BigRational("100000000000000000000"));
+	BOOST_CHECK_THROW(lower(parse("100000000000000000000*a"),columns,rows), std::overflow_error);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Nonlinear_Expressions)
+{
+	using namespace LinearSystem;
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	auto parse = [&st](const string &input){return Expression<>(input.begin(),input.end(),st);};
+	vector<size_t> columns = {0,1};
+	SparseRows<Rational> rows;
+
+	for(const string input : {"a*b", "1/a", "a/0", "a^2", "2^a", "2^0.5", "(a+b)*(a-b)"})
+	{
+		BOOST_CHECK_THROW(lower(parse(input),columns,rows), std::domain_error);
+		rows.endRow();
+	} // end foreach
+	BOOST_CHECK_THROW(lower(parse("c"),columns,rows), std::out_of_range); // no column for c
+} // end test case
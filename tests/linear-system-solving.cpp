@@ -360,3 +360,34 @@ BOOST_AUTO_TEST_CASE(Test_Linear_System_Solvers)
 		//BOOST_CHECK_EQUAL(semiSymbolicInvestigate(rowEchelon_d,semiSymNUnknowns[i]), semiSymProp_r[i]);
 	} // end for
 } // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Sparse_Rows)
+{
+	using namespace LinearSystem;
+	using namespace Eigen;
+
+	SparseRows<Rational> rows(3,8);
+	rows.append(3,Rational(1,2));
+	rows.append(0,2);
+	rows.append(3,Rational(1,2));
+	rows.endRow();
+	rows.endRow(); // empty row
+	rows.append(1,5);
+	rows.append(2,-1);
+	rows.append(1,-5); // cancels out
+	rows.endRow();
+
+	BOOST_CHECK_EQUAL(rows.rows(), 3);
+	BOOST_CHECK_EQUAL(rows.cols(), 4);
+	BOOST_CHECK_EQUAL(rows.size(), 3);
+	BOOST_CHECK_EQUAL(rows.row(0).second - rows.row(0).first, 2);
+	BOOST_CHECK_EQUAL(rows.row(0).first->first, 0); // sorted by column
+	BOOST_CHECK(rows.row(1).first == rows.row(1).second);
+
+	Matrix<Rational,Dynamic,Dynamic> expected(3,5);
+	expected << 2,0,0,1,0,
+				0,0,0,0,0,
+				0,0,-1,0,0;
+	BOOST_CHECK_EQUAL(rows.toDense(5), expected);
+	BOOST_CHECK_THROW(rows.toDense(3), std::out_of_range);
+} // end test case
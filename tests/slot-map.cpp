@@ -0,0 +1,187 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "slot map.hpp"
+using Containers::SlotMap;
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <memory>
+#include <iterator>
+#include <algorithm>
+
+#define BOOST_TEST_MODULE Slot Map
+#include <boost/test/included/unit_test.hpp>
+
+namespace
+{
+	template<typename Container>
+	vector<typename Container::value_type> contents(const Container &container)
+	{
+		return vector<typename Container::value_type>(container.begin(),container.end());
+	} // end function contents
+} // end unnamed namespace
+
+BOOST_AUTO_TEST_CASE(Test_Slot_Map_Operations)
+{
+	SlotMap<string> map;
+	BOOST_CHECK(map.empty());
+	BOOST_CHECK(map.begin() == map.end());
+
+	auto a = map.emplace_back("a");
+	auto b = map.push_back("b");
+	auto c = map.emplace_back(1,'c');
+	BOOST_CHECK_EQUAL(map.size(), 3);
+	BOOST_CHECK_EQUAL(map.slotCount(), 3);
+	BOOST_CHECK(contents(map) == vector<string>({"a","b","c"}));
+	BOOST_CHECK_EQUAL(map.front(), "a");
+	BOOST_CHECK_EQUAL(map.back(), "c");
+	BOOST_CHECK_EQUAL(map[b], "b");
+	BOOST_CHECK(vector<string>(map.rbegin(),map.rend()) == vector<string>({"c","b","a"}));
+
+	// iterators and handles survive erasure of other elements
+	auto itC = map.find(c);
+	auto next = map.erase(map.find(b));
+	BOOST_CHECK(next == itC);
+	BOOST_CHECK_EQUAL(*itC, "c");
+	BOOST_CHECK(!map.contains(b));
+	BOOST_CHECK(map.find(b) == map.end());
+	BOOST_CHECK_THROW(map.at(b), std::out_of_range);
+	BOOST_CHECK_EQUAL(map.erase(b), 0);
+	BOOST_CHECK(contents(map) == vector<string>({"a","c"}));
+
+	// freed slots are recycled with a new generation, but the order is insertion order
+	auto d = map.emplace_back("d");
+	BOOST_CHECK_EQUAL(d.slot, b.slot);
+	BOOST_CHECK(d != b);
+	BOOST_CHECK(!map.contains(b));
+	BOOST_CHECK_EQUAL(map.at(d), "d");
+	BOOST_CHECK(contents(map) == vector<string>({"a","c","d"}));
+	BOOST_CHECK_EQUAL(map.slotCount(), 3);
+	BOOST_CHECK(map.precedes(map.find(c),map.find(d)));
+	BOOST_CHECK(!map.precedes(map.find(d),map.find(a)));
+	BOOST_CHECK(map.fromSlot(d.slot) == map.find(d));
+	BOOST_CHECK(map.key(map.fromSlot(c.slot)) == c);
+	BOOST_CHECK(map.fromSlot(7) == map.end());
+
+	// dense positions
+	BOOST_CHECK_EQUAL(map.position(a), 0);
+	BOOST_CHECK_EQUAL(map.position(c), 1);
+	BOOST_CHECK_EQUAL(map.position(d), 2);
+	BOOST_CHECK(map.keyAt(2) == d);
+	BOOST_CHECK_THROW(map.keyAt(3), std::out_of_range);
+	BOOST_CHECK_THROW(map.position(b), std::out_of_range);
+	map.erase(a);
+	BOOST_CHECK_EQUAL(map.position(c), 0);
+	BOOST_CHECK(map.keyAt(1) == d);
+	BOOST_CHECK_EQUAL(Containers::position(map,d), 1);
+	BOOST_CHECK(Containers::keyAt(map,0) == c);
+
+	map.clear();
+	BOOST_CHECK(map.empty());
+	BOOST_CHECK(!map.contains(c));
+	BOOST_CHECK(!map.contains(d));
+	BOOST_CHECK(map.begin() == map.end());
+	auto e = map.emplace_back("e");
+	BOOST_CHECK(contents(map) == vector<string>({"e"}));
+	BOOST_CHECK(!map.contains(c) && !map.contains(d) && map.contains(e));
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Slot_Map_Move_Only_Values)
+{
+	SlotMap<std::unique_ptr<int>> map;
+	vector<SlotMap<std::unique_ptr<int>>::key_type> keys;
+	for(int i = 0 ; i < 100 ; ++i)
+		keys.push_back(map.emplace_back(new int(i)));
+
+	// erase every third element while iterating
+	for(auto element = map.begin() ; element != map.end() ; )
+		if(**element % 3 == 0)
+			element = map.erase(element);
+		else
+			++element;
+
+	BOOST_CHECK_EQUAL(map.size(), 66);
+	for(int i = 0 ; i < 100 ; ++i)
+		if(i % 3 == 0)
+			BOOST_CHECK(!map.contains(keys[i]));
+		else
+			BOOST_CHECK_EQUAL(*map[keys[i]], i);
+
+	int previous = -1;
+	for(const auto &element : map)
+	{
+		BOOST_CHECK_LT(previous, *element);
+		previous = *element;
+	} // end foreach
+	BOOST_CHECK_EQUAL(std::distance(map.cbegin(),map.cend()), 66);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Container_Key_Conversions)
+{
+	static_assert(std::is_same<Containers::ContainerKey<vector<int>>::type,size_t>::value, "vectors are keyed by position");
+	static_assert(std::is_same<Containers::ContainerKey<SlotMap<int>>::type,SlotMap<int>::key_type>::value, "slot maps are keyed by handle");
+
+	vector<int> v = {1,2,3};
+	BOOST_CHECK_EQUAL(Containers::position(v,2), 2);
+	BOOST_CHECK_EQUAL(Containers::keyAt(v,1), 1);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Slot_Map_Restore)
+{
+	SlotMap<string> map;
+	auto a = map.emplace_back("a");
+	auto b = map.emplace_back("b");
+	auto c = map.emplace_back("c");
+	auto sequenceB = map.sequence(map.find(b));
+	BOOST_CHECK_THROW(map.restore(b,sequenceB,map.end(),"x"), std::invalid_argument); // in use
+
+	// erase b, reuse its slot and then undo both in reverse order
+	map.erase(b);
+	auto d = map.emplace_back("d");
+	BOOST_REQUIRE_EQUAL(d.slot, b.slot);
+	auto sequenceD = map.sequence(map.find(d));
+	map.erase(d);
+	BOOST_CHECK_THROW(map.restore({d.slot,d.generation+1},0,map.end(),"x"), std::invalid_argument); // never issued
+	map.restore(b,sequenceB,map.find(c),"b");
+	BOOST_CHECK(contents(map) == vector<string>({"a","b","c"}));
+	BOOST_CHECK(map.contains(b) && !map.contains(d));
+	BOOST_CHECK(map.precedes(map.find(a),map.find(b)) && map.precedes(map.find(b),map.find(c)));
+	BOOST_CHECK_EQUAL(map.position(b), 1);
+
+	// redo: both handles can be restored again and new ones are never equal to them
+	map.erase(b);
+	map.restore(d,sequenceD,map.end(),"d");
+	BOOST_CHECK(contents(map) == vector<string>({"a","c","d"}));
+	BOOST_CHECK_EQUAL(map.at(d), "d");
+	map.erase(d);
+	auto e = map.emplace_back("e");
+	BOOST_CHECK(e != b && e != d);
+	BOOST_CHECK_EQUAL(map.slotCount(), 3);
+
+	// restoring at the front and the free list staying consistent
+	map.erase(a);
+	map.restore(a,0,map.begin(),"a");
+	BOOST_CHECK(contents(map) == vector<string>({"a","c","e"}));
+	map.emplace_back("f");
+	BOOST_CHECK_EQUAL(map.slotCount(), 4);
+} // end test case
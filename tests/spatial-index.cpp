@@ -0,0 +1,152 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "spatial index.hpp"
+using geometry::Rectangle;
+using geometry::UniformGrid;
+
+#include <vector>
+using std::vector;
+
+#include <random>
+#include <algorithm>
+
+#define BOOST_TEST_MODULE Spatial Index
+#include <boost/test/included/unit_test.hpp>
+
+namespace
+{
+	// The items of grid whose bounds contain (x,y), computed without the grid.
+	vector<size_t> linearScan(const UniformGrid<double> &grid, const vector<size_t> &items, double x, double y)
+	{
+		vector<size_t> result;
+		for(auto item : items)
+			if(grid.bounds(item).contains(x,y))
+				result.push_back(item);
+		std::sort(result.begin(),result.end());
+		return result;
+	} // end function linearScan
+
+	vector<size_t> query(const UniformGrid<double> &grid, double x, double y)
+	{
+		vector<size_t> result;
+		for(auto item : grid.candidates(x,y))
+			if(grid.bounds(item).contains(x,y))
+				result.push_back(item);
+		return result;
+	} // end function query
+} // end unnamed namespace
+
+BOOST_AUTO_TEST_CASE(Test_Uniform_Grid_Operations)
+{
+	UniformGrid<int> grid(10);
+	BOOST_CHECK(grid.empty());
+	BOOST_CHECK_EQUAL(grid.cellSize(), 10);
+	BOOST_CHECK_THROW(UniformGrid<int>(0), std::invalid_argument);
+
+	grid.insert(0,Rectangle<int>(0,0,25,25));
+	grid.insert(3,Rectangle<int>(35,15,5,5)); // unordered sides
+	grid.insert(1,Rectangle<int>(-15,-15,-5,-5));
+	BOOST_CHECK_EQUAL(grid.size(), 3);
+	BOOST_CHECK(grid.contains(3));
+	BOOST_CHECK(!grid.contains(2));
+	BOOST_CHECK(!grid.contains(7));
+	BOOST_CHECK_THROW(grid.insert(3,Rectangle<int>(0,0,1,1)), std::invalid_argument);
+	BOOST_CHECK_THROW(grid.bounds(2), std::out_of_range);
+	BOOST_CHECK_EQUAL(grid.bounds(3).left(), 5);
+	BOOST_CHECK_EQUAL(grid.bounds(3).right(), 35);
+	BOOST_CHECK_EQUAL(grid.bounds(3).bottom(), 5);
+	BOOST_CHECK_EQUAL(grid.bounds(3).top(), 15);
+
+	// candidates come in increasing index order
+	BOOST_CHECK(grid.candidates(12,12) == vector<size_t>({0,3}));
+	BOOST_CHECK(grid.candidates(32,12) == vector<size_t>({3}));
+	BOOST_CHECK(grid.candidates(-12,-12) == vector<size_t>({1}));
+	BOOST_CHECK(grid.candidates(-1,-1) == vector<size_t>({1}));
+	BOOST_CHECK(grid.candidates(100,100).empty());
+
+	grid.update(0,Rectangle<int>(100,100,105,105));
+	BOOST_CHECK(grid.candidates(12,12) == vector<size_t>({3}));
+	BOOST_CHECK(grid.candidates(101,101) == vector<size_t>({0}));
+	grid.update(0,Rectangle<int>(0,0,25,25));
+	BOOST_CHECK(grid.candidates(12,12) == vector<size_t>({0,3}));
+	BOOST_CHECK(grid.candidates(101,101).empty());
+
+	// erase leaves the other indices alone
+	grid.erase(0);
+	BOOST_CHECK_EQUAL(grid.size(), 2);
+	BOOST_CHECK(!grid.contains(0));
+	BOOST_CHECK(grid.candidates(12,12) == vector<size_t>({3}));
+	BOOST_CHECK(grid.candidates(-12,-12) == vector<size_t>({1}));
+	BOOST_CHECK(grid.candidates(2,22).empty());
+	BOOST_CHECK_THROW(grid.erase(0), std::out_of_range);
+	BOOST_CHECK_THROW(grid.update(0,Rectangle<int>(0,0,1,1)), std::out_of_range);
+	grid.insert(0,Rectangle<int>(20,20,21,21));
+	BOOST_CHECK(grid.candidates(22,22) == vector<size_t>({0}));
+
+	grid.clear();
+	BOOST_CHECK(grid.empty());
+	BOOST_CHECK(!grid.contains(1));
+	BOOST_CHECK(grid.candidates(12,12).empty());
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Uniform_Grid_Against_Linear_Scan)
+{
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> coordinate(-100,100);
+	std::uniform_real_distribution<double> extent(0,30);
+	std::uniform_int_distribution<int> operation(0,9);
+
+	UniformGrid<double> grid(7.5);
+	vector<size_t> items;
+	vector<size_t> freeItems;
+	for(size_t step = 0 ; step < 2000 ; ++step)
+	{
+		double x = coordinate(generator);
+		double y = coordinate(generator);
+		int op = operation(generator);
+		if(op < 4 || items.empty())
+		{
+			size_t item = items.size() + freeItems.size();
+			if(!freeItems.empty())
+			{
+				item = freeItems.back();
+				freeItems.pop_back();
+			} // end if
+			grid.insert(item,Rectangle<double>(x,y,x+extent(generator),y-extent(generator)));
+			items.push_back(item);
+		}
+		else
+		{
+			size_t position = std::uniform_int_distribution<size_t>(0,items.size()-1)(generator);
+			if(op < 8)
+				grid.update(items[position],Rectangle<double>(x,y,x-extent(generator),y+extent(generator)));
+			else
+			{
+				grid.erase(items[position]);
+				freeItems.push_back(items[position]);
+				items.erase(items.begin() + position);
+			} // end else
+		} // end else
+		BOOST_REQUIRE_EQUAL(grid.size(), items.size());
+
+		double qx = coordinate(generator);
+		double qy = coordinate(generator);
+		BOOST_REQUIRE(query(grid,qx,qy) == linearScan(grid,items,qx,qy));
+	} // end for
+} // end test case
@@ -21,6 +21,13 @@
 #include <string>
 using std::string;
 
+#include <vector>
+using std::vector;
+
+#include <thread>
+#include <algorithm>
+#include <stdexcept>
+
 #define BOOST_TEST_MODULE Symbol Table
 #include <boost/test/included/unit_test.hpp>
 
@@ -161,3 +168,480 @@ BOOST_AUTO_TEST_CASE(Test_Symbol_Table_Operations)
 	BOOST_CHECK(!st.declared(2));
 	BOOST_CHECK(!st.declared(-1));
 } // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Symbol_Table_Removal)
+{
+	using Symbolic::Common::SymbolTable;
+	using ST = SymbolTable<string,unsigned>;
+
+	const vector<string> names = {"a","b","c","d","e"};
+	ST st(names.begin(),names.end());
+	BOOST_CHECK_EQUAL(st.size(), 5);
+
+	// removing from the middle leaves holes
+	BOOST_CHECK_EQUAL(st.undeclare("b"), 1);
+	st.undeclare(3);
+	BOOST_CHECK_EQUAL(st.size(), 5);
+	BOOST_CHECK_EQUAL(st.declaredCount(), 3);
+	BOOST_CHECK(!st.declared("b"));
+	BOOST_CHECK(!st.declared(1));
+	BOOST_CHECK(!st.declared(3));
+	BOOST_CHECK(st.declared(4));
+	BOOST_CHECK_THROW(st.name(1), std::out_of_range);
+	BOOST_CHECK_THROW(st.undeclare(1), std::out_of_range);
+	BOOST_CHECK_THROW(st.undeclare("b"), std::out_of_range);
+	BOOST_CHECK_EQUAL(st.name(4), "e");
+	BOOST_CHECK_EQUAL(st.id("e"), 4);
+
+	// copies and moves keep the holes
+	ST cp = st;
+	BOOST_CHECK(!cp.declared(1));
+	BOOST_CHECK_EQUAL(cp.name(2), "c");
+	ST moved = std::move(cp);
+	BOOST_CHECK(!moved.declared(3));
+	BOOST_CHECK_EQUAL(moved.declare("x"), 1);
+	cp = moved;
+	BOOST_CHECK(!cp.declared(3));
+	BOOST_CHECK_EQUAL(cp.name(1), "x");
+
+	// holes are recycled smallest first
+	BOOST_CHECK_EQUAL(st.declare("f"), 1);
+	BOOST_CHECK_EQUAL(st.declare("a"), 0); // should have no effect
+	BOOST_CHECK_EQUAL(st.declare("g"), 3);
+	BOOST_CHECK_EQUAL(st.declare("h"), 5);
+	BOOST_CHECK_EQUAL(st.name(1), "f");
+	BOOST_CHECK_EQUAL(st.name(3), "g");
+	BOOST_CHECK_EQUAL(st.declaredCount(), 6);
+
+	// removing the last ID also removes the holes before it
+	st.undeclare(2);
+	st.undeclare(3);
+	st.undeclare(4);
+	BOOST_CHECK_EQUAL(st.size(), 6);
+	BOOST_CHECK_EQUAL(st.undeclare("h"), 5);
+	BOOST_CHECK_EQUAL(st.size(), 2);
+	BOOST_CHECK_EQUAL(st.declare("i"), 2);
+
+	// compaction renumbers in order and reports the mapping
+	st.undeclare(0);
+	st.declare("j");
+	st.declare("k");
+	st.undeclare("j");
+	BOOST_CHECK_EQUAL(st.size(), 4);
+	BOOST_CHECK(st.compact() == vector<unsigned>({ST::noID,0,1,2}));
+	BOOST_CHECK_EQUAL(st.size(), 3);
+	BOOST_CHECK_EQUAL(st.declaredCount(), 3);
+	BOOST_CHECK_EQUAL(st.name(0), "f");
+	BOOST_CHECK_EQUAL(st.name(1), "i");
+	BOOST_CHECK_EQUAL(st.name(2), "k");
+	BOOST_CHECK_EQUAL(st.id("k"), 2);
+	BOOST_CHECK_EQUAL(st.declare("l"), 3);
+
+	for(unsigned id = 0 ; id < 4 ; ++id)
+		st.undeclare(id);
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK_EQUAL(st.size(), 0);
+	BOOST_CHECK_EQUAL(st.declaredCount(), 0);
+	BOOST_CHECK_EQUAL(st.declare("a"), 0);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Concurrent_Symbol_Table_Operations)
+{
+	using Symbolic::Common::ConcurrentSymbolTable;
+
+	ConcurrentSymbolTable<string,unsigned char> st;
+
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(!st.declared("x"));
+	BOOST_CHECK(!st.declared(0));
+	BOOST_CHECK_EQUAL(st.declare("x"), 0);
+	BOOST_CHECK_EQUAL(st.declare("y"), 1);
+	BOOST_CHECK_EQUAL(st.declare("x"), 0);
+	BOOST_CHECK_EQUAL(st.size(), 2);
+	BOOST_CHECK(st.declared("y"));
+	BOOST_CHECK(st.declared(1));
+	BOOST_CHECK(!st.declared(2));
+	BOOST_CHECK_EQUAL(st.id("y"), 1);
+	BOOST_CHECK_EQUAL(st.name(0), "x");
+	BOOST_CHECK_THROW(st.id("z"), std::out_of_range);
+	BOOST_CHECK_THROW(st.name(2), std::out_of_range);
+
+	// spans several segments and runs out of IDs
+	for(size_t i = 2 ; i < 256 ; ++i)
+		BOOST_CHECK_EQUAL(st.declare("v" + std::to_string(i)), i);
+	for(size_t i = 2 ; i < 256 ; ++i)
+		BOOST_CHECK_EQUAL(st.name(i), "v" + std::to_string(i));
+	BOOST_CHECK_THROW(st.declare("overflow"), std::length_error);
+	BOOST_CHECK(!st.declared("overflow"));
+	BOOST_CHECK_EQUAL(st.size(), 256);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Concurrent_Symbol_Table_Threads)
+{
+	using Symbolic::Common::ConcurrentSymbolTable;
+
+	const size_t nThreads = 8;
+	const size_t nNames = 2000;
+	ConcurrentSymbolTable<> st;
+	vector<vector<size_t>> ids(nThreads,vector<size_t>(nNames));
+
+	// every thread declares the same names in a different order and reads back other threads' names
+	vector<std::thread> threads;
+	for(size_t t = 0 ; t < nThreads ; ++t)
+		threads.emplace_back([&st,&ids,t,nNames](){
+			for(size_t i = 0 ; i < nNames ; ++i)
+			{
+				size_t n = (i*7919 + t*104729) % nNames;
+				ids[t][n] = st.declare("name" + std::to_string(n));
+				for(size_t id = 0 , size = st.size() ; id < size ; id += 97)
+					if(st.name(id).compare(0,4,"name") != 0)
+						throw std::logic_error("corrupted name");
+			} // end for
+		});
+	for(auto &thread : threads)
+		thread.join();
+
+	BOOST_CHECK_EQUAL(st.size(), nNames);
+	vector<bool> used(nNames,false);
+	for(size_t n = 0 ; n < nNames ; ++n)
+	{
+		for(size_t t = 1 ; t < nThreads ; ++t)
+			BOOST_CHECK_EQUAL(ids[t][n], ids[0][n]);
+		BOOST_REQUIRE_LT(ids[0][n], nNames); // IDs are dense
+		BOOST_CHECK(!used[ids[0][n]]);
+		used[ids[0][n]] = true;
+		BOOST_CHECK_EQUAL(st.name(ids[0][n]), "name" + std::to_string(n));
+		BOOST_CHECK_EQUAL(st.id("name" + std::to_string(n)), ids[0][n]);
+	} // end for
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Interned_Symbol_Table_Operations)
+{
+	using Symbolic::Common::InternedSymbolTable;
+
+	InternedSymbolTable<string,unsigned> st;
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(!st.declared("x"));
+	BOOST_CHECK_THROW(st.id("x"), std::out_of_range);
+	BOOST_CHECK_THROW(st.name(0), std::out_of_range);
+
+	// enough names to grow the index several times
+	vector<string> names;
+	for(size_t i = 0 ; i < 1000 ; ++i)
+		names.push_back("x" + std::to_string(i));
+	for(size_t i = 0 ; i < names.size() ; ++i)
+		BOOST_CHECK_EQUAL(st.declare(names[i]), i);
+	BOOST_CHECK_EQUAL(st.size(), 1000);
+	BOOST_CHECK_EQUAL(st.declare("x500"), 500); // should have no effect
+	BOOST_CHECK_EQUAL(st.size(), 1000);
+	for(size_t i = 0 ; i < names.size() ; ++i)
+	{
+		BOOST_CHECK_EQUAL(st.id(names[i]), i);
+		BOOST_CHECK_EQUAL(st.name(i), names[i]);
+	} // end for
+	BOOST_CHECK(!st.declared("x1000"));
+	BOOST_CHECK(!st.declared(""));
+	BOOST_CHECK(st.declared(999));
+	BOOST_CHECK(!st.declared(1000));
+
+	// lookups and declarations from substrings of the input
+	string input = "x12+x999*newName";
+	BOOST_CHECK_EQUAL(st.declare(input.begin(),input.begin()+3), 12);
+	BOOST_CHECK_EQUAL(st.declare(input.begin()+4,input.begin()+8), 999);
+	BOOST_CHECK_EQUAL(st.id(InternedSymbolTable<>::view_type(input.data()+4,4)), 999);
+	BOOST_CHECK_EQUAL(st.declare(input.begin()+9,input.end()), 1000);
+	BOOST_CHECK_EQUAL(st.name(1000), "newName");
+
+	// copies don't alias
+	InternedSymbolTable<string,unsigned> cp = st;
+	BOOST_CHECK_EQUAL(cp.declare("other"), 1001);
+	BOOST_CHECK(!st.declared("other"));
+
+	// undeclaring in reverse keeps every remaining name reachable
+	BOOST_CHECK_THROW(st.undeclare(5), std::logic_error);
+	BOOST_CHECK_EQUAL(st.undeclare("newName"), 1000);
+	for(size_t i = names.size() ; i-- > 500 ;)
+		st.undeclare(i);
+	BOOST_CHECK_EQUAL(st.size(), 500);
+	for(size_t i = 0 ; i < names.size() ; ++i)
+		BOOST_CHECK_EQUAL(st.declared(names[i]), i < 500);
+	for(size_t i = 0 ; i < 500 ; ++i)
+		BOOST_CHECK_EQUAL(st.id(names[i]), i);
+	BOOST_CHECK_EQUAL(st.declare("x700"), 500);
+	BOOST_CHECK_EQUAL(st.name(500), "x700");
+
+	st.clear();
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(!st.declared("x0"));
+	BOOST_CHECK_EQUAL(st.declare("x0"), 0);
+
+	// the largest ID is reserved for empty slots
+	InternedSymbolTable<string,unsigned char> small;
+	for(size_t i = 0 ; i < 255 ; ++i)
+		small.declare(names[i]);
+	BOOST_CHECK_THROW(small.declare("y"), std::length_error);
+	BOOST_CHECK_EQUAL(small.id("x254"), 254);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Radix_Symbol_Table_Operations)
+{
+	using Symbolic::Common::RadixSymbolTable;
+	using IDs = vector<size_t>;
+
+	RadixSymbolTable<> st;
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(!st.declared("x"));
+	BOOST_CHECK_THROW(st.id("x"), std::out_of_range);
+	BOOST_CHECK(st.completions("").empty());
+
+	// names sharing prefixes in various ways split and extend edges
+	const vector<string> names = {"margin","marginLeft","mar","gap","marginRight","m","gapWidth","x","ma"};
+	for(size_t i = 0 ; i < names.size() ; ++i)
+		BOOST_CHECK_EQUAL(st.declare(names[i]), i);
+	BOOST_CHECK_EQUAL(st.declare("mar"), 2); // should have no effect
+	BOOST_CHECK_EQUAL(st.size(), names.size());
+	for(size_t i = 0 ; i < names.size() ; ++i)
+	{
+		BOOST_CHECK_EQUAL(st.id(names[i]), i);
+		BOOST_CHECK_EQUAL(st.name(i), names[i]);
+	} // end for
+	BOOST_CHECK(!st.declared("marg"));
+	BOOST_CHECK(!st.declared("marginL"));
+	BOOST_CHECK(!st.declared("marginLefts"));
+	BOOST_CHECK(!st.declared("g"));
+	BOOST_CHECK(!st.declared(""));
+
+	// completions are sorted by name
+	IDs all = {3,6,5,8,2,0,1,4,7};
+	BOOST_CHECK(st.completions("") == all);
+	BOOST_CHECK(st.completions("m") == IDs({5,8,2,0,1,4}));
+	BOOST_CHECK(st.completions("marg") == IDs({0,1,4}));
+	BOOST_CHECK(st.completions("margin") == IDs({0,1,4}));
+	BOOST_CHECK(st.completions("marginR") == IDs({4}));
+	BOOST_CHECK(st.completions("gapW") == IDs({6}));
+	BOOST_CHECK(st.completions("marx").empty());
+	BOOST_CHECK(st.completions("marginLeftX").empty());
+	BOOST_CHECK(st.completions("y").empty());
+	BOOST_CHECK(st.completions("m",2) == IDs({5,8}));
+
+	// copies don't alias
+	RadixSymbolTable<> cp = st;
+	BOOST_CHECK_EQUAL(cp.declare("marginTop"), 9);
+	BOOST_CHECK(!st.declared("marginTop"));
+	BOOST_CHECK(cp.completions("margin") == IDs({0,1,4,9}));
+
+	// undeclaring in reverse order restores the previous states
+	string input = "ma+m";
+	BOOST_CHECK_THROW(st.undeclare(0), std::logic_error);
+	BOOST_CHECK_EQUAL(st.undeclare("ma"), 8);
+	BOOST_CHECK_EQUAL(st.undeclare("x"), 7);
+	st.undeclare(6);
+	st.undeclare(5);
+	BOOST_CHECK(st.completions("") == IDs({3,2,0,1,4}));
+	BOOST_CHECK(st.completions("m") == IDs({2,0,1,4}));
+	BOOST_CHECK(!st.declared("m"));
+	BOOST_CHECK(!st.declared("gapWidth"));
+	BOOST_CHECK(st.declared("gap"));
+	st.undeclare(4);
+	st.undeclare(3);
+	st.undeclare(2);
+	BOOST_CHECK(st.completions("ma") == IDs({0,1}));
+	BOOST_CHECK_EQUAL(st.declare(input.begin(),input.begin()+2), 2);
+	BOOST_CHECK_EQUAL(st.declare(input.begin()+3,input.end()), 3);
+	BOOST_CHECK(st.completions("") == IDs({3,2,0,1}));
+
+	st.clear();
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(st.completions("").empty());
+	BOOST_CHECK_EQUAL(st.declare("margin"), 0);
+	BOOST_CHECK(st.completions("ma") == IDs({0}));
+
+	// many names and the largest ID reserved for nodes without symbols
+	RadixSymbolTable<string,unsigned char> small;
+	vector<string> many;
+	for(size_t i = 0 ; i < 255 ; ++i)
+	{
+		many.push_back("x" + std::to_string(i));
+		BOOST_CHECK_EQUAL(small.declare(many.back()), i);
+	} // end for
+	BOOST_CHECK_THROW(small.declare("x1000"), std::length_error);
+	BOOST_CHECK(!small.declared("x1000"));
+	BOOST_CHECK_EQUAL(small.completions("x1").size(), 111); // x1, x10-x19, x100-x199
+	for(size_t i = 0 ; i < many.size() ; ++i)
+		BOOST_CHECK_EQUAL(small.id(many[i]), i);
+	BOOST_CHECK(small.completions("x25") == vector<unsigned char>({25,250,251,252,253,254}));
+} // end test case
+
+namespace
+{
+	/** Makes every name collide, to exercise the lists at the bottom of hash tries.
+	 */
+	struct CollidingHash
+	{
+		size_t operator()(const string &name) const {return name.size() % 2;}
+	}; // end struct CollidingHash
+} // end unnamed namespace
+
+BOOST_AUTO_TEST_CASE(Test_Persistent_Symbol_Table)
+{
+	using Symbolic::Common::PersistentSymbolTable;
+
+	PersistentSymbolTable<> st;
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(!st.declared("x0"));
+	BOOST_CHECK_THROW(st.id("x0"), std::out_of_range);
+	BOOST_CHECK_THROW(st.name(0), std::out_of_range);
+
+	// enough names for three levels of the trie of names
+	vector<string> names;
+	for(size_t i = 0 ; i < 2000 ; ++i)
+		names.push_back("x" + std::to_string(i));
+	for(size_t i = 0 ; i < 1000 ; ++i)
+		BOOST_CHECK_EQUAL(st.declare(names[i]), i);
+	BOOST_CHECK_EQUAL(st.declare("x10"), 10); // should have no effect
+
+	// snapshots are unaffected by later changes of the original and vice versa
+	auto snapshot = st.snapshot();
+	for(size_t i = 1000 ; i < 2000 ; ++i)
+		BOOST_CHECK_EQUAL(st.declare(names[i]), i);
+	BOOST_CHECK_EQUAL(snapshot.declare("y"), 1000);
+	BOOST_CHECK_EQUAL(st.size(), 2000);
+	BOOST_CHECK_EQUAL(snapshot.size(), 1001);
+	BOOST_CHECK(!st.declared("y"));
+	BOOST_CHECK(!snapshot.declared("x1000"));
+	BOOST_CHECK_EQUAL(snapshot.name(1000), "y");
+	for(size_t i = 0 ; i < 2000 ; ++i)
+	{
+		BOOST_CHECK_EQUAL(st.id(names[i]), i);
+		BOOST_CHECK_EQUAL(st.name(i), names[i]);
+		if(i < 1000)
+			BOOST_CHECK_EQUAL(snapshot.name(i), names[i]);
+	} // end for
+
+	// undeclaring in reverse order, across the boundaries of subtrees
+	auto before = st;
+	BOOST_CHECK_THROW(st.undeclare(5), std::logic_error);
+	for(size_t i = 2000 ; i-- > 500 ;)
+		BOOST_CHECK_EQUAL(st.undeclare(names[i]), i);
+	BOOST_CHECK_EQUAL(st.size(), 500);
+	for(size_t i = 0 ; i < 2000 ; ++i)
+	{
+		BOOST_CHECK_EQUAL(st.declared(names[i]), i < 500);
+		BOOST_CHECK_EQUAL(before.id(names[i]), i);
+	} // end for
+	BOOST_CHECK_EQUAL(st.declare("z"), 500);
+	BOOST_CHECK_EQUAL(st.name(500), "z");
+	for(size_t i = 501 ; i-- > 0 ;)
+		st.undeclare(i);
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK_EQUAL(st.declare("x5"), 0);
+	BOOST_CHECK_EQUAL(before.size(), 2000);
+
+	st.clear();
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(!st.declared("x5"));
+
+	// colliding hashes
+	PersistentSymbolTable<string,unsigned,CollidingHash> colliding(names.begin(),names.begin()+100);
+	auto collidingSnapshot = colliding;
+	BOOST_CHECK_EQUAL(colliding.undeclare("x99"), 99);
+	BOOST_CHECK_EQUAL(colliding.undeclare("x98"), 98);
+	for(size_t i = 0 ; i < 100 ; ++i)
+	{
+		BOOST_CHECK_EQUAL(colliding.declared(names[i]), i < 98);
+		BOOST_CHECK_EQUAL(collidingSnapshot.id(names[i]), i);
+	} // end for
+	BOOST_CHECK(!colliding.declared("y"));
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Persistent_Symbol_Table_Threads)
+{
+	using Symbolic::Common::PersistentSymbolTable;
+
+	// readers check snapshots while the original keeps declaring names
+	PersistentSymbolTable<> st;
+	vector<std::thread> readers;
+	vector<size_t> nErrors(4,0);
+	for(size_t t = 0 ; t < 4 ; ++t)
+	{
+		for(size_t i = 0 ; i < 500 ; ++i)
+			st.declare("s" + std::to_string(t*500 + i));
+		readers.emplace_back([snapshot = st.snapshot(),&errors = nErrors[t]](){
+			for(size_t r = 0 ; r < 5 ; ++r)
+				for(size_t i = 0 ; i < snapshot.size() ; ++i)
+					if(snapshot.name(i) != "s" + std::to_string(i) || snapshot.id("s" + std::to_string(i)) != i)
+						++errors;
+		});
+	} // end for
+	for(size_t i = 0 ; i < 2000 ; ++i)
+		st.undeclare(st.size()-1);
+	for(auto &reader : readers)
+		reader.join();
+
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(nErrors == vector<size_t>(4,0));
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Scoped_Symbol_Table)
+{
+	using Symbolic::Common::ScopedSymbolTable;
+
+	ScopedSymbolTable<> st;
+	BOOST_CHECK_EQUAL(st.depth(), 0);
+	BOOST_CHECK_THROW(st.popScope(), std::logic_error);
+	BOOST_CHECK_EQUAL(st.declare("screenWidth"), 0);
+	BOOST_CHECK_EQUAL(st.declare("margin"), 1);
+
+	// names of enclosing scopes are visible until shadowed
+	st.pushScope("dialog");
+	BOOST_CHECK_EQUAL(st.depth(), 1);
+	BOOST_CHECK_EQUAL(st.declare("screenWidth"), 0);
+	BOOST_CHECK_EQUAL(st.declareLocal("margin"), 2);
+	BOOST_CHECK_EQUAL(st.declare("margin"), 2);
+	BOOST_CHECK_EQUAL(st.declareLocal("margin"), 2); // should have no effect
+	BOOST_CHECK_EQUAL(st.declare("gap"), 3);
+
+	st.pushScope("button");
+	BOOST_CHECK_EQUAL(st.id("margin"), 2);
+	BOOST_CHECK_EQUAL(st.declareLocal("margin"), 4);
+	BOOST_CHECK_EQUAL(st.id("margin"), 4);
+	BOOST_CHECK_EQUAL(st.qualifiedID({"dialog","margin"}), 2);
+	BOOST_CHECK_EQUAL(st.qualifiedID({"button","margin"}), 4);
+	BOOST_CHECK_EQUAL(st.qualifiedID({"dialog","button","margin"}), 4);
+	BOOST_CHECK_EQUAL(st.qualifiedName(4,"."), "dialog.button.margin");
+	BOOST_CHECK_EQUAL(st.qualifiedName(0,"."), "screenWidth");
+	st.popScope();
+
+	BOOST_CHECK_EQUAL(st.id("margin"), 2);
+	BOOST_CHECK_EQUAL(st.qualifiedID({"button","margin"}), 4); // popped scopes are still reachable
+	BOOST_CHECK_THROW(st.pushScope("button"), std::invalid_argument);
+	st.pushScope(); // unnamed scopes can be repeated
+	BOOST_CHECK_EQUAL(st.declareLocal("gap"), 5);
+	st.popScope();
+	st.pushScope();
+	BOOST_CHECK_EQUAL(st.id("gap"), 3);
+	st.popScope();
+	st.popScope();
+
+	BOOST_CHECK_EQUAL(st.depth(), 0);
+	BOOST_CHECK_EQUAL(st.id("margin"), 1);
+	BOOST_CHECK(!st.declared("gap"));
+	BOOST_CHECK_THROW(st.id("gap"), std::out_of_range);
+	BOOST_CHECK_EQUAL(st.qualifiedID({"dialog","gap"}), 3);
+	BOOST_CHECK_EQUAL(st.qualifiedID({"dialog","button","margin"}), 4);
+	BOOST_CHECK_THROW(st.qualifiedID({"button","margin"}), std::out_of_range);
+	BOOST_CHECK_THROW(st.qualifiedID({"dialog","screenWidth"}), std::out_of_range);
+	BOOST_CHECK_THROW(st.qualifiedID({"dialog","window","margin"}), std::out_of_range);
+	BOOST_CHECK_THROW(st.qualifiedID(vector<string>()), std::invalid_argument);
+
+	// IDs stay valid after their scopes are popped
+	BOOST_CHECK_EQUAL(st.size(), 6);
+	BOOST_CHECK_EQUAL(st.name(4), "margin");
+	BOOST_CHECK(st.declared(5));
+	BOOST_CHECK_EQUAL(st.declare("gap"), 6);
+
+	st.clear();
+	BOOST_CHECK(st.empty());
+	BOOST_CHECK(!st.declared("margin"));
+	BOOST_CHECK_EQUAL(st.depth(), 0);
+} // end test case
@@ -27,6 +27,16 @@ using std::ostringstream;
 #include <set>
 using std::set;
 
+#include <vector>
+using std::vector;
+
+#include <map>
+#include <cmath>
+#include <thread>
+#include <unordered_set>
+
+#include <stdexcept>
+
 #define BOOST_TEST_MODULE Symbolic Computation
 #include <boost/test/included/unit_test.hpp>
 
@@ -34,6 +44,7 @@ BOOST_AUTO_TEST_CASE(Test_Expression_Parser_And_Printers)
 {
 	using Symbolic::Common::SymbolTable;
 	using Symbolic::FreeForms::Expression;
+	namespace Parsers = Symbolic::FreeForms::Parsers;
 	using namespace Symbolic::DSEL;
 
 	// test DSEL, print methods and parser.
@@ -1411,5 +1422,650 @@ BOOST_AUTO_TEST_CASE(Test_Expression_Parser_And_Printers)
 		strout.str("");
 		parsedExpr.print2D(strout,false);
 		BOOST_CHECK_EQUAL(strout.str(), tests[i].minParen2D);
+
+		// test alternative parser
+		parsedExpr = Expression<>(tests[i].minParen1D.begin(),tests[i].minParen1D.end(),std::make_shared<SymbolTable<string,size_t>>(),Parsers::Spirit());
+		strout.str("");
+		parsedExpr.print1D(strout,true);
+		BOOST_CHECK_EQUAL(strout.str(), tests[i].fullParen1D);
+	} // end for
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Parser_Errors)
+{
+	using Symbolic::FreeForms::Expression;
+
+	// input consisting only of white space results in an empty expression
+	string input = " \t\n ";
+	BOOST_CHECK(Expression<>(input.begin(),input.end()).empty());
+
+	const string invalidInputs[] = {"x+", "(x", "x y", "x)", ")", "-", "x^", "x^-y", "x+*y", "a + (b * )", "2 $ 3"};
+	for(const auto &invalidInput : invalidInputs)
+		BOOST_CHECK_THROW(Expression<>(invalidInput.begin(),invalidInput.end()), std::runtime_error);
+
+	input = "a + (b * )";
+	BOOST_CHECK_EXCEPTION(Expression<>(input.begin(),input.end()), std::runtime_error, [](const std::runtime_error &error){
+		return error.what() == string("Parse error: \"a + (b * )\"!\n"
+									  "Here:         ---------^\n"
+									  "Expected a factor.\n");
+	});
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Parser_Invalid_Characters)
+{
+	using Symbolic::FreeForms::Expression;
+	namespace Parsers = Symbolic::FreeForms::Parsers;
+
+	// both text parsers skip invalid characters and should agree on what remains
+	const string inputs[] = {"x$+y", "a # * b", "$x", "(p&+q)^2", "1.5 + ~z", "3."};
+	for(const auto &input : inputs)
+	{
+		std::ostringstream spirit, pratt;
+		Expression<>(input.begin(),input.end(),std::make_shared<Expression<>::symbol_table_type>(),Parsers::Spirit()).print1D(spirit);
+		Expression<>(input.begin(),input.end(),std::make_shared<Expression<>::symbol_table_type>(),Parsers::Pratt()).print1D(pratt);
+		BOOST_CHECK_EQUAL(pratt.str(), spirit.str());
+		BOOST_CHECK_THROW(Expression<>(input.begin(),input.end(),std::make_shared<Expression<>::symbol_table_type>(),Parsers::StrictPratt()), std::runtime_error);
+	} // end for
+
+	// skipped characters are reported with any later error
+	string input = "x $+";
+	BOOST_CHECK_EXCEPTION(Expression<>(input.begin(),input.end()), std::runtime_error, [](const std::runtime_error &error){
+		return error.what() == string("Ignoring invalid character '$' in input!\n"
+									  "Parse error: \"x $+\"!\n"
+									  "Here:         ----^\n"
+									  "Expected a term.\n");
+	});
+	BOOST_CHECK_EXCEPTION(Expression<>(input.begin(),input.end(),std::make_shared<Expression<>::symbol_table_type>(),Parsers::StrictPratt()),
+			std::runtime_error, [](const std::runtime_error &error){
+		return error.what() == string("Parse error: \"x $+\"!\n"
+									  "Here:         --^\n"
+									  "Invalid character '$' in input!\n");
+	});
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Arbitrary_Precision_Literals)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	namespace Parsers = Symbolic::FreeForms::Parsers;
+	using namespace Symbolic::DSEL;
+
+	struct Test
+	{
+		string input;
+		string fullParen1D;
+		string minParen2D;
+	}; // end struct Test
+
+	const Test tests[] = {
+		{"18446744073709551615",              "(18446744073709551615)",                      "18446744073709551615\n"},
+		{"18446744073709551616",              "(18446744073709551616)",                      "18446744073709551616\n"},
+		{"123456789012345678901234567890*x",  "((123456789012345678901234567890)*(x))",      "123456789012345678901234567890*x\n"},
+		{"3.14159265358979323846264338327950", "((314159265358979323846264338327950)/(100000000000000000000000000000000))",
+											   "314159265358979323846264338327950\n"
+											   "_________________________________\n"
+											   "100000000000000000000000000000000\n"},
+		{"0.00000000000000000000001",         "((1)/(100000000000000000000000))",            "            1           \n"
+																							 "________________________\n"
+																							 "100000000000000000000000\n"},
+	}; // end tests initializer
+
+	for(const auto &test : tests)
+	{
+		ostringstream strout;
+		Expression<> pratt(test.input.begin(),test.input.end());
+		pratt.print1D(strout,true);
+		BOOST_CHECK_EQUAL(strout.str(), test.fullParen1D);
+		strout.str("");
+		pratt.print2D(strout,false);
+		BOOST_CHECK_EQUAL(strout.str(), test.minParen2D);
+
+		strout.str("");
+		Expression<> spirit(test.input.begin(),test.input.end(),std::make_shared<SymbolTable<string,size_t>>(),Parsers::Spirit());
+		spirit.print1D(strout,true);
+		BOOST_CHECK_EQUAL(strout.str(), test.fullParen1D);
+
+		// printed literals should parse back to the same expression
+		strout.str("");
+		pratt.print1D(strout,false);
+		string printed = strout.str();
+		strout.str("");
+		Expression<>(printed.begin(),printed.end()).print1D(strout,true);
+		BOOST_CHECK_EQUAL(strout.str(), test.fullParen1D);
+	} // end foreach
+
+	// construction from big values
+	ostringstream strout;
+	(Expression<>(Expression<>::big_uint_type("340282366920938463463374607431768211456")) + 1).print1D(strout);
+	BOOST_CHECK_EQUAL(strout.str(), "340282366920938463463374607431768211456+1");
+	strout.str("");
+	Expression<>(Expression<>::big_uint_type(42)).print1D(strout,true);
+	BOOST_CHECK_EQUAL(strout.str(), "(42)");
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Sharing)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	using namespace Symbolic::DSEL;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	Expression<> x("x",st), y("y",st);
+
+	// copies of empty expressions are empty
+	Expression<> empty;
+	BOOST_CHECK(Expression<>(empty).empty());
+
+	// copies are not affected by later changes to the original
+	Expression<> original = x + y;
+	Expression<> copy = original;
+	original = original * x;
+	ostringstream strout;
+	copy.print1D(strout);
+	BOOST_CHECK_EQUAL(strout.str(), "x+y");
+	strout.str("");
+	original.print1D(strout);
+	BOOST_CHECK_EQUAL(strout.str(), "(x+y)*x");
+
+	// building a long sum through the by-value DSEL operators
+	const size_t nTerms = 10000;
+	Expression<> sum = x;
+	for(size_t i = 1 ; i < nTerms ; ++i)
+		sum = sum + (i%2 ? y : x);
+	strout.str("");
+	sum.print1D(strout);
+	BOOST_CHECK_EQUAL(strout.str().size(), 2*nTerms-1);
+	BOOST_CHECK_EQUAL(strout.str().substr(0,7), "x+y+x+y");
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Deep_Expressions)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	using namespace Symbolic::DSEL;
+
+	// deep enough to overflow the stack of any recursive traversal
+	const size_t depth = 200000;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	Expression<> x("x",st), y("y",st);
+
+	// left-leaning chain built through the DSEL
+	Expression<> sum = x;
+	for(size_t i = 1 ; i < depth ; ++i)
+		sum = sum + y;
+	ostringstream strout;
+	sum.print1D(strout);
+	string sum1D = strout.str();
+	BOOST_CHECK_EQUAL(sum1D.size(), 2*depth-1);
+	strout.str("");
+	sum.print2D(strout);
+	BOOST_CHECK_EQUAL(strout.str().size(), 4*depth-3+1);
+	BOOST_CHECK_EQUAL(strout.str().substr(0,9), "x + y + y");
+
+	// the same chain parsed from text
+	strout.str("");
+	Expression<>(sum1D.begin(),sum1D.end(),st).print1D(strout);
+	BOOST_CHECK(strout.str() == sum1D);
+
+	// right-leaning chains of unary and binary operators
+	Expression<> negation = x;
+	Expression<> power = y;
+	for(size_t i = 1 ; i < depth ; ++i)
+	{
+		negation = -negation;
+		power = x ^ power;
 	} // end for
+	strout.str("");
+	negation.print1D(strout);
+	BOOST_CHECK(strout.str() == string(depth-1,'-') + "x");
+	strout.str("");
+	negation.print2D(strout,true);
+	BOOST_CHECK_EQUAL(strout.str().size(), (depth-1)*3+3+1);
+	strout.str("");
+	power.print1D(strout);
+	BOOST_CHECK_EQUAL(strout.str().size(), 2*depth-1);
+	BOOST_CHECK_EQUAL(strout.str().substr(2*depth-4), "x^y");
+
+	// destroying a subtree that is still shared must leave the other owner intact
+	Expression<> shared = sum;
+	sum = Expression<>();
+	strout.str("");
+	shared.print1D(strout);
+	BOOST_CHECK(strout.str() == sum1D);
+} // end test case
+
+namespace
+{
+	/** Evaluates expressions in double precision, with variables
+	 *	taking their values from a map.
+	 */
+	struct DoubleEvaluator
+	{
+		using result_type = double;
+
+		std::map<size_t,double> values;
+
+		double literal(unsigned long long int value) const {return value;}
+		double literal(const boost::multiprecision::cpp_int &value) const {return value.convert_to<double>();}
+		double variable(size_t id) const {return values.at(id);}
+
+		template<template<class> class Operator>
+		double unary(double child) const
+		{
+			return Operator<double>()(child);
+		} // end method unary
+
+		template<template<class> class Operator>
+		double binary(double left, double right) const
+		{
+			return apply(Operator<double>(),left,right);
+		} // end method binary
+
+		template<typename Operator>
+		static double apply(Operator op, double left, double right) {return op(left,right);}
+		static double apply(Symbolic::FreeForms::OpTags::bit_xor<double>, double left, double right) {return std::pow(left,right);}
+	}; // end struct DoubleEvaluator
+
+	/** Counts the nodes of each kind in an expression.
+	 */
+	struct NodeCounter
+	{
+		using result_type = size_t;
+
+		size_t nLeaves = 0;
+
+		template<typename T>
+		size_t literal(const T &) {++nLeaves; return 1;}
+		size_t variable(size_t) {++nLeaves; return 1;}
+
+		template<template<class> class Operator>
+		size_t unary(size_t child) const {return child + 1;}
+
+		template<template<class> class Operator>
+		size_t binary(size_t left, size_t right) const {return left + right + 1;}
+	}; // end struct NodeCounter
+} // end unnamed namespace
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Fold)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	string input = "-a*2.5 + b/(4-a)^2 - +100000000000000000000";
+	Expression<> expression(input.begin(),input.end(),st);
+
+	DoubleEvaluator evaluator;
+	evaluator.values[st->id("a")] = 2;
+	evaluator.values[st->id("b")] = 8;
+	BOOST_CHECK_CLOSE(expression.fold(evaluator), -5.0 + 2.0 - 1e20, 1e-12);
+
+	NodeCounter counter;
+	BOOST_CHECK_EQUAL(expression.fold(counter), 17u);
+	BOOST_CHECK_EQUAL(counter.nLeaves, 8u);
+
+	BOOST_CHECK_THROW(Expression<>().fold(counter), std::logic_error);
+
+	// folding must not recurse either
+	Expression<> sum(string("x"),st);
+	for(size_t i = 1 ; i < 200000 ; ++i)
+		sum = Expression<>::binaryCombine<Symbolic::FreeForms::OpTags::plus>(sum,Expression<>(string("x"),st));
+	BOOST_CHECK_EQUAL(sum.fold(NodeCounter()), 2*200000u-1);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Simplification)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+
+	struct Test
+	{
+		string input;
+		string simplified;
+	}; // end struct Test
+
+	const Test tests[] = {
+		{"2/4",             "1/2"},
+		{"x*1",             "x"},
+		{"1*x/1",           "x"},
+		{"0+x",             "x"},
+		{"x-0",             "x"},
+		{"0-x",             "-x"},
+		{"--x",             "x"},
+		{"+x",              "x"},
+		{"x*0",             "0"},
+		{"0/x",             "0"},
+		{"x+y*0-0*z",       "x"},
+		{"x+2+3",           "x+5"},
+		{"2+x+3",           "x+5"},
+		{"x-5+2",           "x-3"},
+		{"x--2",            "x+2"},
+		{"2*x*3",           "6*x"},
+		{"x/2/3",           "x/6"},
+		{"3.5*x",           "7*x/2"},
+		{"-x*-y",           "x*y"},
+		{"-x*y",            "-(x*y)"},
+		{"a-(b-c)",         "a-b+c"},
+		{"a-2*b",           "a-2*b"},
+		{"a-(-2)*b",        "a+2*b"},
+		{"-(x+1)",          "-x-1"},
+		{"x/(y/z)",         "x*z/y"},
+		{"1+2*3-4/2",       "5"},
+		{"0.25-1",          "-(3/4)"},
+		{"x^1",             "x"},
+		{"x^0",             "1"},
+		{"1^x",             "1"},
+		{"2^10",            "1024"},
+		{"(1/2)^(0-2)",     "4"},
+		{"x^(1+1)",         "x^2"},
+		{"2^100000",        "2^100000"},
+		{"x/0",             "x/0"},
+		{"x/(1-1)",         "x/0"},
+		{"0*(1/0)",         "0*(1/0)"},
+		{"x/0*0*y",         "0*(x/0)*y"},
+		{"0^(0-1)*0",       "0*0^(-1)"},
+		{"(1/0)^0",         "(1/0)^0"},
+		{"1^(2/0)",         "1^(2/0)"},
+		{"x/(0*(1/0))",     "x/(0*(1/0))"},
+		{"x/(0*0^(0-1))",   "x/(0*0^(-1))"},
+		{"x/(0*(y/0))",     "x/(0*(y/0))"},
+		{"100000000000000000000*100000000000000000000", "10000000000000000000000000000000000000000"},
+	}; // end tests initializer
+
+	for(const auto &test : tests)
+	{
+		auto st = std::make_shared<SymbolTable<string,size_t>>();
+		ostringstream strout;
+		Expression<>(test.input.begin(),test.input.end(),st).simplified().print1D(strout);
+		BOOST_CHECK_EQUAL(strout.str(), test.simplified);
+	} // end foreach
+
+	// simplification must preserve the value of expressions
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	string input = "(x*2 - (3*y - x)/4)/(0.5*z) + -(-x)*1 - z^2*(y+0)";
+	Expression<> expression(input.begin(),input.end(),st);
+	DoubleEvaluator evaluator;
+	evaluator.values[st->id("x")] = 1.5;
+	evaluator.values[st->id("y")] = -2;
+	evaluator.values[st->id("z")] = 3;
+	BOOST_CHECK_CLOSE(expression.simplified().fold(evaluator), expression.fold(evaluator), 1e-12);
+	BOOST_CHECK_LT(expression.simplified().fold(NodeCounter()), expression.fold(NodeCounter()));
+
+	// nor turn an undefined value into a defined one
+	input = "0*(x/0) + 0*(0^(0-y))";
+	Expression<> undefined(input.begin(),input.end(),st);
+	BOOST_CHECK(std::isnan(undefined.fold(evaluator)));
+	BOOST_CHECK(std::isnan(undefined.simplified().fold(evaluator)));
+
+	BOOST_CHECK(Expression<>().simplified().empty());
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Expression_Serialization)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	namespace Parsers = Symbolic::FreeForms::Parsers;
+
+	const string inputs[] = {
+		"x",
+		"0",
+		"18446744073709551615",
+		"123456789012345678901234567890*x",
+		"-a*2.5 + b/(4-a)^2 - +c",
+		"screenWidth/pixelWidth - (margin + gap)^2^a",
+	}; // end inputs initializer
+
+	for(const auto &input : inputs)
+	{
+		auto st = std::make_shared<SymbolTable<string,size_t>>();
+		st->declare("unused");
+		Expression<> original(input.begin(),input.end(),st);
+		ostringstream binary;
+		original.serialize(binary);
+		string data = binary.str();
+
+		// into a new symbol table
+		auto newSt = std::make_shared<SymbolTable<string,size_t>>();
+		Expression<> loaded(data.begin(),data.end(),newSt,Parsers::Binary());
+		ostringstream expected, actual;
+		original.print1D(expected,true);
+		loaded.print1D(actual,true);
+		BOOST_CHECK_EQUAL(actual.str(), expected.str());
+		BOOST_CHECK(!newSt->declared("unused")); // only referenced symbols are written
+		for(size_t id = 0 ; id < newSt->size() ; ++id)
+			BOOST_CHECK(st->declared(newSt->name(id)));
+
+		// serializing again must give the same bytes
+		ostringstream again;
+		loaded.serialize(again);
+		BOOST_CHECK(again.str() == data);
+
+		// into a symbol table with other symbols already declared
+		auto otherSt = std::make_shared<SymbolTable<string,size_t>>();
+		otherSt->declare("other");
+		otherSt->declare("x");
+		actual.str("");
+		Expression<>(data.begin(),data.end(),otherSt,Parsers::Binary()).print1D(actual,true);
+		BOOST_CHECK_EQUAL(actual.str(), expected.str());
+
+		// the binary format is more compact than text
+		BOOST_CHECK_LE(data.size(), 5 + 2 + 7 + input.size() + expected.str().size());
+
+		// truncated data must be rejected
+		for(size_t length = 0 ; length + 1 < data.size() ; ++length)
+			BOOST_CHECK_THROW(Expression<>(data.begin(),data.begin()+length,std::make_shared<SymbolTable<string,size_t>>(),Parsers::Binary()), std::runtime_error);
+	} // end foreach
+
+	// empty expressions
+	ostringstream binary;
+	Expression<>().serialize(binary);
+	string data = binary.str();
+	BOOST_CHECK(Expression<>(data.begin(),data.end(),std::make_shared<SymbolTable<string,size_t>>(),Parsers::Binary()).empty());
+
+	// corrupt data
+	const string corrupt[] = {
+		string("LAEY\x01\x00\x00",7),
+		string("LAEX\x02\x00\x00",7),
+		string("LAEX\x01\x00\x02\x00\x05\x00\x05",11),	// two roots
+		string("LAEX\x01\x00\x01\x05",8),				// missing operands
+		string("LAEX\x01\x00\x01\x02\x00",9),			// undeclared symbol
+		string("LAEX\x01\x00\x01\x0b",8),				// invalid opcode
+		string("LAEX\x01\x00\x01\x00\x05\x00",10),		// trailing data
+		string("LAEX\x01\x00\x01\x00\xff\xff\xff\xff\xff\xff\xff\xff\xff\x7f",17), // literal too large
+		string("LAEX\x01\xff\xff\xff\xff\x0f",10),		// too many symbols
+		string("LAEX\x01\x01\xff\xff\xff\xff\x0f",11),	// name too long
+		string("LAEX\x01\x00\x01\x01\xff\xff\xff\xff\x0f",13), // big literal too long
+	}; // end corrupt initializer
+	for(const auto &bytes : corrupt)
+	{
+		BOOST_CHECK_THROW(Expression<>(bytes.begin(),bytes.end(),std::make_shared<SymbolTable<string,size_t>>(),Parsers::Binary()), std::runtime_error);
+		std::istringstream in(bytes); // lengths can't be checked in advance with input iterators
+		BOOST_CHECK_THROW(Expression<>(std::istreambuf_iterator<char>(in),std::istreambuf_iterator<char>(),std::make_shared<SymbolTable<string,size_t>>(),Parsers::Binary()),
+			std::runtime_error);
+	} // end foreach
+
+	// names are declared once all of them are read, even if the expression after them is corrupt
+	auto partialSt = std::make_shared<SymbolTable<string,size_t>>();
+	data = string("LAEX\x01\x02\x01x\xff\xff\xff\xff\x0f",13);
+	BOOST_CHECK_THROW(Expression<>(data.begin(),data.end(),partialSt,Parsers::Binary()), std::runtime_error);
+	BOOST_CHECK(partialSt->empty());
+	data = string("LAEX\x01\x01\x01x\x01\x05",10);
+	BOOST_CHECK_THROW(Expression<>(data.begin(),data.end(),partialSt,Parsers::Binary()), std::runtime_error);
+	BOOST_CHECK(partialSt->declared("x"));
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Concurrent_Parsing)
+{
+	using Symbolic::Common::ConcurrentSymbolTable;
+	using Expression = Symbolic::FreeForms::Expression<unsigned long long int,string,size_t,ConcurrentSymbolTable<>>;
+	using namespace Symbolic::DSEL;
+
+	const string inputs[] = {
+		"screenWidth/pixelWidth - (margin + gap)^2",
+		"-a*2.5 + b/(4-a)^2 - +c",
+		"margin + x1 + x2 + x3",
+		"gap*x3 - x2/a",
+	}; // end inputs initializer
+	const size_t nThreads = 4;
+	const size_t nRepetitions = 200;
+
+	auto st = std::make_shared<ConcurrentSymbolTable<>>();
+	vector<vector<string>> outputs(nThreads);
+	vector<std::thread> threads;
+	for(size_t t = 0 ; t < nThreads ; ++t)
+		threads.emplace_back([&,t](){
+			for(size_t r = 0 ; r < nRepetitions ; ++r)
+			{
+				const string &input = inputs[(r+t) % 4];
+				Expression expression(input.begin(),input.end(),st);
+				ostringstream out;
+				(expression + Expression("x" + std::to_string(r % 10),st)).print1D(out);
+				outputs[t].push_back(out.str());
+			} // end for
+		});
+	for(auto &thread : threads)
+		thread.join();
+
+	BOOST_CHECK_EQUAL(st->size(), 17);
+	for(size_t t = 0 ; t < nThreads ; ++t)
+		for(size_t r = 0 ; r < nRepetitions ; ++r)
+		{
+			const string &input = inputs[(r+t) % 4];
+			ostringstream expected;
+			Expression(input.begin(),input.end(),st).print1D(expected);
+			BOOST_CHECK_EQUAL(outputs[t][r], expected.str() + "+x" + std::to_string(r % 10));
+		} // end for
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Interned_Symbol_Table_Parsing)
+{
+	using Symbolic::Common::InternedSymbolTable;
+	using Expression = Symbolic::FreeForms::Expression<unsigned long long int,string,size_t,InternedSymbolTable<>>;
+	using Symbolic::FreeForms::Parsers::Spirit;
+	using Symbolic::FreeForms::Parsers::Pratt;
+	using Symbolic::FreeForms::Parsers::Binary;
+
+	auto st = std::make_shared<InternedSymbolTable<>>();
+	string input = "screenWidth/pixelWidth - (margin + gap)^2*margin";
+	Expression pratt(input.begin(),input.end(),st,Pratt());
+	Expression spirit(input.begin(),input.end(),st,Spirit());
+	BOOST_CHECK_EQUAL(st->size(), 4);
+	BOOST_CHECK_EQUAL(st->id("margin"), 2);
+
+	ostringstream prattOut, spiritOut, expected;
+	pratt.print1D(prattOut);
+	spirit.print1D(spiritOut);
+	Symbolic::FreeForms::Expression<>(input.begin(),input.end()).print1D(expected);
+	BOOST_CHECK_EQUAL(prattOut.str(), expected.str());
+	BOOST_CHECK_EQUAL(spiritOut.str(), expected.str());
+
+	ostringstream out2D, expected2D;
+	pratt.print2D(out2D);
+	Symbolic::FreeForms::Expression<>(input.begin(),input.end()).print2D(expected2D);
+	BOOST_CHECK_EQUAL(out2D.str(), expected2D.str());
+
+	ostringstream binary;
+	pratt.serialize(binary);
+	string serialized = binary.str();
+	auto newSt = std::make_shared<InternedSymbolTable<>>();
+	ostringstream roundTrip;
+	Expression(serialized.begin(),serialized.end(),newSt,Binary()).print1D(roundTrip);
+	BOOST_CHECK_EQUAL(roundTrip.str(), expected.str());
+	BOOST_CHECK_EQUAL(newSt->size(), 4);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Scoped_Parsing)
+{
+	using Symbolic::Common::ScopedSymbolTable;
+	using Expression = Symbolic::FreeForms::Expression<unsigned long long int,string,size_t,ScopedSymbolTable<>>;
+	using Symbolic::FreeForms::Parsers::Pratt;
+
+	auto st = std::make_shared<ScopedSymbolTable<>>();
+	auto parse = [&st](const string &input){return Expression(input.begin(),input.end(),st,Pratt());};
+	Expression outer = parse("screenWidth - 2*margin");
+
+	// the same formula refers to a different margin inside a module that declares its own
+	st->pushScope("toolbar");
+	st->declareLocal("margin");
+	Expression inner = parse("screenWidth - 2*margin");
+	st->popScope();
+
+	BOOST_CHECK_EQUAL(st->size(), 3);
+	ostringstream outerOut, innerOut;
+	outer.print1D(outerOut);
+	inner.print1D(innerOut);
+	BOOST_CHECK_EQUAL(outerOut.str(), innerOut.str());
+
+	auto variables = [](const Expression &expression){
+		return Symbolic::CanonicalForms::toPolynomial(expression).getVariables();};
+	BOOST_CHECK(variables(outer) == vector<size_t>({0,1}));
+	BOOST_CHECK(variables(inner) == vector<size_t>({0,st->qualifiedID({"toolbar","margin"})}));
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Polynomial_Canonical_Form)
+{
+	using Symbolic::Common::SymbolTable;
+	using Symbolic::FreeForms::Expression;
+	using Symbolic::CanonicalForms::Polynomial;
+	using Symbolic::CanonicalForms::toPolynomial;
+
+	auto st = std::make_shared<SymbolTable<string,size_t>>();
+	st->declare("x");
+	st->declare("y");
+	auto canonical = [&st](const string &input){return toPolynomial(Expression<>(input.begin(),input.end(),st));};
+	auto print = [&st](const Polynomial<> &polynomial){ostringstream out; polynomial.print(out,*st); return out.str();};
+
+	// expressions with the same canonical form, in that form
+	const vector<vector<string>> classes = {
+		{"x^2+2*x*y+y^2", "(x+y)^2", "y*y + x*(2*y + x)", "(x+y)*(y+x) + 0*z"},
+		{"x^2-1", "(x+1)*(x-1)", "x*x - 2^0"},
+		{"y", "x - x + y", "-(-y)", "+y^1"},
+		{"1/4*x", "0.5*x/2", "x*2^(-2)", "x/4 + 0*y"},
+		{"24", "2^10 - 1000", "(x+1)^2 - x^2 - 2*x + 23"},
+		{"-x^3+x*y^2-y^2", "(y - x)*(y + x)*x - y^2"},
+		{"0", "x - x", "(x+y)^2 - (x^2+2*x*y+y^2)"},
+	}; // end classes initializer
+
+	std::unordered_set<Polynomial<>,std::function<size_t(const Polynomial<> &)>> distinct(0,[](const Polynomial<> &p){return p.hash();});
+	for(const auto &equivalent : classes)
+	{
+		Polynomial<> expected = canonical(equivalent[1]);
+		BOOST_CHECK_EQUAL(print(expected), equivalent[0]);
+		for(const auto &input : equivalent)
+		{
+			Polynomial<> actual = canonical(input);
+			BOOST_CHECK(actual == expected);
+			BOOST_CHECK_EQUAL(actual.hash(), expected.hash());
+			distinct.insert(actual);
+		} // end foreach
+	} // end foreach
+	BOOST_CHECK_EQUAL(distinct.size(), classes.size());
+
+	// structure
+	Polynomial<> p = canonical("3*x^2*y - x + 5");
+	BOOST_CHECK_EQUAL(p.size(), 3);
+	BOOST_CHECK_EQUAL(p.degree(), 3);
+	BOOST_REQUIRE_EQUAL(p.getVariables().size(), 2);
+	BOOST_CHECK_EQUAL(p.exponent(0,0), 2);
+	BOOST_CHECK_EQUAL(p.exponent(0,1), 1);
+	BOOST_CHECK_EQUAL(p.coefficient(1), -1);
+	BOOST_CHECK(canonical("x - x + y").getVariables() == vector<size_t>{st->id("y")});
+	BOOST_CHECK(canonical("x - x").isZero());
+	BOOST_CHECK(canonical("2^3").isConstant());
+	BOOST_CHECK(p - p == Polynomial<>());
+	BOOST_CHECK(p * Polynomial<>(2) == p + p);
+	BOOST_CHECK(p.power(3) == p*p*p);
+
+	// with fixed-size rationals
+	using SmallPolynomial = Polynomial<boost::rational<long long int>,size_t,unsigned char>;
+	auto small = [&st](const string &input){return toPolynomial<boost::rational<long long int>,unsigned char>(Expression<>(input.begin(),input.end(),st));};
+	BOOST_CHECK(small("(x+y)^2") == small("y*y + x*(2*y + x)"));
+	BOOST_CHECK_EQUAL(small("(x+y)^2").hash(), small("y*y + x*(2*y + x)").hash());
+	BOOST_CHECK(small("x/4") != SmallPolynomial::variable(st->id("x")));
+	BOOST_CHECK_THROW(small("x^200*x^100"), std::overflow_error);
+
+	// not polynomials
+	for(const string input : {"1/x", "x^y", "x^0.5", "x^(-1)", "1/(x-x)", "0^(-1)"})
+		BOOST_CHECK_THROW(canonical(input), std::domain_error);
 } // end test case
@@ -0,0 +1,150 @@
+//	Copyright (C) 2014, 2018 Vaptistis Anogeianakis <nomad@cornercase.gr>
+/*
+ *	This file is part of LostArt.
+ *
+ *	LostArt is free software: you can redistribute it and/or modify
+ *	it under the terms of the GNU General Public License as published by
+ *	the Free Software Foundation, either version 3 of the License, or
+ *	(at your option) any later version.
+ *
+ *	LostArt is distributed in the hope that it will be useful,
+ *	but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *	GNU General Public License for more details.
+ *
+ *	You should have received a copy of the GNU General Public License
+ *	along with LostArt.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "xml reader.hpp"
+
+#include <string>
+using std::string;
+
+#include <vector>
+using std::vector;
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+#define BOOST_TEST_MODULE XML Reader
+#include <boost/test/included/unit_test.hpp>
+
+namespace
+{
+	const string fileName = "xml reader test.xml";
+
+	void write(const string &text)
+	{
+		std::ofstream(fileName) << text;
+	} // end function write
+
+	// Lists the names and data of all nodes in preorder, with their depths.
+	string dump(const boost::property_tree::ptree &tree, const string &name = "", size_t depth = 0)
+	{
+		string result = string(depth,' ') + name + "=" + tree.data() + "\n";
+		for(const auto &child : tree)
+			result += dump(child.second,child.first,depth+1);
+		return result;
+	} // end function dump
+
+	string dump(const XML::Element &element, size_t depth = 0)
+	{
+		string result = string(depth,' ') + (depth ? element.name() : "") + "=" + element.data() + "\n";
+		for(const auto &child : element)
+			result += dump(child,depth+1);
+		return result;
+	} // end function dump
+
+	// Returns the message of the exception thrown by f, or "" if none is thrown.
+	string message(const std::function<void()> &f)
+	{
+		try
+		{
+			f();
+		}
+		catch(std::exception &e)
+		{
+			return e.what();
+		} // end catch
+		return "";
+	} // end function message
+} // end unnamed namespace
+
+BOOST_AUTO_TEST_CASE(Test_Same_Nodes_As_Property_Tree)
+{
+	const vector<string> documents = {
+		"<a><b>1</b><c>text</c></a>",
+		"<!-- leading --><a x='1' y=\"2\">\n\t<b> 1 </b>\n\t<!-- inner -->\n\t<b>second</b>mixed<![CDATA[<cdata>]]>text<c/></a>",
+		"<a><b>&lt;&amp;&gt;&#65;</b><b attribute='&quot;'/></a>",
+		"<?xml version=\"1.0\" encoding=\"utf-8\"?>\n<gui-model><controls><control><sides><left>10</left></sides></control></controls></gui-model>",
+	};
+
+	for(const auto &document : documents)
+	{
+		write(document);
+		boost::property_tree::ptree tree;
+		boost::property_tree::read_xml(fileName,tree);
+		XML::Document parsed(fileName);
+		BOOST_CHECK_EQUAL(dump(parsed.root()), dump(tree));
+	} // end foreach
+	std::remove(fileName.c_str());
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Same_Values_And_Errors_As_Property_Tree)
+{
+	write("<a x='7'><b>1</b><b>2</b><c> 3.5 </c><d>1x</d><e></e><f>-2</f><g>true</g><!--c--></a>");
+	boost::property_tree::ptree tree;
+	boost::property_tree::read_xml(fileName,tree);
+	XML::Document document(fileName);
+	auto root = document.root();
+	std::remove(fileName.c_str());
+
+	BOOST_CHECK_EQUAL(root.get<int>("a.b"), tree.get<int>("a.b")); // first of many
+	BOOST_CHECK_EQUAL(root.get<float>("a.c"), tree.get<float>("a.c"));
+	BOOST_CHECK_EQUAL(root.get<string>("a.c"), tree.get<string>("a.c"));
+	BOOST_CHECK_EQUAL(root.get<int>("a.<xmlattr>.x"), 7);
+	BOOST_CHECK_EQUAL(root.get<string>("a.<xmlcomment>"), "c");
+	BOOST_CHECK_EQUAL(root.get<size_t>("a.f"), tree.get<size_t>("a.f"));
+	BOOST_CHECK_EQUAL(root.get<bool>("a.g"), tree.get<bool>("a.g"));
+	BOOST_CHECK(!root.get_child_optional("a.z"));
+	BOOST_CHECK(!root.get_child_optional("a.b.z"));
+	BOOST_CHECK(!root.get_child_optional(""));
+
+	for(const char *path : {"a.d","a.e","a.z","a..b","z","a.b.c"})
+	{
+		BOOST_CHECK_EQUAL(message([&]{root.get<int>(path);}), message([&]{tree.get<int>(path);}));
+		BOOST_CHECK_EQUAL(message([&]{root.get<float>(path);}), message([&]{tree.get<float>(path);}));
+		BOOST_CHECK_EQUAL(message([&]{root.get<string>(path);}), message([&]{tree.get<string>(path);}));
+	} // end foreach
+	BOOST_CHECK_THROW(root.get<int>("a.d"), boost::property_tree::ptree_bad_data);
+	BOOST_CHECK_THROW(root.get<int>("a.z"), boost::property_tree::ptree_bad_path);
+} // end test case
+
+BOOST_AUTO_TEST_CASE(Test_Same_Parse_Errors_As_Property_Tree)
+{
+	const vector<string> documents = {
+		"<a><b>1</b>",
+		"<a>\n<b>1</c>\n</a>", // accepted: closing tags aren't validated
+		"<a x=1></a>",
+		"\n\n<a><!-- unterminated </a>",
+		"", // accepted
+	};
+
+	for(const auto &document : documents)
+	{
+		write(document);
+		boost::property_tree::ptree tree;
+		string expected = message([&]{boost::property_tree::read_xml(fileName,tree);});
+		BOOST_CHECK_EQUAL(message([&]{XML::Document parsed(fileName);}), expected);
+	} // end foreach
+	std::remove(fileName.c_str());
+
+	boost::property_tree::ptree tree;
+	BOOST_CHECK_EQUAL(message([&]{XML::Document parsed("nonexistent file.xml");}),
+		message([&]{boost::property_tree::read_xml("nonexistent file.xml",tree);}));
+} // end test case